@@ -0,0 +1,125 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless micro-benchmark of the `ttt::Board` bitboard versus the earlier array scanning.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. bitboard-positions.cpp -o bitboard-positions && ./bitboard-positions
+
+#include "../ttt-Game.hpp"
+#include <cpp/util.hpp>
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::vector;
+using   ttt::Board, ttt::Game, ttt::cell_state::Enum;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+namespace before {
+    // The original `Board::win_line_with` and `Game::find_computer_move` logic, for reference.
+    using Cells = std::array<Enum, Board::n_cells>;
+
+    auto has_win_line_with( const Cells& cells, const Enum state )
+        -> bool
+    {
+        for( const Board::Line& line: Board::lines ) {
+            int count = 0;
+            for( int offset = 0; offset < Board::run_length*line.stride; offset += line.stride ) {
+                count += (cells[line.start + offset] == state);
+            }
+            if( count == Board::run_length ) { return true; }
+        }
+        return false;
+    }
+
+    auto find_computer_move( const Cells& cells, const int n_moves )
+        -> int
+    {
+        for( const auto state_to_check: {ttt::cell_state::circle, ttt::cell_state::cross} ) {
+            for( int i = 0; i < Board::n_cells; ++i ) {
+                if( cells[i] == ttt::cell_state::empty ) {
+                    Cells a_copy = cells;
+                    a_copy[i] = state_to_check;
+                    if( has_win_line_with( a_copy, state_to_check ) ) {
+                        return i;
+                    }
+                }
+            }
+        }
+        const int n_possibles = Board::n_cells - n_moves;
+        const int which_free_cell = cu::random_in( {1, n_possibles} );
+        int count = 0;
+        for( int i = 0; i < Board::n_cells; ++i ) {
+            if( cells[i] == ttt::cell_state::empty ) {
+                ++count;
+                if( count == which_free_cell ) {
+                    return i;
+                }
+            }
+        }
+        return -1;
+    }
+}  // namespace before
+
+auto random_unfinished_games( const int n )
+    -> vector<Game>
+{
+    vector<Game> result;
+    while( int( result.size() ) < n ) {
+        Game game;
+        const int n_moves = cu::random_up_to( Board::n_cells );
+        while( game.n_moves < n_moves and not game.is_over() ) {
+            const unsigned free_cells = game.board.free_cells();
+            int i = 0;
+            do { i = cu::random_up_to( Board::n_cells ); } while( not (free_cells & Board::bit( i )) );
+            game.make_move( i );
+        }
+        if( not game.is_over() ) { result.push_back( game ); }
+    }
+    return result;
+}
+
+template< class Func >
+auto positions_per_second( const vector<Game>& games, const int n_rounds, const Func& f )
+    -> double
+{
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int round = 0; round < n_rounds; ++round ) {
+        for( const Game& game: games ) { checksum += f( game ); }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    return double( n_rounds )*games.size()/seconds;
+}
+
+auto main() -> int
+{
+    const auto games = random_unfinished_games( 100'000 );
+    const int n_rounds = 20;
+
+    const double before_win_checks = positions_per_second( games, n_rounds, [](const Game& g) {
+        return int( before::has_win_line_with( g.board.cells, ttt::cell_state::cross ) );
+    } );
+    const double after_win_checks = positions_per_second( games, n_rounds, [](const Game& g) {
+        return int( Board::is_win( g.board.bits_of( ttt::cell_state::cross ) ) );
+    } );
+    const double before_moves = positions_per_second( games, n_rounds, [](const Game& g) {
+        return before::find_computer_move( g.board.cells, g.n_moves );
+    } );
+    const double after_moves = positions_per_second( games, n_rounds, [](const Game& g) {
+        return g.find_computer_move();
+    } );
+
+    printf( "%-28s %16s %16s %8s\n", "Positions/sec", "array scan", "bitboard", "ratio" );
+    printf( "%-28s %16.0f %16.0f %8.1f\n",
+        "win check", before_win_checks, after_win_checks, after_win_checks/before_win_checks );
+    printf( "%-28s %16.0f %16.0f %8.1f\n",
+        "find_computer_move", before_moves, after_moves, after_moves/before_moves );
+    return EXIT_SUCCESS;
+}
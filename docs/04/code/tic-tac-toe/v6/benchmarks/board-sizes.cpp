@@ -0,0 +1,126 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Board_` win detection for 3×3, 15×15 and 19×19 boards:
+// per-line loops versus the table / shift-and-AND run detection, plus incremental checks.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. board-sizes.cpp -o board-sizes && ./board-sizes
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include <cpp/util.hpp>
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::swap
+#include <chrono>
+#include <numeric>      // std::iota
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::swap, std::iota, std::vector;
+using   ttt::Board_, ttt::Game_, ttt::cell_state::Enum;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+template< class Func >
+auto ns_per_call( const int n_calls, const Func& f )
+    -> double
+{
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int i = 0; i < n_calls; ++i ) { checksum += f( i ); }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    return 1e9*seconds/n_calls;
+}
+
+template< class Board >
+auto has_line_by_loops( const Board& board, const Enum state )
+    -> bool
+{
+    for( const auto& line: Board::lines ) {
+        int count = 0;
+        for( int offset = 0; offset < Board::run_length*line.stride; offset += line.stride ) {
+            count += (board.cells[line.start + offset] == state);
+        }
+        if( count == Board::run_length ) { return true; }
+    }
+    return false;
+}
+
+template< class Game >
+auto random_playout()
+    -> Game
+{
+    vector<int> order( Game::Board::n_cells );
+    iota( order.begin(), order.end(), 0 );
+    Game game;
+    for( int i = 0; not game.is_over(); ++i ) {
+        swap( order[i], order[i + cu::random_up_to( Game::Board::n_cells - i )] );
+        game.make_move( order[i] );
+    }
+    return game;
+}
+
+template< int w, int h, int k >
+auto benchmark()
+    -> bool
+{
+    using Board = Board_<w, h, k>;
+    using Game  = Game_<Board>;
+
+    // Positions sampled from random games, both finished and unfinished.
+    const int n_positions = 2'000;
+    vector<Board> positions;
+    for( int i = 0; i < n_positions; ++i ) {
+        const Game game = random_playout<Game>();
+        positions.push_back( game.board );
+    }
+    for( const Board& board: positions ) {
+        const bool has_line = has_line_by_loops( board, ttt::cell_state::cross );
+        if( has_line != Board::is_win( board.player_bits[0] ) ) {
+            printf( "!Run detection disagrees with the per-line loops.\n" );
+            return false;
+        }
+    }
+
+    const int n_calls = (Board::n_cells < 100? 2'000'000 : 200'000);
+    const double loops_ns = ns_per_call( n_calls, [&]( const int i ) {
+        return int( has_line_by_loops( positions[i % n_positions], ttt::cell_state::cross ) );
+    } );
+    const double runs_ns = ns_per_call( n_calls, [&]( const int i ) {
+        return int( Board::is_win( positions[i % n_positions].player_bits[0] ) );
+    } );
+    const double through_ns = ns_per_call( n_calls, [&]( const int i ) {
+        const Board& board = positions[i % n_positions];
+        return int( board.win_line_through( i % Board::n_cells, ttt::cell_state::cross ).has_value() );
+    } );
+
+    const int n_games = (Board::n_cells < 100? 200'000 : 5'000);
+    int n_moves = 0;
+    const auto start = chr::steady_clock::now();
+    for( int i = 0; i < n_games; ++i ) { n_moves += random_playout<Game>().n_moves; }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+
+    printf( "%2d×%-2d k=%d %6d lines %12.1f %12.1f %12.1f %14.0f %12.0f\n",
+        w, h, k, int( Board::n_lines ),
+        loops_ns, runs_ns, through_ns, n_moves/seconds, n_games/seconds
+        );
+    return true;
+}
+
+auto main() -> int
+{
+    printf( "%-21s %12s %12s %12s %14s %12s\n", "",
+        "loops ns", "runs ns", "through ns", "moves/sec", "games/sec" );
+    const bool ok = benchmark<3, 3, 3>() and benchmark<15, 15, 5>() and benchmark<19, 19, 5>();
+    printf( "\n"
+        "loops:     full board check with a loop per line.\n"
+        "runs:      full board check with a table (3×3) or shift-and-AND run detection.\n"
+        "through:   incremental check of the lines through one cell, as in `make_move`.\n"
+        "moves/sec: random playouts with incremental win detection.\n"
+        );
+    return (ok? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,155 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless micro-benchmark of the heuristic `Game_::find_computer_move` for 3×3, 4×4 and
+// 15×15 boards: copy-and-rescan win/block checks versus the incremental per-line counts.
+//
+// Every position where the copy-and-rescan reference finds a win or a block is checked to get
+// the same move from `find_computer_move`, with either player to move. A fixed 3×3 position
+// also checks that cross, when to move, takes its own win rather than blocking circle’s.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. computer-move.cpp -o computer-move && ./computer-move
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include <cpp/util.hpp>
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::vector;
+using   ttt::Board_, ttt::Game_, ttt::cell_state::Enum;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+namespace before {
+    // Win/block checks by placing the piece in a copy of the cells and rescanning all lines.
+    template< class Board >
+    auto has_line_with( const decltype( Board::cells )& cells, const Enum state )
+        -> bool
+    {
+        for( const auto& line: Board::lines ) {
+            int count = 0;
+            for( int offset = 0; offset < Board::run_length*line.stride; offset += line.stride ) {
+                count += (cells[line.start + offset] == state);
+            }
+            if( count == Board::run_length ) { return true; }
+        }
+        return false;
+    }
+
+    // The winning or blocking move for `player`, if any, else -1.
+    template< class Board >
+    auto forced_move( const Board& board, const Enum player )
+        -> int
+    {
+        for( const auto state_to_check: {player, ttt::cell_state::opponent_of( player )} ) {
+            for( int i = 0; i < Board::n_cells; ++i ) {
+                if( board.cells[i] == ttt::cell_state::empty ) {
+                    auto a_copy = board.cells;
+                    a_copy[i] = state_to_check;
+                    if( has_line_with<Board>( a_copy, state_to_check ) ) { return i; }
+                }
+            }
+        }
+        return -1;
+    }
+
+    template< class Game >
+    auto find_computer_move( const Game& game )
+        -> int
+    {
+        const int i = forced_move( game.board, game.player_to_move() );
+        if( i >= 0 ) { return i; }
+        return game.board.nth_free_cell( cu::random_up_to( Game::Board::n_cells - game.n_moves ) );
+    }
+}  // namespace before
+
+template< class Game >
+auto random_unfinished_games( const int n )
+    -> vector<Game>
+{
+    using Board = typename Game::Board;
+    vector<Game> result;
+    while( int( result.size() ) < n ) {
+        Game game;
+        const int n_moves = cu::random_up_to( Board::n_cells );
+        while( game.n_moves < n_moves and not game.is_over() ) {
+            game.make_move( game.board.nth_free_cell( cu::random_up_to( Board::n_cells - game.n_moves ) ) );
+        }
+        if( not game.is_over() ) { result.push_back( game ); }
+    }
+    return result;
+}
+
+template< class Game, class Func >
+auto ns_per_position( const vector<Game>& games, const int n_rounds, const Func& f )
+    -> double
+{
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int round = 0; round < n_rounds; ++round ) {
+        for( const Game& game: games ) { checksum += f( game ); }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    return 1e9*seconds/(double( n_rounds )*games.size());
+}
+
+template< int w, int h, int k >
+auto benchmark( const int n_positions, const int n_rounds )
+    -> bool
+{
+    using Game = Game_<Board_<w, h, k>>;
+    const vector<Game> games = random_unfinished_games<Game>( n_positions );
+
+    int n_forced = 0;
+    for( const Game& game: games ) {
+        const int expected = before::forced_move( game.board, game.player_to_move() );
+        if( expected < 0 ) { continue; }
+        ++n_forced;
+        if( game.find_computer_move() != expected ) {
+            printf( "!%d×%d: `find_computer_move` disagrees with the reference.\n", w, h );
+            return false;
+        }
+    }
+
+    const double before_ns = ns_per_position( games, n_rounds, []( const Game& game ) {
+        return before::find_computer_move( game );
+    } );
+    const double after_ns = ns_per_position( games, n_rounds, []( const Game& game ) {
+        return game.find_computer_move();
+    } );
+    printf( "%2d×%-2d k=%d %10.1f%% %16.1f %16.1f %8.1f\n",
+        w, h, k, 100.0*n_forced/n_positions, before_ns, after_ns, before_ns/after_ns
+        );
+    return true;
+}
+
+// X on 0 and 1, O on 3 and 4, X to move: X must win at 2, not block at 5.
+auto cross_takes_its_own_win()
+    -> bool
+{
+    Game_<Board_<3, 3, 3>> game;
+    for( const int i: {0, 3, 1, 4} ) { game.make_move( i ); }
+    if( game.player_to_move() != ttt::cell_state::cross or game.find_computer_move() != 2 ) {
+        printf( "!3×3: the heuristic as cross doesn’t take its own win.\n" );
+        return false;
+    }
+    return true;
+}
+
+auto main() -> int
+{
+    if( not cross_takes_its_own_win() ) { return EXIT_FAILURE; }
+    printf( "%-12s %11s %16s %16s %8s\n",
+        "ns/position", "forced", "copy & rescan", "incremental", "ratio" );
+    const bool ok = benchmark<3, 3, 3>( 100'000, 20 )
+        and benchmark<4, 4, 4>( 100'000, 10 )
+        and benchmark<15, 15, 5>( 5'000, 2 );
+    return (ok? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,301 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::game_records`: bytes per game, write throughput, and read
+// throughput in GB/s of a memory-mapped scan for statistics, with and without replaying the
+// games.
+//
+// Also round-trip checks random games on 3×3, 4×4 and 15×15 boards: the moves and outcome of
+// every record read back must match the game written, also after appending to an existing
+// file, and a file with another header must be rejected. A file cut off anywhere in its last
+// record must fail with “Truncated game record.” without reading beyond its end, and a record
+// with too many moves or an impossible move must fail with “Corrupt game record.”.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. game-records.cpp -o game-records && ./game-records [N_GAMES]
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include "../ttt-Game_records.hpp"
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t, uint8_t
+#include <stdio.h>      // fopen, fwrite, fclose, printf, remove
+#include <stdlib.h>     // EXIT_..., strtoll
+
+#include <chrono>
+#include <exception>    // std::exception
+#include <string>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+namespace gr    = ttt::game_records;
+using   std::exception,
+        std::string,
+        std::vector;
+using   ttt::Board_, ttt::Game_;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+template< class Game >
+auto random_game()
+    -> Game
+{
+    Game game;
+    const int n_moves = 1 + cu::random_up_to( Game::Board::n_cells );   // Some abandoned.
+    while( game.n_moves < n_moves and not game.is_over() ) {
+        game.make_move( game.board.nth_free_cell( cu::random_up_to( Game::Board::n_cells - game.n_moves ) ) );
+    }
+    return game;
+}
+
+template< class Game >
+auto round_trip_is_exact( const string& path, const int n_games )
+    -> bool
+{
+    remove( path.c_str() );
+    vector<Game> games;
+    for( int i = 0; i < n_games; ++i ) { games.push_back( random_game<Game>() ); }
+    {
+        gr::Writer_<Game> writer( path, ttt::strategy::heuristic, ttt::strategy::mcts );
+        for( int i = 0; i < n_games/2; ++i ) { writer.add( games[i] ); }
+    }
+    {
+        gr::Writer_<Game> writer( path, ttt::strategy::heuristic, ttt::strategy::mcts );  // Appends.
+        for( int i = n_games/2; i < n_games; ++i ) { writer.add( games[i] ); }
+    }
+
+    const gr::Reader reader( path );
+    if( not gr::has_geometry_of<typename Game::Board>( reader.header() )
+        or reader.header().o_strategy != ttt::strategy::mcts ) {
+        return false;
+    }
+    int i = 0;
+    Game replayed;
+    for( const gr::Record_ref& record: reader ) {
+        const Game& game = games[i++];
+        if( record.n_moves != game.n_moves or record.ends_with_win != game.win_line.has_value() ) {
+            return false;
+        }
+        for( int j = 0; j < record.n_moves; ++j ) {
+            if( record.move( j ) != game.moves[j] ) { return false; }
+        }
+        record.replay_into( replayed );
+        if( replayed.board.hash != game.board.hash or replayed.win_line.has_value() != record.ends_with_win ) {
+            return false;
+        }
+    }
+    if( i != n_games ) { return false; }
+
+    bool rejected = false;
+    try {
+        gr::Writer_<Game> writer( path, ttt::strategy::perfect, ttt::strategy::mcts );
+    } catch( const exception& ) {
+        rejected = true;
+    }
+    remove( path.c_str() );
+    return rejected;
+}
+
+template< class Game >
+void write_records_file( const string& path, const vector<uint8_t>& records, const size_t n_bytes )
+{
+    using Board = typename Game::Board;
+    const vector<uint8_t> header_bytes = gr::bytes_of( {
+        Board::width, Board::height, Board::run_length, gr::bits_per_move_for( Board::n_cells ),
+        ttt::strategy::heuristic, ttt::strategy::heuristic
+    } );
+    FILE* const f = fopen( path.c_str(), "wb" );
+    cu::hopefully( f != nullptr ) or CPPUTIL_FAIL( "Can’t create “" + path + "”." );
+    fwrite( header_bytes.data(), 1, header_bytes.size(), f );
+    fwrite( records.data(), 1, n_bytes, f );
+    fclose( f );
+}
+
+// Reads and replays all records of the file, and returns the number of whole records before
+// the error with `message`, or -1 if there was no such error.
+template< class Game >
+auto n_records_before_error( const string& path, const string& message )
+    -> int
+{
+    const gr::Reader reader( path );
+    int n_records = 0;
+    Game game;
+    try {
+        for( const gr::Record_ref& record: reader ) {
+            record.replay_into( game );
+            ++n_records;
+        }
+    } catch( const exception& x ) {
+        if( string( x.what() ).find( message ) != string::npos ) { return n_records; }
+    }
+    return -1;
+}
+
+// Every cut into the last record, including into a 2 byte record header, must be detected.
+template< class Game >
+auto truncation_is_detected( const string& path )
+    -> bool
+{
+    vector<uint8_t> records;
+    for( int i = 0; i < 2; ++i ) { gr::append_record( random_game<Game>(), records ); }
+    const size_t last_record_start = records.size();
+    gr::append_record( random_game<Game>(), records );
+
+    bool ok = true;
+    for( size_t size = last_record_start + 1; ok and size < records.size(); ++size ) {
+        write_records_file<Game>( path, records, size );
+        ok = (n_records_before_error<Game>( path, "Truncated game record." ) == 2);
+    }
+    remove( path.c_str() );
+    return ok;
+}
+
+// A whole record with more moves than cells, a move beyond the board, or a move to an
+// occupied cell, after a valid record, must be rejected instead of corrupting the game.
+template< class Game >
+auto corruption_is_detected( const string& path )
+    -> bool
+{
+    constexpr int n_cells = Game::Board::n_cells;
+    constexpr bool is_small = (gr::bits_per_move_for( n_cells ) == 4);
+    const auto record_header = [&]( const int n_moves ) -> vector<uint8_t>
+    {
+        if( is_small ) { return {uint8_t( n_moves )}; }
+        return {uint8_t( n_moves ), uint8_t( n_moves >> 8 )};
+    };
+    const auto moves_data = [&]( const int a, const int b ) -> vector<uint8_t>
+    {
+        if( is_small ) { return {uint8_t( a | b << 4 )}; }
+        return {uint8_t( a ), uint8_t( b )};
+    };
+    const auto joined = []( vector<uint8_t> a, const vector<uint8_t>& b ) -> vector<uint8_t>
+    {
+        a.insert( a.end(), b.begin(), b.end() );
+        return a;
+    };
+    vector<vector<uint8_t>> corrupt_records =
+    {
+        joined( record_header( n_cells + 1 ), vector<uint8_t>( size_t( n_cells + 1 ), 0 ) ),
+        joined( record_header( 2 ), moves_data( 4, 4 ) ),
+    };
+    const int beyond_board = (is_small? 15 : n_cells + 3);
+    if( beyond_board >= n_cells ) {     // Every 4 bit move is on a 4×4 board.
+        corrupt_records.push_back( joined( record_header( 2 ), moves_data( 4, beyond_board ) ) );
+    }
+
+    bool ok = true;
+    for( const vector<uint8_t>& corrupt_record: corrupt_records ) {
+        vector<uint8_t> records;
+        gr::append_record( random_game<Game>(), records );
+        records.insert( records.end(), corrupt_record.begin(), corrupt_record.end() );
+        write_records_file<Game>( path, records, records.size() );
+        ok = ok and (n_records_before_error<Game>( path, "Corrupt game record." ) == 1);
+    }
+    remove( path.c_str() );
+    return ok;
+}
+
+auto seconds_since( const chr::steady_clock::time_point start )
+    -> double
+{ return chr::duration<double>( chr::steady_clock::now() - start ).count(); }
+
+auto main( int n_args, char** args ) -> int
+{
+    const string path = "game-records.tmp";
+    try {
+        const bool ok = round_trip_is_exact<ttt::Game>( path, 20'000 )
+            and round_trip_is_exact<Game_<Board_<4, 4, 4>>>( path, 20'000 )
+            and round_trip_is_exact<Game_<Board_<15, 15, 5>>>( path, 2'000 );
+        if( not ok ) {
+            printf( "!Game records didn’t round-trip exactly.\n" );
+            return EXIT_FAILURE;
+        }
+        const bool truncation_ok = truncation_is_detected<ttt::Game>( path )
+            and truncation_is_detected<Game_<Board_<4, 4, 4>>>( path )
+            and truncation_is_detected<Game_<Board_<15, 15, 5>>>( path );
+        if( not truncation_ok ) {
+            printf( "!A truncated game records file wasn’t detected.\n" );
+            return EXIT_FAILURE;
+        }
+        const bool corruption_ok = corruption_is_detected<ttt::Game>( path )
+            and corruption_is_detected<Game_<Board_<4, 4, 4>>>( path )
+            and corruption_is_detected<Game_<Board_<15, 15, 5>>>( path );
+        if( not corruption_ok ) {
+            printf( "!A corrupt game record wasn’t detected.\n" );
+            return EXIT_FAILURE;
+        }
+
+        // Distinct random finished 3×3 games, encoded once and written repeatedly.
+        const int64_t n_games = (n_args > 1? strtoll( args[1], nullptr, 10 ) : 50'000'000);
+        const int n_distinct = 1 << 16;
+        vector<uint8_t> bytes;
+        for( int i = 0; i < n_distinct; ++i ) {
+            ttt::Game game;
+            while( not game.is_over() ) {
+                game.make_move( game.board.nth_free_cell( cu::random_up_to( 9 - game.n_moves ) ) );
+            }
+            gr::append_record( game, bytes );
+        }
+        remove( path.c_str() );
+        auto start = chr::steady_clock::now();
+        {
+            gr::Writer_<ttt::Game> writer( path );
+            for( int64_t n = 0; n < n_games; n += n_distinct ) {
+                writer.add_encoded( bytes.data(), bytes.size(), n_distinct );
+            }
+        }
+        const double write_seconds = seconds_since( start );
+
+        const gr::Reader reader( path );
+        const double gb = reader.n_bytes()/1e9;
+        printf( "%lld 3×3 games, %.3f GB, %.2f bytes per game.\n\n",
+            (long long) n_games, gb, double( reader.n_bytes() - gr::header_size )/n_games );
+        printf( "%-40s %10s %14s\n", "", "GB/s", "games/sec" );
+        printf( "%-40s %10.2f %14.0f\n", "write (encoded in advance)",
+            gb/write_seconds, n_games/write_seconds );
+
+        // Just the record headers: the number of moves.
+        start = chr::steady_clock::now();
+        int64_t n_moves = 0;
+        for( const gr::Record_ref& record: reader ) { n_moves += record.n_moves; }
+        const double count_seconds = seconds_since( start );
+        printf( "%-40s %10.2f %14.0f\n", "scan: count moves", gb/count_seconds, n_games/count_seconds );
+
+        // Statistics without replay: outcome by game length, and first-move frequencies.
+        start = chr::steady_clock::now();
+        int64_t n_wins_by_length[10] = {};
+        int64_t n_first_moves[9] = {};
+        int64_t n_records = 0;
+        for( const gr::Record_ref& record: reader ) {
+            n_wins_by_length[record.n_moves] += record.ends_with_win;
+            ++n_first_moves[record.move( 0 )];
+            ++n_records;
+        }
+        const double scan_seconds = seconds_since( start );
+        printf( "%-40s %10.2f %14.0f\n", "scan: outcomes & first moves",
+            gb/scan_seconds, n_records/scan_seconds );
+
+        // Statistics with replay: the x win rate.
+        start = chr::steady_clock::now();
+        int64_t n_x_wins = 0;
+        ttt::Game game;
+        for( const gr::Record_ref& record: reader ) {
+            record.replay_into( game );
+            n_x_wins += (game.win_line and game.board.cells[game.win_line->start] == ttt::cell_state::cross);
+        }
+        const double replay_seconds = seconds_since( start );
+        printf( "%-40s %10.2f %14.0f\n", "scan with replay", gb/replay_seconds, n_records/replay_seconds );
+        the_sink = int( n_moves + n_x_wins + n_first_moves[4] + n_wins_by_length[9] );
+
+        remove( path.c_str() );
+        if( n_records != (n_games + n_distinct - 1)/n_distinct*n_distinct ) {
+            printf( "!Read %lld records.\n", (long long) n_records );
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    } catch( const exception& x ) {
+        printf( "!%s\n", x.what() );
+    }
+    remove( path.c_str() );
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Game_::make_move` + `unmake_move` versus copying the game for
+// each move, for 3×3, 4×4 and 15×15 boards.
+//
+// The incremental Zobrist hash is checked against a hash computed from scratch after every
+// make, unmake and redo in random sequences, and the game is checked to be back to the start
+// position after all moves are unmade. For 3×3 all reachable positions are also checked to
+// have distinct hashes, as needed for use as a transposition table key.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. make-unmake.cpp -o make-unmake && ./make-unmake
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // uint64_t
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::unordered_set,
+        std::vector;
+using   ttt::Board_, ttt::Game_, ttt::cell_state::Enum;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+template< class Board >
+auto hash_from_scratch( const Board& board )
+    -> uint64_t
+{
+    uint64_t result = 0;
+    for( int i = 0; i < Board::n_cells; ++i ) {
+        if( board.cells[i] != ttt::cell_state::empty ) {
+            result ^= Board::zobrist_keys[board.cells[i] - 1][i];
+        }
+    }
+    return result;
+}
+
+template< class Game >
+auto is_start_position( const Game& game )
+    -> bool
+{
+    const Game start;
+    return game.n_moves == 0 and not game.win_line and game.board.hash == 0
+        and game.board.cells == start.board.cells
+        and game.board.player_bits == start.board.player_bits
+        and game.board.line_counts == start.board.line_counts;
+}
+
+// Random walks of moves, undos and redos, checking the hash after every step.
+template< class Game >
+auto hashes_are_consistent( const int n_walks )
+    -> bool
+{
+    using Board = typename Game::Board;
+    Game game;
+    for( int walk = 0; walk < n_walks; ++walk ) {
+        for( int step = 0; step < 4*Board::n_cells; ++step ) {
+            const int action = cu::random_up_to( 3 );
+            if( action == 0 and game.n_moves > 0 ) {
+                game.unmake_move();
+            } else if( action == 1 and game.can_redo_move() ) {
+                game.redo_move();
+            } else if( not game.is_over() ) {
+                game.make_move( game.board.nth_free_cell(
+                    cu::random_up_to( Board::n_cells - game.n_moves )
+                    ) );
+            }
+            if( game.board.hash != hash_from_scratch( game.board ) ) { return false; }
+        }
+        while( game.n_moves > 0 ) { game.unmake_move(); }
+        if( not is_start_position( game ) ) { return false; }
+    }
+    return true;
+}
+
+void add_reachable_hashes( ttt::Game& game, unordered_set<uint64_t>& hashes, int& n_positions )
+{
+    if( not hashes.insert( game.board.hash ).second ) { return; }
+    ++n_positions;
+    if( game.is_over() ) { return; }
+    for( unsigned bits = game.board.free_cells(); bits != 0; bits &= bits - 1 ) {
+        game.make_move( cu::lowest_bit_index( bits ) );
+        add_reachable_hashes( game, hashes, n_positions );
+        game.unmake_move();
+    }
+}
+
+// Full-width walks of the first `depth` plies, by make + unmake or by copying. The result
+// is the number of moves made.
+template< class Game >
+auto n_moves_by_unmake( Game& game, const int depth )
+    -> int64_t
+{
+    if( depth == 0 or game.is_over() ) { return 0; }
+    int64_t result = 0;
+    for( int i = 0; i < Game::Board::n_cells; ++i ) {
+        if( game.board.cells[i] == ttt::cell_state::empty ) {
+            game.make_move( i );
+            result += 1 + n_moves_by_unmake( game, depth - 1 );
+            game.unmake_move();
+        }
+    }
+    return result;
+}
+
+template< class Game >
+auto n_moves_by_copying( const Game& game, const int depth )
+    -> int64_t
+{
+    if( depth == 0 or game.is_over() ) { return 0; }
+    int64_t result = 0;
+    for( int i = 0; i < Game::Board::n_cells; ++i ) {
+        if( game.board.cells[i] == ttt::cell_state::empty ) {
+            Game next = game;
+            next.make_move( i );
+            result += 1 + n_moves_by_copying( next, depth - 1 );
+        }
+    }
+    return result;
+}
+
+template< class Func >
+auto moves_per_second( const Func& walk )
+    -> double
+{
+    const auto start = chr::steady_clock::now();
+    const int64_t n_moves = walk();
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = int( n_moves );
+    return double( n_moves )/seconds;
+}
+
+template< int w, int h, int k >
+auto benchmark( const int depth )
+    -> bool
+{
+    using Game = Game_<Board_<w, h, k>>;
+    if( not hashes_are_consistent<Game>( 2'000 ) ) {
+        printf( "!%d×%d: the incremental hash differs from the hash computed from scratch.\n", w, h );
+        return false;
+    }
+
+    Game game;
+    const double unmake_rate = moves_per_second( [&]{ return n_moves_by_unmake( game, depth ); } );
+    const double copy_rate = moves_per_second( [&]{ return n_moves_by_copying( game, depth ); } );
+    if( not is_start_position( game ) ) {
+        printf( "!%d×%d: make + unmake didn’t restore the start position.\n", w, h );
+        return false;
+    }
+    printf( "%2d×%-2d k=%d %6d plies %16.0f %16.0f %8.1f %10d\n",
+        w, h, k, depth, unmake_rate, copy_rate, unmake_rate/copy_rate, int( sizeof( Game ) )
+        );
+    return true;
+}
+
+auto main() -> int
+{
+    ttt::Game game;
+    unordered_set<uint64_t> hashes;
+    int n_positions = 0;
+    add_reachable_hashes( game, hashes, n_positions );
+    printf( "3×3: %d reachable positions, %d distinct hashes.\n\n",
+        n_positions, int( hashes.size() )
+        );
+
+    printf( "%-22s %16s %16s %8s %10s\n",
+        "Moves/sec", "make + unmake", "copy + make", "ratio", "Game bytes" );
+    const bool ok = benchmark<3, 3, 3>( 9 ) and benchmark<4, 4, 4>( 5 )
+        and benchmark<15, 15, 5>( 3 );
+    return (ok? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,57 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Mcts_`: playout throughput per core, and speedup, for 1, 2, 4,
+// 8 and 16 threads on a 4×4 and a 15×15 board.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I.. mcts-threads.cpp -o mcts-threads && ./mcts-threads
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include "../ttt-Mcts.hpp"
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::min
+#include <thread>
+
+using   std::min, std::thread;
+using   ttt::Board_, ttt::Game_, ttt::Mcts_;
+
+template< class Game >
+void benchmark( const char* title, const Game& game, const int64_t n_playouts )
+{
+    const int n_cores = std::max( 1, int( thread::hardware_concurrency() ) );
+    printf( "%s, %lld playouts per search, %d cores:\n", title, (long long) n_playouts, n_cores );
+    printf( "%8s %14s %18s %10s %10s\n", "threads", "playouts/sec", "per core", "speedup", "move" );
+
+    double single_thread_rate = 0;
+    for( const int n_threads: {1, 2, 4, 8, 16} ) {
+        typename Mcts_<Game>::Options options;
+        options.n_threads       = n_threads;
+        options.max_playouts    = n_playouts;
+        options.max_seconds     = 60;
+        options.seed            = 42;
+        Mcts_<Game> search( options );
+        const int move = search.best_move_for( game );
+        const auto& stats = search.stats();
+        const double rate = stats.n_playouts/stats.seconds;
+        if( n_threads == 1 ) { single_thread_rate = rate; }
+        printf( "%8d %14.0f %18.0f %10.2f %10d\n",
+            n_threads, rate, rate/min( n_threads, n_cores ), rate/single_thread_rate, move
+            );
+    }
+    printf( "\n" );
+}
+
+auto main() -> int
+{
+    using Small_game = Game_<Board_<4, 4, 4>>;
+    benchmark( "4×4, k=4, empty board", Small_game(), 200'000 );
+
+    using Large_game = Game_<Board_<15, 15, 5>>;
+    Large_game game;
+    for( const int move: {112, 113, 97, 127} ) { game.make_move( move ); }
+    benchmark( "15×15, k=5, after 4 moves", game, 20'000 );
+    return EXIT_SUCCESS;
+}
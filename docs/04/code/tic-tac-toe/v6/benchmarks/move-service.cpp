@@ -0,0 +1,188 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Move_service_` with a fake message sink: time spent on the
+// requesting (“UI”) thread per computer move versus a synchronous search, delivery latency,
+// progress reports, and how fast a search is abandoned when cancelled.
+//
+// Also checks that every delivered move is legal and belongs to the current request, and
+// that a cancelled request never delivers a move.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I.. move-service.cpp -o move-service && ./move-service
+
+#include "../ttt-Game.hpp"
+#include "../ttt-Move_service.hpp"
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t, uint64_t
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::(max, sort)
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::max, std::sort,
+        std::condition_variable,
+        std::deque,
+        std::mutex, std::unique_lock,
+        std::vector;
+using   ttt::Game, ttt::Move_service;
+using Event = Move_service::Event;
+
+// Stands in for a window’s message queue: the sink posts, the “UI” thread gets.
+class Fake_message_queue
+{
+    mutex               m_mutex;
+    condition_variable  m_posted;
+    deque<Event>        m_events;
+
+public:
+    void post( const Event& event )
+    {
+        { unique_lock<mutex> lock( m_mutex );  m_events.push_back( event ); }
+        m_posted.notify_one();
+    }
+
+    auto get()
+        -> Event
+    {
+        unique_lock<mutex> lock( m_mutex );
+        m_posted.wait( lock, [this]{ return not m_events.empty(); } );
+        const Event result = m_events.front();
+        m_events.pop_front();
+        return result;
+    }
+
+    auto n_queued()
+        -> int
+    {
+        unique_lock<mutex> lock( m_mutex );
+        return int( m_events.size() );
+    }
+};
+
+auto seconds_since( const chr::steady_clock::time_point start )
+    -> double
+{ return chr::duration<double>( chr::steady_clock::now() - start ).count(); }
+
+auto percentile( vector<double>& values, const double p )
+    -> double
+{
+    sort( values.begin(), values.end() );
+    return values[size_t( p/100*double( values.size() - 1 ) + 0.5 )];
+}
+
+auto mcts_options()
+    -> ttt::Mcts_<Game>::Options
+{
+    ttt::Mcts_<Game>::Options options;
+    options.n_threads           = 1;
+    options.max_playouts        = 20'000;
+    options.max_seconds         = 10;
+    options.progress_interval   = 2'000;
+    options.seed                = 42;
+    return options;
+}
+
+auto main() -> int
+{
+    Fake_message_queue queue;
+    Move_service service(
+        [&queue]( const Event& event ) { queue.post( event ); }, ttt::strategy::mcts, mcts_options()
+        );
+
+    // Games of random “user” moves against Monte Carlo tree search computer moves.
+    const int n_games = 30;
+    vector<double> request_us, response_ms;
+    int64_t n_progress_events = 0;
+    for( int i = 0; i < n_games; ++i ) {
+        Game game;
+        while( not game.is_over() ) {
+            game.make_move( game.board.nth_free_cell( cu::random_up_to( 9 - game.n_moves ) ) );
+            if( game.is_over() ) { break; }
+
+            const auto start = chr::steady_clock::now();
+            const uint64_t ticket = service.request_move_for( game );
+            request_us.push_back( 1e6*seconds_since( start ) );
+            for( ;; ) {
+                const Event event = queue.get();
+                if( event.ticket != ticket ) {
+                    printf( "!An event for ticket %llu arrived while %llu is current.\n",
+                        (unsigned long long) event.ticket, (unsigned long long) ticket );
+                    return EXIT_FAILURE;
+                }
+                if( event.kind == Event::progress ) { ++n_progress_events;  continue; }
+                if( game.board.cells[event.move] != ttt::cell_state::empty ) {
+                    printf( "!The move service returned an occupied cell.\n" );
+                    return EXIT_FAILURE;
+                }
+                response_ms.push_back( 1e3*seconds_since( start ) );
+                game.make_move( event.move );
+                break;
+            }
+        }
+    }
+
+    // The same searches run synchronously, as the UI thread would otherwise do them.
+    vector<double> synchronous_ms;
+    ttt::Mcts_<Game> mcts( mcts_options() );
+    for( int i = 0; i < int( response_ms.size() ); ++i ) {
+        Game game;
+        game.make_move( i % 9 );
+        const auto start = chr::steady_clock::now();
+        (void) mcts.best_move_for( game );
+        synchronous_ms.push_back( 1e3*seconds_since( start ) );
+    }
+
+    const int n_moves = int( response_ms.size() );
+    printf( "%d computer moves in %d games, %lld progress reports.\n\n",
+        n_moves, n_games, (long long) n_progress_events );
+    printf( "%-40s %12s %12s\n", "UI thread time per computer move", "p50", "max" );
+    printf( "%-40s %12.3f %12.3f\n", "synchronous search, ms",
+        percentile( synchronous_ms, 50 ), percentile( synchronous_ms, 100 ) );
+    printf( "%-40s %12.3f %12.3f\n", "request_move_for, µs",
+        percentile( request_us, 50 ), percentile( request_us, 100 ) );
+    printf( "%-40s %12.3f %12.3f\n", "request to move event (not blocking), ms",
+        percentile( response_ms, 50 ), percentile( response_ms, 100 ) );
+
+    // Cancellation, as when the user starts a new game: long searches cancelled after 10 ms.
+    vector<double> cancel_ms;
+    ttt::Mcts_<Game>::Options long_search = mcts_options();
+    long_search.max_playouts = 1'000'000'000;
+    Fake_message_queue cancel_queue;
+    Move_service long_service(
+        [&cancel_queue]( const Event& event ) { cancel_queue.post( event ); },
+        ttt::strategy::mcts, long_search
+        );
+    for( int i = 0; i < 20; ++i ) {
+        Game game;
+        game.make_move( i % 9 );
+        (void) long_service.request_move_for( game );
+        std::this_thread::sleep_for( chr::milliseconds( 10 ) );
+        const auto start = chr::steady_clock::now();
+        long_service.cancel();
+        long_service.wait_until_idle();
+        cancel_ms.push_back( 1e3*seconds_since( start ) );
+    }
+    const int n_moves_after_cancel = [&]{
+        int n = 0;
+        while( cancel_queue.n_queued() > 0 ) { n += (cancel_queue.get().kind == Event::move_found); }
+        return n;
+    }();
+    const Move_service::Statistics stats = long_service.stats();
+    printf( "%-40s %12.3f %12.3f\n", "cancel to worker idle, ms",
+        percentile( cancel_ms, 50 ), percentile( cancel_ms, 100 ) );
+    printf( "\n%lld requests, %lld cancelled, %d moves delivered after cancellation.\n",
+        (long long) stats.n_requests, (long long) stats.n_cancelled, n_moves_after_cancel );
+    if( n_moves_after_cancel > 0 or stats.n_cancelled != stats.n_requests ) {
+        printf( "!A cancelled request delivered a move.\n" );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Checks the compile time `ttt::Move_table` against the run time `ttt::Solver` for every
+// reachable position, then compares the time per answer of the strategies.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. move-table.cpp -o move-table && ./move-table
+
+#define TTT_WITH_MOVE_TABLE     // For `strategy::table`.
+
+#include "../ttt-Game.hpp"
+#include "../ttt-Move_table.hpp"
+#include "../ttt-Solver.hpp"
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace chr   = std::chrono;
+using   std::vector;
+using   ttt::Board, ttt::Game, ttt::Move_table, ttt::Solver;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+void add_reachable_unfinished_games( const Game& game, vector<Game>& result, vector<bool>& seen )
+{
+    const unsigned key = (unsigned( game.board.player_bits[0] ) << Board::n_cells)
+        | game.board.player_bits[1];
+    if( game.is_over() or seen[key] ) { return; }
+    seen[key] = true;
+    result.push_back( game );
+    for( unsigned bits = game.board.free_cells(); bits != 0; bits &= bits - 1 ) {
+        Game next = game;
+        next.make_move( cpp::util::lowest_bit_index( bits ) );
+        add_reachable_unfinished_games( next, result, seen );
+    }
+}
+
+auto n_mismatches_in( const vector<Game>& games )
+    -> int
+{
+    Solver solver;
+    int result = 0;
+    for( const Game& game: games ) {
+        const Move_table::Entry entry = Move_table::entry_for( game.board );
+        const Solver::Result solved = solver.best_move_for( game.board, game.player_to_move() );
+        const bool move_is_free = (entry.move >= 0
+            and game.board.cells[entry.move] == ttt::cell_state::empty);
+        bool move_is_best = false;
+        if( move_is_free ) {
+            Game next = game;
+            next.make_move( entry.move );
+            const int next_score = (next.is_over()
+                ? (next.win_line? -(1 + Board::n_cells - next.n_moves) : 0)
+                : Move_table::entry_for( next.board ).score);
+            move_is_best = (-next_score == solved.score);
+        }
+        if( entry.score != solved.score or not move_is_best ) {
+            ++result;
+        }
+    }
+    return result;
+}
+
+template< class Func >
+auto ns_per_answer( const vector<Game>& games, const int n_rounds, const Func& f )
+    -> double
+{
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int round = 0; round < n_rounds; ++round ) {
+        for( const Game& game: games ) { checksum += f( game ); }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    return 1e9*seconds/(double( n_rounds )*games.size());
+}
+
+auto main() -> int
+{
+    vector<Game> games;
+    vector<bool> seen( 1u << (2*Board::n_cells) );
+    add_reachable_unfinished_games( Game(), games, seen );
+
+    int n_table_positions = 0;
+    for( const Move_table::Entry& entry: Move_table::entries ) {
+        n_table_positions += (entry.score != Move_table::unknown);
+    }
+    printf( "%d positions in the table, %d of them unfinished.\n",
+        n_table_positions, int( games.size() ) );
+
+    if( const int n_mismatches = n_mismatches_in( games ) ) {
+        printf( "!%d table entries disagree with the solver.\n", n_mismatches );
+        return EXIT_FAILURE;
+    }
+    printf( "All table entries agree with the solver.\n\n" );
+
+    const int n_rounds = 200;
+    using ttt::strategy::Enum;
+    const auto time_for = [&]( const Enum choice ) -> double
+    {
+        return ns_per_answer( games, n_rounds, [choice]( const Game& g ) {
+            return g.find_computer_move( choice );
+        } );
+    };
+    printf( "%-28s %12s\n", "Strategy", "ns/answer" );
+    printf( "%-28s %12.1f\n", "heuristic", time_for( ttt::strategy::heuristic ) );
+    printf( "%-28s %12.1f\n", "perfect (warm solver)", time_for( ttt::strategy::perfect ) );
+    printf( "%-28s %12.1f\n", "table", time_for( ttt::strategy::table ) );
+    return EXIT_SUCCESS;
+}
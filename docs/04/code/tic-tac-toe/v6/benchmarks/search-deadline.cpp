@@ -0,0 +1,135 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless deadline adherence harness for `ttt::Timed_search_`: for a number of board sizes
+// and time budgets, searches from random positions and reports how far the response time
+// exceeds the budget, as p50, p99 and max overshoot, with the depth reached.
+//
+// The search checks the clock about every 512 line evaluations, e.g. every node on 15×15, so
+// its own overshoot is a few µs for any board size and budget. On top of that comes timer and
+// scheduling noise, which no search can bound: a thread that is descheduled past its deadline
+// overshoots regardless. So the harness fails if any move is illegal, or if the p99 overshoot
+// exceeds 25% of the budget in two measurements in a row, where the second filters out a burst
+// of load from other processes.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. search-deadline.cpp -o search-deadline && ./search-deadline
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include "../ttt-Timed_search.hpp"
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::(max, sort)
+#include <chrono>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::max, std::sort,
+        std::vector;
+using   ttt::Board_, ttt::Game_, ttt::Search_budget, ttt::Timed_search_;
+
+static int the_n_failures = 0;
+
+template< class Game >
+auto random_position( const int n_moves )
+    -> Game
+{
+    for( ;; ) {
+        Game game;
+        while( not game.is_over() and game.n_moves < n_moves ) {
+            game.make_move( game.board.nth_free_cell(
+                cu::random_up_to( Game::Board::n_cells - game.n_moves )
+                ) );
+        }
+        if( not game.is_over() ) { return game; }
+    }
+}
+
+auto percentile( const vector<double>& sorted_values, const double p )
+    -> double
+{
+    const auto i = size_t( p/100*double( sorted_values.size() - 1 ) + 0.5 );
+    return sorted_values[i];
+}
+
+struct Measurement
+{
+    vector<double>  overshoots_us;      // Sorted.
+    double          mean_depth;
+    int             n_illegal;
+
+    auto p99() const -> double { return percentile( overshoots_us, 99 ); }
+};
+
+template< class Game >
+auto measurement_for( const int64_t budget_us, const int n_searches )
+    -> Measurement
+{
+    using Board = typename Game::Board;
+    const Search_budget budget = {64, budget_us, 0};
+    Timed_search_<Game> search;
+    vector<double> overshoots_us;
+    int64_t sum_of_depths = 0;
+    int n_illegal = 0;
+    for( int i = 0; i < n_searches; ++i ) {
+        const Game game = random_position<Game>( int( cu::random_up_to( Board::n_cells/2 ) ) );
+        const auto start = chr::steady_clock::now();
+        const auto result = search.best_move_for( game, budget );
+        const double elapsed_us = chr::duration<double, std::micro>( chr::steady_clock::now() - start ).count();
+        overshoots_us.push_back( max( 0.0, elapsed_us - double( budget_us ) ) );
+        sum_of_depths += result.depth;
+        const bool is_legal = (0 <= result.move and result.move < Board::n_cells
+            and game.board.cells[result.move] == ttt::cell_state::empty);
+        if( not is_legal ) { ++n_illegal; }
+    }
+    sort( overshoots_us.begin(), overshoots_us.end() );
+    return {overshoots_us, double( sum_of_depths )/n_searches, n_illegal};
+}
+
+template< class Game >
+void check( const char* title, const int64_t budget_us, const int n_searches )
+{
+    const double max_p99 = 0.25*double( budget_us );
+    Measurement m = measurement_for<Game>( budget_us, n_searches );
+    bool is_remeasured = false;
+    if( m.p99() > max_p99 and m.n_illegal == 0 ) {
+        m = measurement_for<Game>( budget_us, n_searches );
+        is_remeasured = true;
+    }
+    printf( "%-14s %10lld %10.1f %10.1f %10.1f %10.1f%s\n",
+        title, (long long) budget_us,
+        percentile( m.overshoots_us, 50 ), m.p99(), m.overshoots_us.back(), m.mean_depth,
+        (is_remeasured? "  (remeasured)" : "")
+        );
+    if( m.n_illegal > 0 ) {
+        fprintf( stderr, "!%s, %lld µs: %d illegal moves.\n", title, (long long) budget_us, m.n_illegal );
+        ++the_n_failures;
+    }
+    if( m.p99() > max_p99 ) {
+        fprintf( stderr, "!%s, %lld µs: p99 overshoot %.1f µs, more than 25%% of the budget.\n",
+            title, (long long) budget_us, m.p99()
+            );
+        ++the_n_failures;
+    }
+}
+
+auto main() -> int
+{
+    cu::seed_random_bits_for_this_thread( 42 );
+    printf( "%-14s %10s %10s %10s %10s %10s\n",
+        "Board", "budget µs", "p50 over", "p99 over", "max over", "depth"
+        );
+    for( const int64_t budget_us: {100, 1'000, 10'000} ) {
+        const int n_searches = (budget_us < 10'000? 500 : 100);
+        check<Game_<Board_<3, 3, 3>>>( "3×3, k=3", budget_us, n_searches );
+        check<Game_<Board_<4, 4, 4>>>( "4×4, k=4", budget_us, n_searches );
+        check<Game_<Board_<7, 7, 4>>>( "7×7, k=4", budget_us, n_searches );
+        check<Game_<Board_<15, 15, 5>>>( "15×15, k=5", budget_us, n_searches );
+        check<Game_<Board_<19, 19, 5>>>( "19×19, k=5", budget_us, n_searches );
+    }
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,92 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Solver`: time per answer, nodes searched, table hit rate.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. solver-search.cpp -o solver-search && ./solver-search
+
+#include "../ttt-Game.hpp"
+#include "../ttt-Solver.hpp"
+
+#include <stdio.h>      // printf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace chr   = std::chrono;
+using   std::vector;
+using   ttt::Board, ttt::Game, ttt::Solver;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+void add_reachable_unfinished_games( const Game& game, vector<Game>& result, vector<bool>& seen )
+{
+    const unsigned key = (unsigned( game.board.player_bits[0] ) << Board::n_cells)
+        | game.board.player_bits[1];
+    if( game.is_over() or seen[key] ) { return; }
+    seen[key] = true;
+    result.push_back( game );
+    for( unsigned bits = game.board.free_cells(); bits != 0; bits &= bits - 1 ) {
+        Game next = game;
+        next.make_move( cpp::util::lowest_bit_index( bits ) );
+        add_reachable_unfinished_games( next, result, seen );
+    }
+}
+
+void report( const char* title, Solver& solver, const vector<Game>& games )
+{
+    solver.reset_stats();
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( const Game& game: games ) {
+        checksum += solver.best_move_for( game.board, game.player_to_move() ).move;
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    const Solver::Statistics& stats = solver.stats();
+    printf( "%-24s %12.3f %14.1f %12.1f %9.1f%%\n",
+        title,
+        1e6*seconds/games.size(),
+        double( stats.n_nodes )/games.size(),
+        double( stats.n_table_probes )/games.size(),
+        100*stats.hit_rate()
+        );
+    the_sink = checksum;
+}
+
+auto main() -> int
+{
+    vector<Game> games;
+    vector<bool> seen( 1u << (2*Board::n_cells) );
+    add_reachable_unfinished_games( Game(), games, seen );
+    printf( "%d reachable unfinished positions.\n\n", int( games.size() ) );
+
+    printf( "%-24s %12s %14s %12s %10s\n",
+        "Solver, per answer", "µs", "nodes", "probes", "hit rate" );
+    Solver solver;
+    {
+        // Each answer from an empty table; the work needed for a single isolated query.
+        Solver::Statistics totals = {};
+        auto total_seconds = 0.0;
+        for( const Game& game: games ) {
+            solver.clear_table();
+            solver.reset_stats();
+            const auto start = chr::steady_clock::now();
+            (void) solver.best_move_for( game.board, game.player_to_move() );
+            total_seconds += chr::duration<double>( chr::steady_clock::now() - start ).count();
+            totals.n_nodes          += solver.stats().n_nodes;
+            totals.n_table_probes   += solver.stats().n_table_probes;
+            totals.n_table_hits     += solver.stats().n_table_hits;
+        }
+        printf( "%-24s %12.3f %14.1f %12.1f %9.1f%%\n",
+            "cold table",
+            1e6*total_seconds/games.size(),
+            double( totals.n_nodes )/games.size(),
+            double( totals.n_table_probes )/games.size(),
+            100*totals.hit_rate()
+            );
+    }
+    solver.clear_table();
+    report( "shared table, 1st pass", solver, games );
+    report( "shared table, 2nd pass", solver, games );
+    return EXIT_SUCCESS;
+}
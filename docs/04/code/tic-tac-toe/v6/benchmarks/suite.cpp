@@ -0,0 +1,108 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Micro-benchmark suite for the tic-tac-toe engine, `ttt::Game_`, and this folder’s copy of
+// the `cpp::util` random helpers. The portable cores in `docs/05/code/.include/cpp` have their
+// own suite, `docs/05/code/benchmarks/suite.cpp`; `tools/run-benchmark-suite.sh` builds and
+// runs both.
+//
+// Options, as `cpp::util::benchmarking::options_from`: `--format text|csv|json`, `--filter`,
+// `--min-time` and `--samples`.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. suite.cpp -o suite
+//      ./suite --format csv
+
+#define TTT_WITH_MOVE_TABLE     // For `strategy::table`.
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include <cpp/benchmarking.hpp>
+#include <cpp/util.hpp>
+
+#include <stdio.h>      // fputs, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <exception>    // std::exception
+#include <string>
+
+namespace cu    = cpp::util;
+namespace bm    = cpp::util::benchmarking;
+using   std::exception,
+        std::string;
+using   ttt::Board_, ttt::Game_;
+namespace strategy = ttt::strategy;
+
+template< class Game >
+void play_randomly( Game& game, const int max_n_moves = Game::Board::n_cells )
+{
+    while( not game.is_over() and game.n_moves < max_n_moves ) {
+        game.make_move( game.board.nth_free_cell( cu::random_up_to( Game::Board::n_cells - game.n_moves ) ) );
+    }
+}
+
+// A position with `n_moves` random moves that is not over.
+template< class Game >
+auto random_position( const int n_moves )
+    -> Game
+{
+    for( ;; ) {
+        Game game;
+        play_randomly( game, n_moves );
+        if( not game.is_over() ) { return game; }
+    }
+}
+
+template< class Game >
+void add_game_benchmarks( bm::Runner& runner, const string& board_name )
+{
+    Game game = random_position<Game>( Game::Board::n_cells/3 );
+    const int move = game.board.nth_free_cell( 0 );
+    runner.run( "game/make_move+unmake_move " + board_name, [&]{
+        game.make_move( move );
+        game.unmake_move();
+        bm::do_not_optimize( game );
+    } );
+    runner.run( "game/random playout " + board_name, []{
+        Game g;
+        play_randomly( g );
+        bm::do_not_optimize( g );
+    } );
+    runner.run( "game/find_computer_move heuristic " + board_name, [&]{
+        bm::do_not_optimize( game.find_computer_move( strategy::heuristic ) );
+    } );
+}
+
+void cpp_main( const int n_args, char** args )
+{
+    cu::seed_random_bits_for_this_thread( 42 );
+    bm::Runner runner( bm::options_from( n_args, args ) );
+
+    runner.run( "util/random_up_to 9", []{ bm::do_not_optimize( cu::random_up_to( 9 ) ); } );
+    runner.run( "util/random_in 1..6", []{ bm::do_not_optimize( cu::random_in({ 1, 6 }) ); } );
+
+    add_game_benchmarks<ttt::Game>( runner, "3×3" );
+    add_game_benchmarks<Game_<Board_<4, 4, 4>>>( runner, "4×4" );
+    add_game_benchmarks<Game_<Board_<15, 15, 5>>>( runner, "15×15" );
+
+    const ttt::Game empty_3x3;
+    const int perfect_move = empty_3x3.find_computer_move( strategy::perfect );
+    cu::hopefully( 0 <= perfect_move and perfect_move < 9 ) or CPPUTIL_FAIL( "Invalid perfect move." );
+    runner.run( "game/find_computer_move perfect 3×3 empty", [&]{
+        bm::do_not_optimize( empty_3x3.find_computer_move( strategy::perfect ) );
+    } );
+    runner.run( "game/find_computer_move table 3×3 empty", [&]{
+        bm::do_not_optimize( empty_3x3.find_computer_move( strategy::table ) );
+    } );
+
+    fputs( runner.report().c_str(), stdout );
+}
+
+auto main( int n_args, char** args ) -> int
+{
+    try {
+        cpp_main( n_args, args );
+        return EXIT_SUCCESS;
+    } catch( const exception& x ) {
+        fprintf( stderr, "!%s\n", x.what() );
+    }
+    return EXIT_FAILURE;
+}
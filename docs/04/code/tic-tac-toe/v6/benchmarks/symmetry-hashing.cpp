@@ -0,0 +1,157 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Symmetry`: distinct positions with and without symmetry
+// reduction, `ttt::Solver` table hit rates with raw versus canonical keys at a number of table
+// sizes, and the cost of a canonicalization.
+//
+// The transforms are checked to be permutations with correct inverses, and every answer with
+// canonical keys is checked to have the same score as the answer with raw keys.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I.. symmetry-hashing.cpp -o symmetry-hashing && ./symmetry-hashing
+
+#include "../ttt-Game.hpp"
+#include "../ttt-Solver.hpp"
+#include "../ttt-Symmetry.hpp"
+
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <set>
+#include <utility>      // std::pair
+#include <vector>
+
+namespace chr   = std::chrono;
+using   std::set,
+        std::pair,
+        std::vector;
+using   ttt::Board, ttt::Game, ttt::Solver, ttt::Symmetry;
+using Table_keys = Solver::Table_keys;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+void add_reachable_unfinished_games( const Game& game, vector<Game>& result, vector<bool>& seen )
+{
+    const unsigned key = (unsigned( game.board.player_bits[0] ) << Board::n_cells)
+        | game.board.player_bits[1];
+    if( game.is_over() or seen[key] ) { return; }
+    seen[key] = true;
+    result.push_back( game );
+    for( unsigned bits = game.board.free_cells(); bits != 0; bits &= bits - 1 ) {
+        Game next = game;
+        next.make_move( cpp::util::lowest_bit_index( bits ) );
+        add_reachable_unfinished_games( next, result, seen );
+    }
+}
+
+auto transforms_are_consistent()
+    -> bool
+{
+    for( int t = 0; t < Symmetry::n_transforms; ++t ) {
+        Board::Bits all_images = 0;
+        for( int i = 0; i < Board::n_cells; ++i ) {
+            const int image = Symmetry::image_of_move( i, t );
+            if( Symmetry::pre_image_of_move( image, t ) != i ) { return false; }
+            if( Symmetry::transformed( Board::bit( i ), t ) != Board::bit( image ) ) { return false; }
+            all_images |= Board::bit( image );
+        }
+        if( all_images != Board::all_cells ) { return false; }
+    }
+    return true;
+}
+
+auto own_and_opponent_of( const Game& game )
+    -> pair<Board::Bits, Board::Bits>
+{
+    const auto player = game.player_to_move();
+    return {game.board.bits_of( player ), game.board.bits_of( ttt::cell_state::opponent_of( player ) )};
+}
+
+struct Cold_run{ Solver::Statistics stats; double seconds; int n_mismatches; };
+
+// Each answer from an empty table, i.e. the hits are from transpositions within one search.
+auto cold_run( const int log2_table_size, const Table_keys::Enum keys, const vector<Game>& games )
+    -> Cold_run
+{
+    Solver solver( log2_table_size, keys );
+    Solver reference( log2_table_size, Table_keys::raw );
+    Cold_run result = {};
+    for( const Game& game: games ) {
+        solver.clear_table();
+        solver.reset_stats();
+        const auto start = chr::steady_clock::now();
+        const Solver::Result answer = solver.best_move_for( game.board, game.player_to_move() );
+        result.seconds += chr::duration<double>( chr::steady_clock::now() - start ).count();
+        result.stats.n_nodes        += solver.stats().n_nodes;
+        result.stats.n_table_probes += solver.stats().n_table_probes;
+        result.stats.n_table_hits   += solver.stats().n_table_hits;
+
+        const int expected_score = reference.best_move_for( game.board, game.player_to_move() ).score;
+        const bool move_is_free = (game.board.free_cells() & Board::bit( answer.move )) != 0;
+        if( answer.score != expected_score or not move_is_free ) { ++result.n_mismatches; }
+    }
+    return result;
+}
+
+auto main() -> int
+{
+    if( not transforms_are_consistent() ) {
+        fprintf( stderr, "!The symmetry transforms are inconsistent.\n" );
+        return EXIT_FAILURE;
+    }
+
+    vector<Game> games;
+    vector<bool> seen( 1u << (2*Board::n_cells) );
+    add_reachable_unfinished_games( Game(), games, seen );
+    set<pair<Board::Bits, Board::Bits>> canonical_positions;
+    for( const Game& game: games ) {
+        const auto [own, opponent] = own_and_opponent_of( game );
+        const Symmetry::Canonical c = Symmetry::canonical( own, opponent );
+        canonical_positions.insert( {c.own, c.opponent} );
+    }
+    printf( "%d reachable unfinished positions, %d up to symmetry.\n\n",
+        int( games.size() ), int( canonical_positions.size() )
+        );
+
+    printf( "%-28s %12s %14s %12s %10s\n",
+        "Cold table, per answer", "µs", "nodes", "probes", "hit rate" );
+    int n_mismatches = 0;
+    for( const int log2_table_size: {6, 8, 10, 14} ) {
+        for( const Table_keys::Enum keys: {Table_keys::raw, Table_keys::canonical} ) {
+            const Cold_run run = cold_run( log2_table_size, keys, games );
+            n_mismatches += run.n_mismatches;
+            char title[64];
+            snprintf( title, sizeof( title ), "2^%d entries, %s keys",
+                log2_table_size, (keys == Table_keys::raw? "raw" : "canonical")
+                );
+            printf( "%-28s %12.3f %14.1f %12.1f %9.1f%%\n",
+                title,
+                1e6*run.seconds/games.size(),
+                double( run.stats.n_nodes )/games.size(),
+                double( run.stats.n_table_probes )/games.size(),
+                100*run.stats.hit_rate()
+                );
+        }
+    }
+
+    const int n_repetitions = 200;
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int r = 0; r < n_repetitions; ++r ) {
+        for( const Game& game: games ) {
+            const auto [own, opponent] = own_and_opponent_of( game );
+            checksum += Symmetry::canonical( own, opponent ).transform;
+        }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    printf( "\n%.1f ns per canonicalization.\n", 1e9*seconds/(double( n_repetitions )*games.size()) );
+
+    if( n_mismatches > 0 ) {
+        fprintf( stderr, "!%d answers with canonical keys differ from the raw key answers.\n",
+            n_mismatches
+            );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
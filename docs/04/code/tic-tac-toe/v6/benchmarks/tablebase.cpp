@@ -0,0 +1,200 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Tablebase_`: generation time for the 4×4 board with 1, 2, 4 and
+// 8 threads, the number of positions and the file size, and the latency of a probe.
+//
+// The 3×3 tablebase is checked to give the `ttt::Solver` score for every reachable unfinished
+// position, and the 4×4 tablebase is checked against a plain negamax search for a sample of
+// positions with at least 8 pieces.
+//
+// The tablebase files “3x3.tttb” and “4x4.tttb” are left in the current directory, for use
+// with e.g. `self-play --board 4x4 --o tablebase --tablebase 4x4.tttb`.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I.. tablebase.cpp -o tablebase && ./tablebase
+
+#include "../ttt-Game.hpp"
+#include "../ttt-Solver.hpp"
+#include "../ttt-Tablebase.hpp"
+#include <cpp/util.hpp>
+
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::max
+#include <chrono>
+#include <exception>    // std::exception
+#include <string>       // std::to_string
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   std::max,
+        std::exception,
+        std::vector;
+using   ttt::cell_state::opponent_of;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+using Board_4x4         = ttt::Board_<4, 4, 4>;
+using Game_4x4          = ttt::Game_<Board_4x4>;
+using Tablebase_3x3     = ttt::Tablebase_<ttt::Board>;
+using Tablebase_4x4     = ttt::Tablebase_<Board_4x4>;
+
+template< class Game >
+auto own_and_opponent_of( const Game& game )
+{
+    const auto player = game.player_to_move();
+    struct Result{ typename Game::Board::Bits own; typename Game::Board::Bits opponent; };
+    return Result{ game.board.bits_of( player ), game.board.bits_of( opponent_of( player ) ) };
+}
+
+template< class Game >
+auto crosses_and_circles_of( const Game& game )
+{
+    struct Result{ typename Game::Board::Bits crosses; typename Game::Board::Bits circles; };
+    return Result{
+        game.board.bits_of( ttt::cell_state::cross ), game.board.bits_of( ttt::cell_state::circle )
+        };
+}
+
+void add_reachable_unfinished_games(
+    const ttt::Game& game, vector<ttt::Game>& result, vector<bool>& seen
+    )
+{
+    const unsigned key = (unsigned( game.board.player_bits[0] ) << ttt::Board::n_cells)
+        | game.board.player_bits[1];
+    if( game.is_over() or seen[key] ) { return; }
+    seen[key] = true;
+    result.push_back( game );
+    for( unsigned bits = game.board.free_cells(); bits != 0; bits &= bits - 1 ) {
+        ttt::Game next = game;
+        next.make_move( cu::lowest_bit_index( bits ) );
+        add_reachable_unfinished_games( next, result, seen );
+    }
+}
+
+// Plain negamax without pruning or a table, as an independent reference.
+template< class Board >
+auto negamax_score( const typename Board::Bits own, const typename Board::Bits opponent )
+    -> int
+{
+    using Bits = typename Board::Bits;
+    const Bits free_cells = Bits( Board::all_cells & ~(own | opponent) );
+    if( Board::is_win( opponent ) ) { return -(1 + cu::bit_count( free_cells )); }
+    if( free_cells == 0 ) { return 0; }
+    int best = -(Board::n_cells + 2);
+    for( unsigned bits = free_cells; bits != 0; bits &= bits - 1 ) {
+        const Bits cell = Board::bit( cu::lowest_bit_index( bits ) );
+        best = max( best, -negamax_score<Board>( opponent, Bits( own | cell ) ) );
+    }
+    return best;
+}
+
+auto n_3x3_mismatches()
+    -> int
+{
+    Tablebase_3x3::generate( "3x3.tttb", 1 );
+    const Tablebase_3x3 tablebase( "3x3.tttb" );
+    vector<ttt::Game> games;
+    vector<bool> seen( 1u << (2*ttt::Board::n_cells) );
+    add_reachable_unfinished_games( ttt::Game(), games, seen );
+
+    ttt::Solver solver;
+    int result = 0;
+    for( const ttt::Game& game: games ) {
+        const auto player = game.player_to_move();
+        const int expected = solver.best_move_for( game.board, player ).score;
+        const auto [crosses, circles] = crosses_and_circles_of( game );
+        const Tablebase_3x3::Result answer = tablebase.best_move_for( game.board, player );
+        const bool move_is_free = (game.board.free_cells() & ttt::Board::bit( answer.move )) != 0;
+        if( tablebase.score_of( crosses, circles ) != expected
+            or answer.score != expected or not move_is_free ) {
+            ++result;
+        }
+    }
+    printf( "3×3: %d reachable unfinished positions checked against the solver.\n",
+        int( games.size() )
+        );
+    return result;
+}
+
+// Random play to a position with `n_pieces` pieces that isn’t over.
+auto random_game_4x4( const int n_pieces )
+    -> Game_4x4
+{
+    for( ;; ) {
+        Game_4x4 game;
+        while( not game.is_over() and game.n_moves < n_pieces ) {
+            const int n_free = Board_4x4::n_cells - game.n_moves;
+            game.make_move( game.board.nth_free_cell( int( cu::random_up_to( n_free ) ) ) );
+        }
+        if( not game.is_over() ) { return game; }
+    }
+}
+
+void cpp_main()
+{
+    const int n_mismatches_3x3 = n_3x3_mismatches();
+
+    printf( "\n%-24s %12s\n", "4×4 generation", "seconds" );
+    Tablebase_4x4::Generation_statistics stats;
+    for( const int n_threads: {1, 2, 4, 8} ) {
+        stats = Tablebase_4x4::generate( "4x4.tttb", n_threads );
+        printf( "%2d thread(s)%12s %12.3f\n", n_threads, "", stats.seconds );
+    }
+    printf( "\n%lld positions with legal piece counts, %lld stored (%.1f%%), %.1f MB file.\n",
+        (long long) stats.n_positions, (long long) stats.n_stored,
+        100.0*stats.n_stored/stats.n_positions, stats.n_bytes/1e6
+        );
+
+    const Tablebase_4x4 tablebase( "4x4.tttb" );
+    cu::seed_random_bits_for_this_thread( 42 );
+    vector<Game_4x4> games;
+    for( int i = 0; i < 100'000; ++i ) {
+        games.push_back( random_game_4x4( int( cu::random_up_to( Board_4x4::n_cells ) ) ) );
+    }
+    const int n_repetitions = 20;
+    int checksum = 0;
+    const auto start = chr::steady_clock::now();
+    for( int r = 0; r < n_repetitions; ++r ) {
+        for( const Game_4x4& game: games ) {
+            const auto [crosses, circles] = crosses_and_circles_of( game );
+            checksum += tablebase.score_of( crosses, circles );
+        }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    the_sink = checksum;
+    printf( "%.1f ns per probe of a random position.\n",
+        1e9*seconds/(double( n_repetitions )*games.size())
+        );
+
+    const int n_samples = 300;
+    int n_mismatches_4x4 = 0;
+    for( int i = 0; i < n_samples; ++i ) {
+        const Game_4x4 game = random_game_4x4( 8 + int( cu::random_up_to( 8 ) ) );
+        const auto [own, opponent] = own_and_opponent_of( game );
+        const auto [crosses, circles] = crosses_and_circles_of( game );
+        if( tablebase.score_of( crosses, circles ) != negamax_score<Board_4x4>( own, opponent ) ) {
+            ++n_mismatches_4x4;
+        }
+    }
+    printf( "4×4: %d sampled positions with 8 or more pieces checked against negamax.\n",
+        n_samples
+        );
+
+    cu::hopefully( n_mismatches_3x3 == 0 )
+        or CPPUTIL_FAIL( std::to_string( n_mismatches_3x3 ) + " 3×3 tablebase answers are wrong." );
+    cu::hopefully( n_mismatches_4x4 == 0 )
+        or CPPUTIL_FAIL( std::to_string( n_mismatches_4x4 ) + " 4×4 tablebase scores are wrong." );
+}
+
+auto main() -> int
+{
+    try {
+        cpp_main();
+        return EXIT_SUCCESS;
+    } catch( const exception& x ) {
+        fprintf( stderr, "!%s\n", x.what() );
+    }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless benchmark of `ttt::Ultimate_search`: node throughput, time to a fixed depth and
+// speedup for 1, 2, 4 and 8 threads, over a few ultimate tic-tac-toe positions.
+//
+// Making and unmaking moves is checked to restore the game and its hash, and single-thread
+// alpha-beta scores are checked to equal plain minimax scores at a small depth.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I.. ultimate-search.cpp -o ultimate-search && ./ultimate-search
+
+#include "../ttt-Ultimate_game.hpp"
+#include "../ttt-Ultimate_search.hpp"
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int8_t, int64_t, uint64_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::(max, min)
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace cu    = cpp::util;
+using   std::max, std::min,
+        std::array,
+        std::thread,
+        std::vector;
+using   ttt::Ultimate_game, ttt::Ultimate_search;
+
+// A game after `n_moves` random moves, not over.
+auto random_game( const int n_moves )
+    -> Ultimate_game
+{
+    for( ;; ) {
+        Ultimate_game game;
+        array<int8_t, Ultimate_game::n_cells> moves;
+        while( not game.is_over() and game.n_moves < n_moves ) {
+            const int n = game.legal_moves( moves );
+            game.make_move( moves[cu::random_up_to( n )] );
+        }
+        if( not game.is_over() ) { return game; }
+    }
+}
+
+auto hash_from_scratch( const Ultimate_game& game )
+    -> uint64_t
+{
+    const auto& keys = Ultimate_game::zobrist_keys;
+    uint64_t result = keys.forced[game.forced + 1];
+    for( int s = 0; s < Ultimate_game::n_sub_boards; ++s ) {
+        for( int c = 0; c < ttt::Board::n_cells; ++c ) {
+            const ttt::cell_state::Enum state = game.sub_boards[s].cells[c];
+            if( state != ttt::cell_state::empty ) {
+                result ^= keys.cells[state - 1][ttt::Board::n_cells*s + c];
+            }
+        }
+    }
+    return result;
+}
+
+auto same_position( const Ultimate_game& a, const Ultimate_game& b )
+    -> bool
+{
+    for( int s = 0; s < Ultimate_game::n_sub_boards; ++s ) {
+        if( a.sub_boards[s].cells != b.sub_boards[s].cells ) { return false; }
+    }
+    return a.meta.cells == b.meta.cells and a.decided == b.decided and a.forced == b.forced
+        and a.n_moves == b.n_moves and a.is_won == b.is_won and a.hash == b.hash;
+}
+
+// Random games played to the end and then unmade move by move.
+auto make_unmake_is_consistent()
+    -> bool
+{
+    for( int i = 0; i < 2000; ++i ) {
+        Ultimate_game game;
+        vector<Ultimate_game> history;
+        array<int8_t, Ultimate_game::n_cells> moves;
+        while( not game.is_over() ) {
+            if( game.hash != hash_from_scratch( game ) ) { return false; }
+            history.push_back( game );
+            const int n = game.legal_moves( moves );
+            game.make_move( moves[cu::random_up_to( n )] );
+        }
+        while( game.n_moves > 0 ) {
+            game.unmake_move();
+            if( not same_position( game, history[game.n_moves] ) ) { return false; }
+        }
+    }
+    return true;
+}
+
+auto minimax( Ultimate_game& game, const int depth, const int ply )
+    -> int
+{
+    if( game.is_won ) { return -(Ultimate_game::win_score - ply); }
+    array<int8_t, Ultimate_game::n_cells> moves;
+    const int n_moves = game.legal_moves( moves );
+    if( n_moves == 0 ) { return 0; }
+    if( depth == 0 ) { return game.static_score(); }
+    int best = -Ultimate_game::win_score - 1;
+    for( int i = 0; i < n_moves; ++i ) {
+        game.make_move( moves[i] );
+        best = max( best, -minimax( game, depth - 1, ply + 1 ) );
+        game.unmake_move();
+    }
+    return best;
+}
+
+auto n_score_mismatches()
+    -> int
+{
+    Ultimate_search::Options options;
+    options.n_threads = 1;
+    options.max_depth = 4;
+    options.log2_table_size = 16;
+    Ultimate_search search( options );
+    int result = 0;
+    for( int i = 0; i < 100; ++i ) {
+        Ultimate_game game = random_game( int( cu::random_up_to( 50 ) ) );
+        search.clear_table();
+        const int score = search.best_move_for( game ).score;
+        if( score != minimax( game, options.max_depth, 0 ) ) { ++result; }
+    }
+    return result;
+}
+
+void benchmark( const vector<Ultimate_game>& games, const int depth )
+{
+    const int n_cores = max( 1, int( thread::hardware_concurrency() ) );
+    printf( "%d positions searched to depth %d, %d cores:\n", int( games.size() ), depth, n_cores );
+    printf( "%8s %14s %14s %12s %10s\n", "threads", "nodes/sec", "per core", "seconds", "speedup" );
+
+    double single_thread_seconds = 0;
+    for( const int n_threads: {1, 2, 4, 8} ) {
+        Ultimate_search::Options options;
+        options.n_threads = n_threads;
+        options.max_depth = depth;
+        int64_t n_nodes = 0;
+        double seconds = 0;
+        for( const Ultimate_game& game: games ) {
+            Ultimate_search search( options );
+            const Ultimate_search::Result result = search.best_move_for( game );
+            n_nodes += result.n_nodes;
+            seconds += result.seconds;
+        }
+        if( n_threads == 1 ) { single_thread_seconds = seconds; }
+        const double rate = n_nodes/seconds;
+        printf( "%8d %14.0f %14.0f %12.3f %10.2f\n",
+            n_threads, rate, rate/min( n_threads, n_cores ), seconds, single_thread_seconds/seconds
+            );
+    }
+}
+
+auto main() -> int
+{
+    cu::seed_random_bits_for_this_thread( 42 );
+    if( not make_unmake_is_consistent() ) {
+        fprintf( stderr, "!Unmaking moves doesn’t restore the game.\n" );
+        return EXIT_FAILURE;
+    }
+    if( const int n = n_score_mismatches(); n > 0 ) {
+        fprintf( stderr, "!%d alpha-beta scores differ from minimax.\n", n );
+        return EXIT_FAILURE;
+    }
+    printf( "Make/unmake and alpha-beta versus minimax checks passed.\n\n" );
+
+    vector<Ultimate_game> games;
+    for( int i = 0; i < 6; ++i ) { games.push_back( random_game( 4 + 2*i ) ); }
+    benchmark( games, 10 );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,337 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>     // cpp::util::No_copying
+
+#include <stdint.h>         // int64_t, uint64_t
+#include <stdio.h>          // snprintf
+#include <string.h>         // strcmp
+
+#include <algorithm>        // std::(max, min, sort)
+#include <atomic>           // std::(atomic, memory_order_relaxed)
+#include <chrono>           // std::chrono::*
+#include <memory>           // std::unique_ptr
+#include <mutex>            // std::(mutex, lock_guard)
+#include <string>           // std::string
+#include <vector>           // std::vector
+
+#ifdef _MSC_VER
+#   include <intrin.h>          // __rdtsc, _BitScanReverse64
+#elif defined( __x86_64__ )
+#   include <x86intrin.h>       // __rdtsc
+#endif
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#   define CPPUTIL_INSTRUMENTATION_USES_TSC
+#endif
+
+// Named scoped timers. With `CPPUTIL_INSTRUMENTATION` defined,
+//
+//      CPPUTIL_TIMED_SCOPE( "paint" );           // Times the rest of the enclosing scope.
+//      CPPUTIL_TIMED( "draw_on" ) { ... }        // Times the block, like `CPPUTIL_WITH`.
+//
+// record durations in per-thread histograms, one per name, that are merged on demand by e.g.
+// `cpp::util::instrumentation::timings_as_text()`. Otherwise the macros expand to nothing.
+// The name must be a string literal.
+#ifdef CPPUTIL_INSTRUMENTATION
+#   define CPPUTIL_TIMED_SCOPE( name ) \
+        CPPUTIL_TIMED_SCOPE_AT_LINE_( name, __LINE__ )
+#   define CPPUTIL_TIMED_SCOPE_AT_LINE_( name, line ) \
+        CPPUTIL_TIMED_SCOPE_WITH_IDS_( name, cpputil_timer_site_##line, cpputil_timer_##line )
+#   define CPPUTIL_TIMED_SCOPE_WITH_IDS_( name, site_id, timer_id ) \
+        static const ::cpp::util::instrumentation::Site site_id( "" name ); \
+        const ::cpp::util::instrumentation::Scoped_timer timer_id( site_id )
+#   define CPPUTIL_TIMED( name ) \
+        if( static const ::cpp::util::instrumentation::Site cpputil_timer_site( "" name ); true ) \
+        if( const ::cpp::util::instrumentation::Scoped_timer cpputil_timer( cpputil_timer_site ); \
+            ((void) cpputil_timer, true) )
+#else
+#   define CPPUTIL_TIMED_SCOPE( name )  static_assert( true, "" )
+#   define CPPUTIL_TIMED( name )        if( true )
+#endif
+
+namespace cpp::util::instrumentation {
+    namespace chr = std::chrono;
+    using   std::max, std::min, std::sort,
+            std::atomic, std::memory_order_relaxed,
+            std::unique_ptr,
+            std::mutex, std::lock_guard,
+            std::string,
+            std::vector;
+
+    namespace impl {
+        // The time stamp counter where available, which is invariant on current x86-64 CPUs and
+        // costs a few ns as opposed to tens of ns for a system call based clock. Ticks are only
+        // converted to ns when reporting.
+        inline auto ticks_now()
+            -> uint64_t
+        {
+            #ifdef CPPUTIL_INSTRUMENTATION_USES_TSC
+                return __rdtsc();
+            #else
+                const auto t = chr::steady_clock::now().time_since_epoch();
+                return uint64_t( chr::duration_cast<chr::nanoseconds>( t ).count() );
+            #endif
+        }
+
+        inline auto highest_bit_index( const uint64_t bits )        // `bits` ≠ 0.
+            -> int
+        {
+            #ifdef _MSC_VER
+                unsigned long result;
+                _BitScanReverse64( &result, bits );
+                return static_cast<int>( result );
+            #else
+                return 63 - __builtin_clzll( bits );
+            #endif
+        }
+
+        // Only the owner thread modifies a counter, so a load and a store suffice.
+        inline void add_to( atomic<uint64_t>& counter, const uint64_t v )
+        {
+            counter.store( counter.load( memory_order_relaxed ) + v, memory_order_relaxed );
+        }
+    }  // namespace impl
+
+    // An HDR style log-linear histogram of durations in ticks: each power of 2 range is split
+    // in 32 equal buckets, which gives at most about 3% relative error over the full 64-bit
+    // range in 15 KB. Written by one thread, and read at any time by any thread.
+    class Histogram:
+        public No_copying
+    {
+    public:
+        enum{
+            sub_bucket_bits     = 5,
+            sub_bucket_count    = 1 << sub_bucket_bits,
+            n_buckets           = (64 - sub_bucket_bits + 1)*sub_bucket_count
+        };
+
+        static auto bucket_of( const uint64_t v )
+            -> int
+        {
+            if( v < sub_bucket_count ) { return int( v ); }
+            const int shift = impl::highest_bit_index( v ) - sub_bucket_bits;
+            return (shift + 1)*sub_bucket_count + int( (v >> shift) - sub_bucket_count );
+        }
+
+        // The middle of the bucket’s value range.
+        static auto value_of( const int bucket )
+            -> double
+        {
+            if( bucket < sub_bucket_count ) { return bucket; }
+            const int shift = bucket/sub_bucket_count - 1;
+            const auto lowest = uint64_t( sub_bucket_count + bucket%sub_bucket_count ) << shift;
+            return double( lowest ) + double( (uint64_t( 1 ) << shift) - 1 )/2;
+        }
+
+        atomic<uint64_t>    counts[n_buckets]   = {};
+        atomic<uint64_t>    n_values            {0};
+        atomic<uint64_t>    sum                 {0};
+        atomic<uint64_t>    max_value           {0};
+
+        void add( const uint64_t v )        // Owner thread only.
+        {
+            impl::add_to( counts[bucket_of( v )], 1 );
+            impl::add_to( n_values, 1 );
+            impl::add_to( sum, v );
+            if( v > max_value.load( memory_order_relaxed ) ) { max_value.store( v, memory_order_relaxed ); }
+        }
+    };
+
+    // The merged timings of a site, in nanoseconds.
+    struct Timer_stats
+    {
+        string      name;
+        int64_t     count;
+        double      total_ns;
+        double      mean_ns;
+        double      p50_ns;
+        double      p90_ns;
+        double      p99_ns;
+        double      max_ns;
+    };
+
+    // Owns all sites and all per-thread histograms, also those of threads that have ended.
+    class Registry:
+        public No_copying
+    {
+        struct Thread_histogram{ int site_id; unique_ptr<Histogram> histogram; };
+
+        mutable mutex               m_mutex;
+        vector<const char*>         m_site_names;
+        vector<Thread_histogram>    m_histograms;
+        chr::steady_clock::time_point   m_start_time    = chr::steady_clock::now();
+        uint64_t                    m_start_ticks       = impl::ticks_now();
+
+        Registry() {}
+
+        // From the elapsed ticks and time since the start, over at least 10 ms.
+        auto ns_per_tick() const
+            -> double
+        {
+            #ifdef CPPUTIL_INSTRUMENTATION_USES_TSC
+                chr::steady_clock::time_point now;
+                uint64_t ticks;
+                do {
+                    now = chr::steady_clock::now();
+                    ticks = impl::ticks_now();
+                } while( now - m_start_time < chr::milliseconds( 10 ) );
+                const double ns = chr::duration<double, std::nano>( now - m_start_time ).count();
+                return ns/double( ticks - m_start_ticks );
+            #else
+                return 1;
+            #endif
+        }
+
+        static auto percentile( const vector<uint64_t>& counts, const uint64_t n, const double p )
+            -> double
+        {
+            const auto rank = max<uint64_t>( 1, uint64_t( p/100*double( n ) + 0.5 ) );
+            uint64_t n_so_far = 0;
+            for( int i = 0; i < Histogram::n_buckets; ++i ) {
+                n_so_far += counts[i];
+                if( n_so_far >= rank ) { return Histogram::value_of( i ); }
+            }
+            return 0;
+        }
+
+    public:
+        static auto instance()
+            -> Registry&
+        {
+            static Registry the_registry;
+            return the_registry;
+        }
+
+        // Sites with the same name, e.g. in template instantiations, share the id.
+        auto id_of_site( const char* const name )
+            -> int
+        {
+            const lock_guard<mutex> lock( m_mutex );
+            for( int i = 0; i < int( m_site_names.size() ); ++i ) {
+                if( strcmp( m_site_names[i], name ) == 0 ) { return i; }
+            }
+            m_site_names.push_back( name );
+            return int( m_site_names.size() ) - 1;
+        }
+
+        auto new_histogram_for( const int site_id )
+            -> Histogram*
+        {
+            const lock_guard<mutex> lock( m_mutex );
+            m_histograms.push_back( {site_id, unique_ptr<Histogram>( new Histogram() )} );
+            return m_histograms.back().histogram.get();
+        }
+
+        // Merges the per-thread histograms. Ordered by descending total time.
+        auto stats() const
+            -> vector<Timer_stats>
+        {
+            const double ns_per_tick = this->ns_per_tick();
+            const lock_guard<mutex> lock( m_mutex );
+            const int n_sites = int( m_site_names.size() );
+            vector<vector<uint64_t>> counts( n_sites, vector<uint64_t>( Histogram::n_buckets ) );
+            vector<Timer_stats> result( n_sites );
+            vector<uint64_t> max_values( n_sites );
+            for( const Thread_histogram& th: m_histograms ) {
+                const Histogram& h = *th.histogram;
+                vector<uint64_t>& site_counts = counts[th.site_id];
+                for( int i = 0; i < Histogram::n_buckets; ++i ) {
+                    site_counts[i] += h.counts[i].load( memory_order_relaxed );
+                }
+                Timer_stats& s = result[th.site_id];
+                s.count += int64_t( h.n_values.load( memory_order_relaxed ) );
+                s.total_ns += double( h.sum.load( memory_order_relaxed ) );
+                max_values[th.site_id] = max( max_values[th.site_id], h.max_value.load( memory_order_relaxed ) );
+            }
+            for( int id = 0; id < n_sites; ++id ) {
+                Timer_stats& s = result[id];
+                uint64_t n = 0;     // The counts can be ahead of `s.count` for a running thread.
+                for( const uint64_t c: counts[id] ) { n += c; }
+                const double max_ticks = double( max_values[id] );
+                s.name      = m_site_names[id];
+                s.total_ns  *= ns_per_tick;
+                s.mean_ns   = (s.count == 0? 0 : s.total_ns/double( s.count ));
+                s.p50_ns    = ns_per_tick*min( max_ticks, percentile( counts[id], n, 50 ) );
+                s.p90_ns    = ns_per_tick*min( max_ticks, percentile( counts[id], n, 90 ) );
+                s.p99_ns    = ns_per_tick*min( max_ticks, percentile( counts[id], n, 99 ) );
+                s.max_ns    = ns_per_tick*max_ticks;
+            }
+            sort( result.begin(), result.end(), []( const Timer_stats& a, const Timer_stats& b ) {
+                return a.total_ns > b.total_ns;
+            } );
+            return result;
+        }
+    };
+
+    class Site:
+        public No_copying
+    {
+        int     m_id;
+
+    public:
+        explicit Site( const char* const name ): m_id( Registry::instance().id_of_site( name ) ) {}
+        auto id() const -> int { return m_id; }
+    };
+
+    inline void record( const Site& site, const uint64_t ticks )
+    {
+        static thread_local vector<Histogram*> t_histograms;    // Indexed by site id.
+        const int id = site.id();
+        if( id >= int( t_histograms.size() ) ) { t_histograms.resize( id + 1 ); }
+        Histogram*& p_histogram = t_histograms[id];
+        if( not p_histogram ) { p_histogram = Registry::instance().new_histogram_for( id ); }
+        p_histogram->add( ticks );
+    }
+
+    class Scoped_timer:
+        public No_copying
+    {
+        const Site&     m_site;
+        uint64_t        m_start;
+
+    public:
+        explicit Scoped_timer( const Site& site ): m_site( site ), m_start( impl::ticks_now() ) {}
+        ~Scoped_timer() { record( m_site, impl::ticks_now() - m_start ); }
+    };
+
+    inline auto stats() -> vector<Timer_stats> { return Registry::instance().stats(); }
+
+    inline auto timings_as_text()
+        -> string
+    {
+        string result;
+        char line[256];
+        snprintf( line, sizeof( line ), "%-32s %10s %12s %10s %10s %10s %10s %10s\n",
+            "Timer", "count", "total ms", "mean µs", "p50 µs", "p90 µs", "p99 µs", "max µs"
+            );
+        result += line;
+        for( const Timer_stats& s: stats() ) {
+            snprintf( line, sizeof( line ), "%-32s %10lld %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                s.name.c_str(), (long long) s.count, s.total_ns/1e6, s.mean_ns/1e3,
+                s.p50_ns/1e3, s.p90_ns/1e3, s.p99_ns/1e3, s.max_ns/1e3
+                );
+            result += line;
+        }
+        return result;
+    }
+
+    inline auto timings_as_json()
+        -> string
+    {
+        string result = "[";
+        for( const Timer_stats& s: stats() ) {
+            string name;
+            for( const char ch: s.name ) {
+                if( ch == '"' or ch == '\\' ) { name += '\\'; }
+                name += ch;
+            }
+            char fields[256];
+            snprintf( fields, sizeof( fields ),
+                "\"count\": %lld, \"total_ns\": %.0f, \"mean_ns\": %.1f, "
+                "\"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f",
+                (long long) s.count, s.total_ns, s.mean_ns, s.p50_ns, s.p90_ns, s.p99_ns, s.max_ns
+                );
+            result += string( result.size() == 1? "\n" : ",\n" )
+                + "    {\"name\": \"" + name + "\", " + fields + "}";
+        }
+        return result + "\n]\n";
+    }
+}  // namespace cpp::util::instrumentation
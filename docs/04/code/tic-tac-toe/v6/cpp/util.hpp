@@ -1,16 +1,23 @@
 ﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
 
 #include <assert.h>
-#include <random>
+#include <stdint.h>
+#include <random>           // std::random_device
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#   include <intrin.h>     // __popcnt, _BitScanForward
+#endif
 
 #define CPPUTIL_FAIL( s ) ::cpp::util::fail( std::string( __func__ ) + " - " + (s) )
 
 namespace cpp::util {
-    using   std::random_device, std::mt19937, std::uniform_int_distribution,
+    using   std::random_device,
             std::exception, std::runtime_error,
-            std::string;
+            std::string,
+            std::is_unsigned_v;
 
     constexpr auto utf8_is_the_execution_character_set()
         -> bool
@@ -31,6 +38,45 @@ namespace cpp::util {
 
     constexpr auto squared( const int v ) -> int { return v*v; }
 
+    // Number of 1-bits in `bits`, a.k.a. popcount.
+    template< class Unsigned >
+    inline auto bit_count( const Unsigned bits )
+        -> int
+    {
+        static_assert( is_unsigned_v<Unsigned> and sizeof( Unsigned ) <= 8 );
+        if constexpr( sizeof( Unsigned ) > 4 ) {
+            return bit_count( uint32_t( bits ) ) + bit_count( uint32_t( bits >> 32 ) );
+        } else {
+            #ifdef _MSC_VER
+                return static_cast<int>( __popcnt( bits ) );
+            #else
+                return __builtin_popcount( bits );
+            #endif
+        }
+    }
+
+    // Index of the least significant 1-bit, a.k.a. count of trailing zeros. `bits` ≠ 0.
+    template< class Unsigned >
+    inline auto lowest_bit_index( const Unsigned bits )
+        -> int
+    {
+        static_assert( is_unsigned_v<Unsigned> and sizeof( Unsigned ) <= 8 );
+        assert( bits != 0 );
+        if constexpr( sizeof( Unsigned ) > 4 ) {
+            const auto low_bits = uint32_t( bits );
+            return (low_bits != 0? lowest_bit_index( low_bits )
+                : 32 + lowest_bit_index( uint32_t( bits >> 32 ) ));
+        } else {
+            #ifdef _MSC_VER
+                unsigned long result;
+                _BitScanForward( &result, bits );
+                return static_cast<int>( result );
+            #else
+                return __builtin_ctz( bits );
+            #endif
+        }
+    }
+
     struct Range
     {
         int     first;
@@ -42,14 +88,119 @@ namespace cpp::util {
     { return range.first <= v and v <= range.last; }
 
 
-    inline auto random_in( const Range& range )
-        -> int
+    // Sebastiano Vigna’s splitmix64: a trivial generator, used to expand a seed, and usable at
+    // compile time, e.g. for Zobrist hash keys.
+    class Splitmix64
+    {
+        uint64_t    m_state;
+
+    public:
+        constexpr explicit Splitmix64( const uint64_t seed ): m_state( seed ) {}
+
+        constexpr auto next()
+            -> uint64_t
+        {
+            uint64_t z = (m_state += 0x9E3779B97F4A7C15u);
+            z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9u;
+            z = (z ^ (z >> 27))*0x94D049BB133111EBu;
+            return z ^ (z >> 31);
+        }
+    };
+
+    // David Blackman & Sebastiano Vigna’s xoshiro256**: 32 bytes of state, a few cycles per
+    // 64 bits, and good statistical quality. Meets the UniformRandomBitGenerator requirements,
+    // so it can also be used with the `<random>` distributions.
+    class Random_bits
+    {
+        uint64_t    m_state[4];
+
+        static constexpr auto rotl( const uint64_t x, const int k )
+            -> uint64_t
+        { return (x << k) | (x >> (64 - k)); }
+
+    public:
+        using result_type = uint64_t;
+        static constexpr auto min() -> result_type { return 0; }
+        static constexpr auto max() -> result_type { return ~result_type( 0 ); }
+
+        explicit Random_bits( const uint64_t seed ) { this->seed( seed ); }
+
+        void seed( const uint64_t seed )
+        {
+            Splitmix64 seeder( seed );
+            for( uint64_t& part: m_state ) { part = seeder.next(); }
+        }
+
+        auto operator()()
+            -> uint64_t
+        {
+            uint64_t* const s = m_state;
+            const uint64_t result = rotl( s[1]*5, 7 )*9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];  s[3] ^= s[1];  s[1] ^= s[2];  s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl( s[3], 45 );
+            return result;
+        }
+
+        // An unbiased number in 0 through `beyond` - 1, by Daniel Lemire’s multiply-and-shift
+        // method, which only rarely needs a division. `beyond` = 0 means 2^32.
+        auto up_to( const uint32_t beyond )
+            -> uint32_t
+        {
+            if( beyond == 0 ) { return uint32_t( operator()() >> 32 ); }
+            uint64_t product = (operator()() >> 32)*beyond;
+            if( uint32_t( product ) < beyond ) {
+                const uint32_t threshold = uint32_t( -beyond ) % beyond;    // 2^32 mod beyond.
+                while( uint32_t( product ) < threshold ) {
+                    product = (operator()() >> 32)*beyond;
+                }
+            }
+            return uint32_t( product >> 32 );
+        }
+
+        auto in( const Range& range )
+            -> int
+        {
+            assert( range.first <= range.last );
+            const auto n_values = uint32_t( int64_t( range.last ) - range.first + 1 );
+            return int( int64_t( range.first ) + up_to( n_values ) );
+        }
+
+        // Bulk generation, e.g. for precomputed playout sequences.
+        template< class Iterator >
+        void fill( const Iterator start, const Iterator beyond )
+        {
+            for( Iterator it = start; it != beyond; ++it ) { *it = operator()(); }
+        }
+
+        template< class Iterator >
+        void fill_in( const Range& range, const Iterator start, const Iterator beyond )
+        {
+            for( Iterator it = start; it != beyond; ++it ) { *it = in( range ); }
+        }
+    };
+
+    // An instance per thread, so that parallel simulations don’t share state. Seeded from
+    // `random_device` unless `seed_random_bits_for_this_thread` is called first.
+    inline auto random_bits_for_this_thread()
+        -> Random_bits&
+    {
+        static thread_local Random_bits the_bits( (uint64_t( random_device()() ) << 32)
+            ^ random_device()() );
+        return the_bits;
+    }
+
+    // For reproducible runs; give each thread its own seed.
+    inline void seed_random_bits_for_this_thread( const uint64_t seed )
     {
-        static random_device    entropy;
-        static mt19937          bits( entropy() );
-        return uniform_int_distribution<>( range.first, range.last )( bits );
+        random_bits_for_this_thread().seed( seed );
     }
 
+    inline auto random_in( const Range& range )
+        -> int
+    { return random_bits_for_this_thread().in( range ); }
+
     inline auto random_up_to( const int beyond )
         -> int
     { return random_in({ 0, beyond - 1 }); }
@@ -0,0 +1,383 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Headless self-play: N games between two strategies, on a number of worker threads, with
+// win/draw/loss counts, games per second and per-move latency percentiles from fixed size
+// histograms.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I.. self-play.cpp -o self-play
+//      ./self-play --games 1000000 --x heuristic --o perfect --threads 8 --record games.ttt
+//      ./self-play --board 4x4 --x mcts --o tablebase --tablebase 4x4.tttb
+//      ./self-play --help
+//
+// With `--record` the games are appended to a `ttt::game_records` file, by each worker in
+// batches of about 64 KB, so that memory use doesn’t grow with the number of games. The
+// `tablebase` strategy needs a file made by `ttt::Tablebase_::generate` for the board, e.g. by
+// the tablebase benchmark. `--level` sets the difficulty level for the `timed` strategy.
+//
+// Built with `-DCPPUTIL_INSTRUMENTATION` the engine’s scoped timers are enabled, and
+// `--timings text` or `--timings json` prints their merged histograms at the end.
+//
+// Each worker owns its `Game`, its search state and its statistics; the only shared mutable
+// state is the records file, behind a mutex. The per-worker results are merged after all
+// workers have finished.
+
+#define TTT_WITH_MOVE_TABLE     // For `strategy::table`.
+
+#include "../ttt-Board.hpp"
+#include "../ttt-Game.hpp"
+#include "../ttt-Game_records.hpp"
+#include "../ttt-Mcts.hpp"
+#include "../ttt-Tablebase.hpp"
+#include <cpp/instrumentation.hpp>  // cpp::util::instrumentation::timings_as_...
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t, uint8_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_..., strtoll
+
+#include <algorithm>    // std::max
+#include <chrono>
+#include <exception>    // std::(exception, exception_ptr, current_exception, rethrow_exception)
+#include <iterator>     // std::size
+#include <mutex>        // std::(mutex, lock_guard)
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   cu::hopefully;
+using   std::max,
+        std::exception, std::exception_ptr, std::current_exception, std::rethrow_exception,
+        std::mutex, std::lock_guard,
+        std::optional,
+        std::string,
+        std::string_view,
+        std::thread,
+        std::vector;
+namespace strategy = ttt::strategy;
+namespace difficulty = ttt::difficulty;
+#define FAIL CPPUTIL_FAIL
+
+struct Options
+{
+    int64_t             n_games         = 100'000;
+    strategy::Enum      x_strategy      = strategy::heuristic;
+    strategy::Enum      o_strategy      = strategy::heuristic;
+    int                 n_threads       = max( 1, int( thread::hardware_concurrency() ) );
+    string              board           = "3x3";
+    int64_t             mcts_playouts   = 2'000;
+    string              record_path     = "";
+    string              tablebase_path  = "";
+    difficulty::Enum    level           = difficulty::medium;
+    string              timings_format  = "";
+    bool                help            = false;
+};
+
+constexpr auto usage_text = R"(Usage: self-play [OPTION VALUE]...
+Plays games between two strategies on worker threads, and reports outcomes and move latencies.
+
+  --games N             number of games, default 100000
+  --x STRATEGY          strategy for x, default heuristic
+  --o STRATEGY          strategy for o, default heuristic
+  --threads N           number of worker threads, default the number of hardware threads
+  --board SIZE          3x3 (default), 4x4 or 15x15
+  --mcts-playouts N     playouts per move for the mcts strategy, default 2000
+  --record PATH         append the games to a game records file
+  --tablebase PATH      tablebase file for the tablebase strategy
+  --level LEVEL         easy, medium (default), hard or expert, for the timed strategy
+  --timings FORMAT      text or json: print the scoped timers' histograms at the end
+  --help                show this help
+
+Strategies: heuristic, perfect, table, mcts, tablebase, timed. perfect and table need a 3x3 board.
+)";
+
+constexpr string_view strategy_names[] = { "heuristic", "perfect", "table", "mcts", "tablebase", "timed" };
+constexpr string_view level_names[] = { "easy", "medium", "hard", "expert" };
+
+auto strategy_from( const string_view& name )
+    -> strategy::Enum
+{
+    for( int i = 0; i < int( std::size( strategy_names ) ); ++i ) {
+        if( name == strategy_names[i] ) { return strategy::Enum( i ); }
+    }
+    FAIL( "Unknown strategy “" + string( name ) + "”." );
+    for( ;; ) {}    // Should never get here.
+}
+
+auto level_from( const string_view& name )
+    -> difficulty::Enum
+{
+    for( int i = 0; i < int( std::size( level_names ) ); ++i ) {
+        if( name == level_names[i] ) { return difficulty::Enum( i ); }
+    }
+    FAIL( "Unknown difficulty level “" + string( name ) + "”." );
+    for( ;; ) {}    // Should never get here.
+}
+
+auto options_from( const int n_args, char** args )
+    -> Options
+{
+    Options result;
+    for( int i = 1; i < n_args; ++i ) {
+        const string_view name = args[i];
+        if( name == "--help" ) { result.help = true;  continue; }
+        hopefully( i + 1 < n_args ) or FAIL( "Missing value for option " + string( name ) + "." );
+        const string_view value = args[++i];
+        const auto number = [&]() -> int64_t
+        {
+            const int64_t v = strtoll( value.data(), nullptr, 10 );
+            hopefully( v > 0 ) or FAIL( "Option " + string( name ) + " needs a positive number." );
+            return v;
+        };
+        if(      name == "--games" )            { result.n_games = number(); }
+        else if( name == "--x" )                { result.x_strategy = strategy_from( value ); }
+        else if( name == "--o" )                { result.o_strategy = strategy_from( value ); }
+        else if( name == "--threads" )          { result.n_threads = int( number() ); }
+        else if( name == "--board" )            { result.board = value; }
+        else if( name == "--mcts-playouts" )    { result.mcts_playouts = number(); }
+        else if( name == "--record" )           { result.record_path = value; }
+        else if( name == "--tablebase" )        { result.tablebase_path = value; }
+        else if( name == "--level" )            { result.level = level_from( value ); }
+        else if( name == "--timings" )          { result.timings_format = value; }
+        else { FAIL( "Unknown option “" + string( name ) + "”." ); }
+    }
+    return result;
+}
+
+// Move latencies in ns, in the log-linear buckets of `cpp::util::instrumentation::Histogram`,
+// i.e. with percentiles to within about 3% in a fixed size regardless of the number of moves.
+struct Latencies
+{
+    using Histogram = cu::instrumentation::Histogram;
+
+    vector<uint64_t>    counts      = vector<uint64_t>( Histogram::n_buckets );
+    uint64_t            n_values    = 0;
+    uint64_t            max_value   = 0;
+
+    void add( const uint64_t ns )
+    {
+        ++counts[Histogram::bucket_of( ns )];  ++n_values;  max_value = max( max_value, ns );
+    }
+
+    void add( const Latencies& other )
+    {
+        for( int i = 0; i < Histogram::n_buckets; ++i ) { counts[i] += other.counts[i]; }
+        n_values += other.n_values;  max_value = max( max_value, other.max_value );
+    }
+
+    auto percentile( const double p ) const
+        -> double
+    {
+        if( n_values == 0 ) { return 0; }
+        if( p >= 100 ) { return double( max_value ); }
+        const auto rank = max<uint64_t>( 1, uint64_t( p/100*double( n_values ) + 0.5 ) );
+        uint64_t n_so_far = 0;
+        for( int i = 0; i < Histogram::n_buckets; ++i ) {
+            n_so_far += counts[i];
+            if( n_so_far >= rank ) { return Histogram::value_of( i ); }
+        }
+        return double( max_value );
+    }
+};
+
+struct Results
+{
+    int64_t         n_x_wins    = 0;
+    int64_t         n_o_wins    = 0;
+    int64_t         n_draws     = 0;
+    Latencies       move_ns[2];     // For x and o.
+
+    void add( const Results& other )
+    {
+        n_x_wins += other.n_x_wins;  n_o_wins += other.n_o_wins;  n_draws += other.n_draws;
+        for( int i = 0; i < 2; ++i ) { move_ns[i].add( other.move_ns[i] ); }
+    }
+};
+
+// The records file shared by the workers, which add their encoded games in batches.
+template< class Game >
+class Records_file
+{
+    mutex                               m_mutex;
+    ttt::game_records::Writer_<Game>    m_writer;
+
+public:
+    Records_file( const Options& options ):
+        m_writer( options.record_path, options.x_strategy, options.o_strategy )
+    {}
+
+    void add_batch( vector<uint8_t>& bytes, int64_t& n_records )
+    {
+        if( n_records == 0 ) { return; }
+        {
+            const lock_guard<mutex> lock( m_mutex );
+            m_writer.add_encoded( bytes.data(), bytes.size(), n_records );
+        }
+        bytes.clear();  n_records = 0;
+    }
+};
+
+const int records_batch_size = 64*1024;     // Bytes.
+
+template< class Game >
+void play_games(
+    const Options& options, const int worker_index, Results& results, Records_file<Game>* p_records_file
+    )
+{
+    typename ttt::Mcts_<Game>::Options mcts_options;
+    mcts_options.n_threads      = 1;
+    mcts_options.max_playouts   = options.mcts_playouts;
+    mcts_options.max_seconds    = 1e6;
+    mcts_options.max_nodes      = 1 << 18;
+    mcts_options.seed           = unsigned( 12345 + worker_index );
+    ttt::Mcts_<Game> mcts( mcts_options );
+
+    vector<uint8_t> records;        // The batch of encoded games not yet written.
+    int64_t n_records = 0;
+    if( p_records_file ) { records.reserve( records_batch_size + 4*Game::Board::n_cells ); }
+
+    const strategy::Enum strategies[2] = { options.x_strategy, options.o_strategy };
+    for( int64_t i = worker_index; i < options.n_games; i += options.n_threads ) {
+        Game game;
+        while( not game.is_over() ) {
+            const int player = game.n_moves % 2;
+            const strategy::Enum choice = strategies[player];
+            const auto start = chr::steady_clock::now();
+            const int move = (choice == strategy::mcts
+                ? mcts.best_move_for( game )
+                : game.find_computer_move( choice, options.level ));
+            const auto elapsed = chr::steady_clock::now() - start;
+            results.move_ns[player].add( uint64_t( chr::duration_cast<chr::nanoseconds>( elapsed ).count() ) );
+            game.make_move( move );
+        }
+        if( p_records_file ) {
+            ttt::game_records::append_record( game, records );
+            ++n_records;
+            if( records.size() >= records_batch_size ) { p_records_file->add_batch( records, n_records ); }
+        }
+        if( not game.win_line ) {
+            ++results.n_draws;
+        } else if( game.board.cells[game.win_line->start] == ttt::cell_state::cross ) {
+            ++results.n_x_wins;
+        } else {
+            ++results.n_o_wins;
+        }
+    }
+    if( p_records_file ) { p_records_file->add_batch( records, n_records ); }
+}
+
+template< class Game >
+void run( const Options& options )
+{
+    using Board = typename Game::Board;
+    if( not options.tablebase_path.empty() ) {
+        if constexpr( ttt::tablebase_is_possible_for<Board> ) {
+            ttt::Tablebase_<Board>::load( options.tablebase_path );
+        } else {
+            FAIL( "A tablebase is only supported for boards up to 4x4." );
+        }
+    }
+
+    optional<Records_file<Game>> records_file;
+    if( not options.record_path.empty() ) { records_file.emplace( options ); }
+    Records_file<Game>* const p_records_file = (records_file? &*records_file : nullptr);
+
+    vector<Results> worker_results( size_t( options.n_threads ) );
+    vector<exception_ptr> worker_errors( size_t( options.n_threads ) );
+    const auto start = chr::steady_clock::now();
+    {
+        vector<thread> workers;
+        for( int t = 0; t < options.n_threads; ++t ) {
+            workers.emplace_back( [&, t]{
+                try {
+                    play_games<Game>( options, t, worker_results[t], p_records_file );
+                } catch( ... ) {
+                    worker_errors[t] = current_exception();
+                }
+            } );
+        }
+        for( thread& worker: workers ) { worker.join(); }
+    }
+    const auto seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    for( const exception_ptr& error: worker_errors ) { if( error ) { rethrow_exception( error ); } }
+
+    Results results;
+    for( const Results& r: worker_results ) { results.add( r ); }
+
+    const double n_games = double( options.n_games );
+    printf( "%lld games on a %s board with %d threads in %.3f seconds: %.0f games/sec.\n\n",
+        (long long) options.n_games, options.board.c_str(), options.n_threads,
+        seconds, n_games/seconds
+        );
+    const auto print_count = [&]( const char* title, const int64_t n )
+    {
+        printf( "%-12s %12lld %7.2f%%\n", title, (long long) n, 100*n/n_games );
+    };
+    print_count( "x wins", results.n_x_wins );
+    print_count( "draws", results.n_draws );
+    print_count( "o wins", results.n_o_wins );
+
+    printf( "\n%-22s %10s %10s %10s %10s %10s %10s\n",
+        "Move latency, µs", "moves", "p50", "p90", "p99", "p99.9", "max"
+        );
+    const strategy::Enum strategies[2] = { options.x_strategy, options.o_strategy };
+    for( int player = 0; player < 2; ++player ) {
+        const Latencies& ns = results.move_ns[player];
+        const string title =
+            string( player == 0? "x: " : "o: " ) + string( strategy_names[strategies[player]] );
+        printf( "%-22s %10lld %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+            title.c_str(), (long long) ns.n_values,
+            ns.percentile( 50 )/1000, ns.percentile( 90 )/1000, ns.percentile( 99 )/1000,
+            ns.percentile( 99.9 )/1000, ns.percentile( 100 )/1000
+            );
+    }
+
+    namespace instrumentation = cu::instrumentation;
+    if( options.timings_format == "text" ) {
+        printf( "\n%s", instrumentation::timings_as_text().c_str() );
+    } else if( options.timings_format == "json" ) {
+        printf( "\n%s", instrumentation::timings_as_json().c_str() );
+    }
+}
+
+void cpp_main( const int n_args, char** args )
+{
+    const Options options = options_from( n_args, args );
+    if( options.help ) {
+        printf( "%s", usage_text );
+        return;
+    }
+    for( const strategy::Enum choice: {options.x_strategy, options.o_strategy} ) {
+        const bool is_3x3_only = (choice == strategy::perfect or choice == strategy::table);
+        hopefully( options.board == "3x3" or not is_3x3_only )
+            or FAIL( "Strategy “" + string( strategy_names[choice] ) + "” needs a 3x3 board." );
+        hopefully( choice != strategy::tablebase or not options.tablebase_path.empty() )
+            or FAIL( "Strategy “tablebase” needs a --tablebase file." );
+    }
+    hopefully( options.timings_format == "" or options.timings_format == "text"
+        or options.timings_format == "json" )
+        or FAIL( "Unknown timings format “" + options.timings_format + "”; use text or json." );
+    if( options.board == "3x3" ) {
+        run<ttt::Game>( options );
+    } else if( options.board == "4x4" ) {
+        run<ttt::Game_<ttt::Board_<4, 4, 4>>>( options );
+    } else if( options.board == "15x15" ) {
+        run<ttt::Game_<ttt::Board_<15, 15, 5>>>( options );
+    } else {
+        FAIL( "Unsupported board “" + options.board + "”; use 3x3, 4x4 or 15x15." );
+    }
+}
+
+auto main( int n_args, char** args ) -> int
+{
+    try {
+        cpp_main( n_args, args );
+        return EXIT_SUCCESS;
+    } catch( const exception& x ) {
+        fprintf( stderr, "!%s\n", x.what() );
+    }
+    return EXIT_FAILURE;
+}
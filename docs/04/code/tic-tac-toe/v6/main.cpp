@@ -1,6 +1,6 @@
 ﻿#// Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
 
-// v6 - UTF-8 version. "π" should be a lowercase Greek pi.
+// v6 - UTF-8 version. "π" should be a lowercase Greek pi. Computer moves in the background.
 // v5 - Basic interaction (working game play, notification of win/lose/tie, restart).
 // v4 - Gross imperfections fixed: Windows standard GUI font; turned off topmost mode;
 //      modern look ’n feel via application manifest resource and initcontrolsex.
@@ -10,13 +10,16 @@
 // v1 - Roughly minimum code to display a window based on a dialog template resource.
 
 #include "ttt-Game.hpp"             // ttt::Game
+#include "ttt-Move_service.hpp"     // ttt::Move_service
 #include <winapi/util.hpp>          // winapi_util::*
 #include <cpp/util.hpp>
 #include "resources.h"              // IDS_RULES, IDC_RULES_DISPLAY, IDD_MAIN_WINDOW
 
 #include <assert.h>
+#include <stdint.h>     // int64_t, uint64_t
 #include <stdlib.h>     // EXIT_...
 
+#include <optional>
 #include <string>
 
 namespace cu    = cpp::util;
@@ -29,14 +32,21 @@ static_assert(
 
 using   cu::hopefully, cu::Range, cu::is_in;
 using   std::exception, std::optional, std::string, std::to_string;
-using   ttt::Board, ttt::Game;
+using   ttt::Board, ttt::Game, ttt::Move_service;
 #define FAIL CPPUTIL_FAIL
 
 constexpr int button_1_id = BOARD_BUTTON_BASE + 1;
 constexpr int button_9_id = BOARD_BUTTON_BASE + 9;
 
-static Game     the_game;
-static string   the_original_status_text;       // Initialized by `on_wm_initdialog`.
+// Posted by the move service’s worker thread, with the request’s ticket as WPARAM.
+constexpr UINT wm_computer_move     = WM_APP + 1;   // LPARAM is the cell index.
+constexpr UINT wm_search_progress   = WM_APP + 2;   // LPARAM is the number of playouts.
+
+constexpr auto the_computer_strategy = ttt::strategy::heuristic;
+
+static Game                     the_game;
+static optional<Move_service>   the_move_service;           // Created by `on_wm_initdialog`.
+static string                   the_original_status_text;   // Initialized by `on_wm_initdialog`.
 
 void set_status_text( const HWND window, const string& text )
 {
@@ -49,6 +59,7 @@ auto button_for_cell_index( const int i, const HWND window )
 
 void make_a_new_game( const HWND window )
 {
+    the_move_service->cancel();
     the_game = {};
     for( int i = 1; i <= 9; ++i ) {
         const HWND control = button_for_cell_index( i - 1, window );
@@ -83,20 +94,46 @@ void enter_game_over_state( const HWND window )
 void on_user_move( const HWND window, const int user_move )
 {
     using ttt::cell_state::empty;
-    if( the_game.board.cells[user_move] != empty or the_game.is_over() ) {
+    const bool is_computer_to_move = (the_game.player_to_move() == ttt::cell_state::circle);
+    if( the_game.board.cells[user_move] != empty or the_game.is_over() or is_computer_to_move ) {
         FlashWindow( window, true );    // Documentation per late 2021 is misleading/wrong.
         return;
     }
     the_game.make_move( user_move );
     SetWindowText( button_for_cell_index( user_move, window ), "\u2573" );          // cross
-    if( not the_game.is_over() ) {
-        const int computer_move = the_game.find_computer_move();
-        the_game.make_move( computer_move );
-        SetWindowText( button_for_cell_index( computer_move, window ), "\u25EF" );  // circle
+    if( the_game.is_over() ) {
+        enter_game_over_state( window );
+    } else {
+        the_move_service->request_move_for( the_game );    // Answered by `wm_computer_move`.
     }
+}
+
+void on_computer_move( const HWND window, const uint64_t ticket, const int computer_move )
+{
+    if( ticket != the_move_service->current_ticket() ) { return; }     // Cancelled.
+    the_game.make_move( computer_move );
+    SetWindowText( button_for_cell_index( computer_move, window ), "\u25EF" );      // circle
+    set_status_text( window, the_original_status_text );
     if( the_game.is_over() ) { enter_game_over_state( window ); }
 }
 
+void on_search_progress( const HWND window, const uint64_t ticket, const int64_t n_playouts )
+{
+    if( ticket != the_move_service->current_ticket() ) { return; }     // Cancelled.
+    set_status_text( window, "Thinking… (" + to_string( n_playouts ) + " playouts)" );
+}
+
+void post_to( const HWND window, const Move_service::Event& event )
+{
+    using Event = Move_service::Event;
+    const auto w_param = WPARAM( event.ticket );
+    if( event.kind == Event::move_found ) {
+        PostMessage( window, wm_computer_move, w_param, LPARAM( event.move ) );
+    } else {
+        PostMessage( window, wm_search_progress, w_param, LPARAM( event.n_playouts ) );
+    }
+}
+
 void set_app_icon( const HWND window )
 {
     wu::set_icon( window, wu::Resource_id{ IDI_APP } );
@@ -111,6 +148,7 @@ void set_rules_text( const HWND window )
 
 void on_wm_close( const HWND window )
 {
+    the_move_service.reset();       // Stops and joins the worker thread.
     EndDialog( window, IDOK );
 }
 
@@ -133,6 +171,10 @@ auto on_wm_initdialog( const HWND window, const HWND /*focus*/, const LPARAM /*e
 {
     // State:
     the_original_status_text = wu::text_of( GetDlgItem( window, IDC_STATUS_DISPLAY ) );
+    the_move_service.emplace(
+        [window]( const Move_service::Event& event ) { post_to( window, event ); },
+        the_computer_strategy
+        );
 
     // Window:
     wu::set_standard_gui_font( window );
@@ -171,6 +213,14 @@ auto CALLBACK message_handler(
         case WM_CLOSE:          result = HANDLE_WM( CLOSE, on_wm_close ); break;
         case WM_INITDIALOG:     result = HANDLE_WM( INITDIALOG, on_wm_initdialog ); break;
         case WM_LBUTTONDOWN:    result = HANDLE_WM( LBUTTONDOWN, on_wm_lbuttondown ); break;
+        case wm_computer_move: {
+            on_computer_move( window, uint64_t( w_param ), int( ell_param ) );
+            result = 0;  break;
+        }
+        case wm_search_progress: {
+            on_search_progress( window, uint64_t( w_param ), int64_t( ell_param ) );
+            result = 0;  break;
+        }
     }
     #undef HANDLE_WM
 
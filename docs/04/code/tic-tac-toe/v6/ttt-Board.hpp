@@ -0,0 +1,341 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int8_t, int16_t, uint16_t, uint32_t, uint64_t
+
+#include <array>
+#include <bitset>
+#include <optional>
+#include <type_traits>  // std::(conditional_t, is_integral_v)
+
+namespace ttt {
+    namespace cu = cpp::util;
+    using   std::array, std::bitset, std::optional,
+            std::conditional_t, std::is_integral_v;
+
+    namespace cell_state {
+        enum Enum{ empty, cross, circle };
+
+        constexpr auto opponent_of( const Enum state )
+            -> Enum
+        { return (state == cross? circle : cross); }
+    }  // namespace cell_state
+
+    namespace impl::board {
+        // The smallest unsigned integer type with at least `n` bits, or else a `bitset`.
+        template< int n >
+        using Bits_ =
+            conditional_t< n <= 16, uint16_t,
+            conditional_t< n <= 32, uint32_t,
+            conditional_t< n <= 64, uint64_t,
+            bitset<n>
+            > > >;
+
+        template< class Unsigned >
+        inline auto bit_count( const Unsigned bits ) -> int { return cu::bit_count( bits ); }
+
+        template< size_t n >
+        inline auto bit_count( const bitset<n>& bits ) -> int { return int( bits.count() ); }
+
+        template< class Unsigned >
+        inline auto lowest_bit_index( const Unsigned bits ) -> int { return cu::lowest_bit_index( bits ); }
+
+        template< size_t n >
+        inline auto lowest_bit_index( const bitset<n>& bits )
+            -> int
+        {
+            assert( bits.any() );
+            int i = 0;
+            while( not bits[i] ) { ++i; }
+            return i;
+        }
+    }  // namespace impl::board
+
+    // A `w`×`h` board where `k` in a row, horizontally, vertically or diagonally, wins.
+    template< int w, int h, int k >
+    struct Board_geometry_
+    {
+        static_assert( 0 < k and k <= w and k <= h );
+
+        enum{ width = w, height = h, run_length = k, n_cells = w*h, max_index = n_cells - 1 };
+
+        // x is left to right, y is bottom to top, zero-based, i = width*y + x.
+        struct Line{ int start; int stride; };  // `start` is the index of the lowest cell.
+
+        struct Direction{ int dx; int dy; };
+
+        // Horizontal, vertical, diagonal and anti-diagonal, each going upwards (or right).
+        static constexpr Direction directions[] = { {1, 0}, {0, 1}, {1, 1}, {-1, 1} };
+
+        enum{ n_lines = h*(w - k + 1) + w*(h - k + 1) + 2*(w - k + 1)*(h - k + 1) };
+
+        static constexpr auto stride_of( const Direction& d ) -> int { return d.dx + width*d.dy; }
+
+        static constexpr auto has_line_start_at( const Direction& d, const int x, const int y )
+            -> bool
+        {
+            const int last_x = x + (k - 1)*d.dx;
+            return 0 <= last_x and last_x < width and y + (k - 1)*d.dy < height;
+        }
+
+        static constexpr auto make_lines()
+            -> array<Line, n_lines>
+        {
+            array<Line, n_lines> result = {};
+            int n = 0;
+            for( const Direction& d: directions ) {
+                for( int i = 0; i < n_cells; ++i ) {
+                    if( has_line_start_at( d, i % width, i / width ) ) {
+                        result[n++] = {i, stride_of( d )};
+                    }
+                }
+            }
+            return result;
+        }
+
+        // The indices of the up to 4k lines through each cell, in `make_lines` order.
+        struct Cell_lines{ int n; array<int16_t, 4*k> line_indices; };
+
+        static constexpr auto make_cell_lines()
+            -> array<Cell_lines, n_cells>
+        {
+            constexpr array<Line, n_lines> lines = make_lines();
+            array<Cell_lines, n_cells> result = {};
+            for( int i = 0; i < n_lines; ++i ) {
+                for( int offset = 0; offset < k*lines[i].stride; offset += lines[i].stride ) {
+                    Cell_lines& cell = result[lines[i].start + offset];
+                    cell.line_indices[cell.n++] = int16_t( i );
+                }
+            }
+            return result;
+        }
+
+        // Bitboard: bit i of a `Bits` value corresponds to cell i.
+        using Bits = impl::board::Bits_<n_cells>;
+        static constexpr bool bits_are_integral = is_integral_v<Bits>;
+
+        // With few enough cells every set of one player’s cells is mapped to the index of a
+        // line it contains, or -1 if none, so that a win check is a single table load.
+        static constexpr bool has_win_table = (n_cells <= 12);
+        enum{ n_bit_patterns = (has_win_table? 1 << n_cells : 1) };
+
+        static constexpr auto bit( const int i )
+            -> Bits
+        {
+            if constexpr( bits_are_integral ) {
+                return Bits( Bits( 1 ) << i );
+            } else {
+                return Bits().set( size_t( i ) );
+            }
+        }
+
+        static constexpr auto make_all_cells()
+            -> Bits
+        {
+            if constexpr( bits_are_integral ) {
+                return Bits( Bits( ~Bits() ) >> (8*sizeof( Bits ) - n_cells) );
+            } else {
+                return Bits().set();
+            }
+        }
+
+        static constexpr auto bits_of( const Line& line )
+            -> Bits
+        {
+            Bits result = {};
+            for( int offset = 0; offset < k*line.stride; offset += line.stride ) {
+                result |= bit( line.start + offset );
+            }
+            return result;
+        }
+
+        static constexpr auto make_win_line_indices()
+            -> array<int8_t, n_bit_patterns>
+        {
+            array<int8_t, n_bit_patterns> result = {};
+            if constexpr( has_win_table ) {
+                constexpr array<Line, n_lines> lines = make_lines();
+                for( int pattern = 0; pattern < n_bit_patterns; ++pattern ) {
+                    result[pattern] = -1;
+                    for( int i = 0; i < n_lines; ++i ) {
+                        const Bits line_bits = bits_of( lines[i] );
+                        if( (pattern & line_bits) == line_bits ) {
+                            result[pattern] = int8_t( i );
+                            break;
+                        }
+                    }
+                }
+            }
+            return result;
+        }
+
+        // Zobrist hashing: a position’s hash is the xor of a pseudo-random key per occupied
+        // cell and player, so that it can be updated by one xor per move or undo.
+        using Zobrist_keys = array<array<uint64_t, n_cells>, 2>;
+
+        static constexpr auto make_zobrist_keys()
+            -> Zobrist_keys
+        {
+            Zobrist_keys result = {};
+            cu::Splitmix64 bits( 0x7474745F5A6F6272u + n_cells );
+            for( auto& player_keys: result ) {
+                for( uint64_t& key: player_keys ) { key = bits.next(); }
+            }
+            return result;
+        }
+
+        // For shift-and-AND run detection: the cells where a line in direction d can start.
+        static auto make_line_start_bits()
+            -> array<Bits, 4>
+        {
+            array<Bits, 4> result = {};
+            for( int d = 0; d < 4; ++d ) {
+                for( int i = 0; i < n_cells; ++i ) {
+                    if( has_line_start_at( directions[d], i % width, i / width ) ) {
+                        result[d] |= bit( i );
+                    }
+                }
+            }
+            return result;
+        }
+    };
+
+    template< int w, int h, int k >
+    struct Board_: Board_geometry_<w, h, k>
+    {
+        using Geometry = Board_geometry_<w, h, k>;
+        using typename Geometry::Line, typename Geometry::Cell_lines, typename Geometry::Bits,
+            typename Geometry::Zobrist_keys;
+        using Geometry::width, Geometry::height, Geometry::run_length, Geometry::n_cells,
+            Geometry::n_lines, Geometry::n_bit_patterns, Geometry::has_win_table,
+            Geometry::directions, Geometry::stride_of, Geometry::bit, Geometry::bits_of;
+
+        static constexpr array<Line, n_lines> lines = Geometry::make_lines();
+        static constexpr array<int8_t, n_bit_patterns> win_line_indices =
+            Geometry::make_win_line_indices();
+        static constexpr array<Cell_lines, n_cells> cell_lines = Geometry::make_cell_lines();
+        static constexpr Zobrist_keys zobrist_keys = Geometry::make_zobrist_keys();
+
+        static inline const array<Bits, 4> line_start_bits = Geometry::make_line_start_bits();
+        static inline const Bits all_cells = Geometry::make_all_cells();
+
+        // A first line contained in `bits`, found by a table load for small boards, and by
+        // bitwise run detection in each of the 4 directions for larger boards.
+        static auto first_line_in( const Bits& bits )
+            -> optional<Line>
+        {
+            if constexpr( has_win_table ) {
+                const int i = win_line_indices[bits];
+                if( i < 0 ) { return {}; }
+                return lines[i];
+            } else {
+                for( int d = 0; d < 4; ++d ) {
+                    const int stride = stride_of( directions[d] );
+                    Bits runs = bits & line_start_bits[d];
+                    for( int j = 1; j < run_length and runs != Bits(); ++j ) {
+                        runs &= (bits >> j*stride);
+                    }
+                    if( runs != Bits() ) {
+                        return Line{ impl::board::lowest_bit_index( runs ), stride };
+                    }
+                }
+                return {};
+            }
+        }
+
+        static auto is_win( const Bits& bits ) -> bool { return first_line_in( bits ).has_value(); }
+
+        array<cell_state::Enum, n_cells>    cells           = {};
+        array<Bits, 2>                      player_bits     = {};  // For cross and circle.
+        uint64_t                            hash            = 0;   // Zobrist hash.
+
+        // Own cells per line for cross and circle, maintained only without a win table: a
+        // table load is cheaper than updating the counts for a small board.
+        enum{ n_counted_lines = (has_win_table? 0 : n_lines) };
+        array<array<int8_t, n_counted_lines>, 2>    line_counts = {};
+
+        auto bits_of( const cell_state::Enum state ) const
+            -> Bits
+        {
+            assert( state != cell_state::empty );
+            return player_bits[state - 1];
+        }
+
+        auto occupied_cells() const -> Bits { return Bits( player_bits[0] | player_bits[1] ); }
+        auto free_cells() const -> Bits { return Bits( all_cells & ~occupied_cells() ); }
+
+        void set( const int i, const cell_state::Enum state )
+        {
+            assert( cells[i] == cell_state::empty and state != cell_state::empty );
+            cells[i] = state;
+            player_bits[state - 1] |= bit( i );
+            hash ^= zobrist_keys[state - 1][i];
+            if constexpr( not has_win_table ) {
+                const Cell_lines& through = cell_lines[i];
+                array<int8_t, n_counted_lines>& counts = line_counts[state - 1];
+                for( int j = 0; j < through.n; ++j ) { ++counts[through.line_indices[j]]; }
+            }
+        }
+
+        // Reverses `set`, i.e. makes the occupied cell i empty.
+        void unset( const int i )
+        {
+            const cell_state::Enum state = cells[i];
+            assert( state != cell_state::empty );
+            cells[i] = cell_state::empty;
+            player_bits[state - 1] &= Bits( ~bit( i ) );
+            hash ^= zobrist_keys[state - 1][i];
+            if constexpr( not has_win_table ) {
+                const Cell_lines& through = cell_lines[i];
+                array<int8_t, n_counted_lines>& counts = line_counts[state - 1];
+                for( int j = 0; j < through.n; ++j ) { --counts[through.line_indices[j]]; }
+            }
+        }
+
+        auto win_line_with( const cell_state::Enum state ) const
+            -> optional<Line>
+        { return first_line_in( bits_of( state ) ); }
+
+        // A line through cell i of cells with `state`, supposing cell i has `state`. For a
+        // small board that’s a table load, and otherwise a check of the counts of the up to 4k
+        // lines through cell i, i.e. it’s O(k) regardless of board size. Neither needs a
+        // modified copy of the board.
+        auto win_line_through( const int i, const cell_state::Enum state ) const
+            -> optional<Line>
+        {
+            if constexpr( has_win_table ) {
+                return first_line_in( Bits( bits_of( state ) | bit( i ) ) );
+            } else {
+                const int n_needed = run_length - (cells[i] != state);
+                const Cell_lines& through = cell_lines[i];
+                const array<int8_t, n_counted_lines>& counts = line_counts[state - 1];
+                for( int j = 0; j < through.n; ++j ) {
+                    const int line_index = through.line_indices[j];
+                    if( counts[line_index] == n_needed ) { return lines[line_index]; }
+                }
+                return {};
+            }
+        }
+
+        // The n’th free cell in index order, zero-based.
+        auto nth_free_cell( int n ) const
+            -> int
+        {
+            if constexpr( Geometry::bits_are_integral ) {
+                Bits bits = free_cells();
+                for( ; n > 0; --n ) { bits &= bits - 1; }
+                return impl::board::lowest_bit_index( bits );
+            } else {
+                for( int i = 0; ; ++i ) {
+                    if( cells[i] == cell_state::empty ) {
+                        if( n == 0 ) { return i; }
+                        --n;
+                    }
+                }
+            }
+        }
+    };
+
+    using Board = Board_<3, 3, 3>;
+}  // namespace ttt
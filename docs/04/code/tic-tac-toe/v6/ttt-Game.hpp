@@ -1,53 +1,56 @@
 ﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board, cell_state)
+#include "ttt-Mcts.hpp"             // ttt::Mcts_
+#include "ttt-Solver.hpp"           // ttt::Solver
+#include "ttt-Tablebase.hpp"        // ttt::(Tablebase_, tablebase_is_possible_for)
+#include "ttt-Timed_search.hpp"     // ttt::(Timed_search_, difficulty, budget_for)
+#include <cpp/instrumentation.hpp>  // CPPUTIL_TIMED_SCOPE
 #include <cpp/util.hpp>
 
+// The compile time `Move_table` behind `strategy::table` is costly to compile, and with MSVC
+// it needs a higher constexpr evaluation limit, so it’s only included on request.
+#ifdef TTT_WITH_MOVE_TABLE
+#   include "ttt-Move_table.hpp"    // ttt::Move_table
+#endif
+
+#include <assert.h>
+#include <stdint.h>     // int16_t
+
 #include <array>
 #include <initializer_list>
 #include <optional>
+#include <type_traits>      // std::is_same_v
 
 namespace ttt {
     namespace cu = cpp::util;
-    using   std::array, std::optional;
-
-    namespace cell_state {
-        enum Enum{ empty, cross, circle };
-    }  // namespace cell_state
-
-    struct Board
-    {
-        enum{ size = 3, n_cells = cu::squared( size ), max_index = n_cells - 1 };
+    using   std::array,
+            std::optional,
+            std::is_same_v;
 
-        // x is left to right, y is bottom to top, zero-based, i = 3*y + x.
-        struct Line{ int start; int stride; };  // `start` in left col or bottom row.
-        static constexpr Line lines[] =
-        {
-            {0, 1}, {3, 1}, {6, 1}, {0, 3}, {1, 3}, {2, 3}, {0, 4}, {2, 2}
-        };
-
-        array<cell_state::Enum, n_cells>    cells   = {};
-        
-        auto win_line_with( const cell_state::Enum state ) const
-            -> optional<Line>
-        {
-            for( const Line& line: lines ) {
-                int count = 0;
-                for( int offset = 0; offset < size*line.stride; offset += line.stride ) {
-                    count += (cells[line.start + offset] == state);
-                }
-                if( count == size ) { return line; }
-            }
-            return {};
-        }
-    };
+    namespace strategy {
+        // One-ply lookahead with random play; perfect play by search or by table lookup
+        // (3×3 only, the table with `TTT_WITH_MOVE_TABLE` defined); Monte Carlo tree search,
+        // for any board size; perfect play by a loaded tablebase (boards of up to 4×4); or
+        // time-budgeted alpha-beta search per difficulty level, for any board size.
+        enum Enum{ heuristic, perfect, table, mcts, tablebase, timed };
+    }  // namespace strategy
 
-    struct Game
+    template< class Board_type >
+    struct Game_
     {
-        using Opt_line = optional<Board::Line>;
+        using Board     = Board_type;
+        using Opt_line  = optional<typename Board::Line>;
 
         Board       board       = {};
         int         n_moves     = 0;
         Opt_line    win_line    = {};
 
+        // The moves made, as an inline stack so that making and unmaking moves doesn’t
+        // allocate. Entries from `n_moves` up to `n_recorded_moves` are undone moves that
+        // can be redone.
+        array<int16_t, Board::n_cells>  moves               = {};
+        int                             n_recorded_moves    = 0;
+
         void store_any_win_line_with( const cell_state::Enum state )
         {
             if( const Opt_line new_win_line = board.win_line_with( state ) ) {
@@ -56,49 +59,107 @@ namespace ttt {
         }
         
         auto is_over() const -> bool { return n_moves == Board::n_cells or win_line; }
-        
+
+        auto player_to_move() const
+            -> cell_state::Enum
+        { return (n_moves % 2 == 0? cell_state::cross : cell_state::circle); }
+
         void make_move( const int cell_index )
         {
             assert( not is_over() );
             assert( board.cells[cell_index] == cell_state::empty );
 
-            const auto new_state = (n_moves % 2 == 0? cell_state::cross : cell_state::circle);
-            board.cells[cell_index] = new_state;
-            store_any_win_line_with( new_state );
+            const auto new_state = player_to_move();
+            board.set( cell_index, new_state );
+            if( const Opt_line new_win_line = board.win_line_through( cell_index, new_state ) ) {
+                win_line = new_win_line;
+            }
+            moves[n_moves] = int16_t( cell_index );
             ++n_moves;
+            n_recorded_moves = n_moves;
         }
 
-        auto find_computer_move() const
-            -> int
+        // Takes back the last move. Play continued after every earlier position, so none of
+        // them had a win line.
+        void unmake_move()
         {
+            assert( n_moves > 0 );
+            --n_moves;
+            board.unset( moves[n_moves] );
+            win_line = {};
+        }
+
+        auto can_redo_move() const -> bool { return n_moves < n_recorded_moves; }
+
+        void redo_move()
+        {
+            assert( can_redo_move() );
+            const int n_recorded = n_recorded_moves;
+            make_move( moves[n_moves] );
+            n_recorded_moves = n_recorded;
+        }
+
+        // `level` only applies to `strategy::timed`. `strategy::mcts` searches in the calling
+        // thread only, with `Mcts_::per_thread_options()`.
+        auto find_computer_move(
+            const strategy::Enum    choice  = strategy::heuristic,
+            const difficulty::Enum  level   = difficulty::medium
+            ) const -> int
+        {
+            CPPUTIL_TIMED_SCOPE( "ttt::Game_::find_computer_move" );
             assert( not is_over() );
-            for( const auto state_to_check: {cell_state::circle, cell_state::cross} ) {
-                // If state is cell_state::circle: Choose a direct computer win if possible.
-                // Else state is cell_state::cross:  Block the user’s win if any.
-                for( int i = 0; i < Board::n_cells; ++i ) {
-                    if( board.cells[i] == cell_state::empty ) {
-                        Board a_copy = board;
-                        a_copy.cells[i] = state_to_check;
-                        if( a_copy.win_line_with( state_to_check ) ) {
-                            return i;
-                        }
+            if( choice == strategy::timed ) {
+                return Timed_search_<Game_>::for_this_thread().best_move_for( *this, budget_for( level ) ).move;
+            } else if( choice == strategy::mcts ) {
+                return Mcts_<Game_>::for_this_thread().best_move_for( *this );
+            } else if( choice == strategy::tablebase ) {
+                if constexpr( tablebase_is_possible_for<Board> ) {
+                    const Tablebase_<Board>* const p_tablebase = Tablebase_<Board>::loaded();
+                    cu::hopefully( p_tablebase != nullptr ) or CPPUTIL_FAIL( "No tablebase is loaded." );
+                    return p_tablebase->best_move_for( board, player_to_move() ).move;
+                }
+                CPPUTIL_FAIL( "The tablebase strategy is only supported for boards up to 4×4." );
+            } else if( choice != strategy::heuristic ) {
+                if constexpr( is_same_v<Board, ttt::Board> ) {
+                    if( choice == strategy::perfect ) {
+                        const auto player = player_to_move();
+                        return Solver::for_this_thread().best_move_for( board, player ).move;
+                    } else if( choice == strategy::table ) {
+                        #ifdef TTT_WITH_MOVE_TABLE
+                            return Move_table::entry_for( board ).move;
+                        #else
+                            CPPUTIL_FAIL( "The table strategy needs TTT_WITH_MOVE_TABLE defined." );
+                        #endif
                     }
                 }
+                CPPUTIL_FAIL( "The strategy is only supported for the 3×3 board." );
             }
-            
-            // Else choose a move at random.
-            const int n_possibles = Board::n_cells - n_moves;
-            const int which_free_cell = cu::random_in( {1, n_possibles} );
-            int count = 0;
-            for( int i = 0; i < Board::n_cells; ++i ) {
-                if( board.cells[i] == cell_state::empty ) {
-                    ++count;
-                    if( count == which_free_cell ) {
-                        return i;
+
+            const auto player = player_to_move();
+            for( const auto state_to_check: {player, cell_state::opponent_of( player )} ) {
+                // If state is the player’s: Choose a direct win if possible.
+                // Else state is the opponent’s: Block the opponent’s win if any.
+                if constexpr( Board::bits_are_integral ) {
+                    for( auto bits = board.free_cells(); bits != 0; bits &= bits - 1 ) {
+                        const int i = cu::lowest_bit_index( bits );
+                        if( board.win_line_through( i, state_to_check ) ) {
+                            return i;
+                        }
+                    }
+                } else {
+                    for( int i = 0; i < Board::n_cells; ++i ) {
+                        if( board.cells[i] == cell_state::empty
+                            and board.win_line_through( i, state_to_check ) ) {
+                            return i;
+                        }
                     }
                 }
             }
-            for( ;; );  // Should never get here.
+
+            // Else choose a move at random.
+            return board.nth_free_cell( cu::random_up_to( Board::n_cells - n_moves ) );
         }
     };
+
+    using Game = Game_<Board>;
 }  // namespace ttt
@@ -0,0 +1,300 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Game.hpp"             // ttt::(Game_, cell_state, strategy)
+#include "ttt-Mapped_file.hpp"      // ttt::Mapped_file
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int64_t, uint8_t, uint16_t, uint64_t
+#include <stdio.h>      // fopen, fread, fwrite, fclose, ...
+#include <string.h>     // memcmp, memcpy
+
+#include <string>
+#include <vector>
+
+// A compact archive format for finished (or abandoned) games.
+//
+// A file is a 16 byte header followed by records back to back:
+//
+//      header:     "tttR", version, width, height, run length, bits per move,
+//                  x strategy, o strategy, 5 reserved zero bytes.
+//      record:     record header, then the moves packed at `bits per move` each.
+//
+// With at most 16 cells a move is 4 bits, the low nibble first, and the record header is one
+// byte; otherwise a move is 8 or 16 bits and the record header is 2 bytes, little-endian.
+// The record header holds the number of moves, plus in its most significant bit whether the
+// last move won. So a 3×3 game of 7 moves takes 5 bytes.
+//
+// A writer appends whole records, and a reader maps the file into memory and iterates over
+// the records in place, without copying or allocation per record.
+namespace ttt::game_records {
+    namespace cu = cpp::util;
+    using   std::string,
+            std::vector;
+
+    enum{ header_size = 16, version = 1 };
+
+    struct Header
+    {
+        int                 width;
+        int                 height;
+        int                 run_length;
+        int                 bits_per_move;
+        strategy::Enum      x_strategy;
+        strategy::Enum      o_strategy;
+    };
+
+    constexpr auto bits_per_move_for( const int n_cells )
+        -> int
+    { return (n_cells <= 16? 4 : n_cells <= 256? 8 : 16); }
+
+    constexpr auto move_bytes_for( const int bits_per_move, const int n_moves )
+        -> int
+    { return (bits_per_move*n_moves + 7)/8; }
+
+    inline auto bytes_of( const Header& header )
+        -> vector<uint8_t>
+    {
+        vector<uint8_t> result( header_size );
+        memcpy( result.data(), "tttR", 4 );
+        result[4] = version;
+        result[5] = uint8_t( header.width );
+        result[6] = uint8_t( header.height );
+        result[7] = uint8_t( header.run_length );
+        result[8] = uint8_t( header.bits_per_move );
+        result[9] = uint8_t( header.x_strategy );
+        result[10] = uint8_t( header.o_strategy );
+        return result;
+    }
+
+    inline auto header_from( const uint8_t* const bytes, const int64_t n_bytes )
+        -> Header
+    {
+        cu::hopefully( n_bytes >= header_size and memcmp( bytes, "tttR", 4 ) == 0 )
+            or CPPUTIL_FAIL( "Not a game records file." );
+        cu::hopefully( bytes[4] == version )
+            or CPPUTIL_FAIL( "Unsupported game records version " + std::to_string( bytes[4] ) + "." );
+        const Header result =
+        {
+            bytes[5], bytes[6], bytes[7], bytes[8],
+            strategy::Enum( bytes[9] ), strategy::Enum( bytes[10] )
+        };
+        cu::hopefully( result.bits_per_move == bits_per_move_for( result.width*result.height ) )
+            or CPPUTIL_FAIL( "Inconsistent game records header." );
+        return result;
+    }
+
+    // Encodes a game as a record, appended to `bytes`.
+    template< class Game >
+    void append_record( const Game& game, vector<uint8_t>& bytes )
+    {
+        using Board = typename Game::Board;
+        constexpr int bits_per_move = bits_per_move_for( Board::n_cells );
+
+        const int n_moves = game.n_moves;
+        const unsigned record_header = unsigned( n_moves ) | (game.win_line? 0x8000u : 0u);
+        if constexpr( bits_per_move == 4 ) {
+            bytes.push_back( uint8_t( record_header >> 8 | (record_header & 0x7F) ) );
+            for( int i = 0; i < n_moves; i += 2 ) {
+                const int high = (i + 1 < n_moves? game.moves[i + 1] : 0);
+                bytes.push_back( uint8_t( game.moves[i] | high << 4 ) );
+            }
+        } else {
+            bytes.push_back( uint8_t( record_header ) );
+            bytes.push_back( uint8_t( record_header >> 8 ) );
+            for( int i = 0; i < n_moves; ++i ) {
+                bytes.push_back( uint8_t( game.moves[i] ) );
+                if constexpr( bits_per_move == 16 ) {
+                    bytes.push_back( uint8_t( game.moves[i] >> 8 ) );
+                }
+            }
+        }
+    }
+
+    // A record in place in a reader’s memory.
+    struct Record_ref
+    {
+        const uint8_t*  moves_data;
+        int             n_moves;
+        bool            ends_with_win;
+        int             bits_per_move;
+
+        auto move( const int i ) const
+            -> int
+        {
+            assert( 0 <= i and i < n_moves );
+            switch( bits_per_move ) {
+                case 4:     return (moves_data[i/2] >> 4*(i % 2)) & 0xF;
+                case 8:     return moves_data[i];
+                default:    return moves_data[2*i] | moves_data[2*i + 1] << 8;
+            }
+        }
+
+        // Checks each move, so that a corrupt record fails instead of corrupting `game`.
+        template< class Game >
+        void replay_into( Game& game ) const
+        {
+            using Board = typename Game::Board;
+            game = {};
+            cu::hopefully( n_moves <= Board::n_cells ) or CPPUTIL_FAIL( "Corrupt game record." );
+            for( int i = 0; i < n_moves; ++i ) {
+                const int cell_index = move( i );
+                cu::hopefully( cell_index < Board::n_cells and not game.is_over()
+                    and game.board.cells[cell_index] == cell_state::empty
+                    ) or CPPUTIL_FAIL( "Corrupt game record." );
+                game.make_move( cell_index );
+            }
+        }
+    };
+
+    // Appends records to a file, creating it with a header if it doesn’t exist or is empty.
+    // An existing file must have the same header. Records are buffered by the C library.
+    template< class Game >
+    class Writer_:
+        public cu::No_copying
+    {
+        using Board = typename Game::Board;
+
+        FILE*               m_file;
+        vector<uint8_t>     m_bytes;
+        int64_t             m_n_records     = 0;
+
+    public:
+        Writer_(
+            const string&           path,
+            const strategy::Enum    x_strategy  = strategy::heuristic,
+            const strategy::Enum    o_strategy  = strategy::heuristic
+            ):
+            m_file( fopen( path.c_str(), "a+b" ) )
+        {
+            cu::hopefully( m_file != nullptr ) or CPPUTIL_FAIL( "Can’t open “" + path + "”." );
+            const Header header =
+            {
+                Board::width, Board::height, Board::run_length,
+                bits_per_move_for( Board::n_cells ), x_strategy, o_strategy
+            };
+            const vector<uint8_t> header_bytes = bytes_of( header );
+            uint8_t existing[header_size];
+            fseek( m_file, 0, SEEK_SET );
+            const size_t n_existing = fread( existing, 1, header_size, m_file );
+            if( n_existing == 0 ) {
+                fseek( m_file, 0, SEEK_END );
+                fwrite( header_bytes.data(), 1, header_size, m_file );
+            } else if( n_existing < header_size
+                or memcmp( existing, header_bytes.data(), header_size ) != 0 ) {
+                fclose( m_file );
+                CPPUTIL_FAIL( "“" + path + "” has records of another kind." );
+            }
+            fseek( m_file, 0, SEEK_END );
+        }
+
+        ~Writer_() { fclose( m_file ); }
+
+        auto n_records() const -> int64_t { return m_n_records; }
+
+        void add( const Game& game )
+        {
+            m_bytes.clear();
+            append_record( game, m_bytes );
+            add_encoded( m_bytes.data(), m_bytes.size(), 1 );
+        }
+
+        // Records already encoded with `append_record`, e.g. by worker threads.
+        void add_encoded( const uint8_t* const bytes, const size_t n_bytes, const int64_t n_records )
+        {
+            const size_t n_written = fwrite( bytes, 1, n_bytes, m_file );
+            cu::hopefully( n_written == n_bytes ) or CPPUTIL_FAIL( "Writing game records failed." );
+            m_n_records += n_records;
+        }
+
+        void flush() { fflush( m_file ); }
+    };
+
+    // Maps a records file into memory, read-only, and iterates over its records in place.
+    class Reader:
+        public cu::No_copying
+    {
+        Mapped_file         m_file;
+        Header              m_header;
+
+    public:
+        class Iterator
+        {
+            const uint8_t*  m_p;
+            const uint8_t*  m_beyond;
+            int             m_n_cells;
+            Record_ref      m_record;
+
+            // Fails unless the whole record, header and moves, is before `m_beyond`, so that a
+            // `Record_ref` never refers beyond the end of the file, and unless it has at most
+            // one move per cell. The moves themselves are checked by `Record_ref::replay_into`.
+            void decode_header()
+            {
+                if( m_p == m_beyond ) { return; }
+                const int64_t n_available = m_beyond - m_p;
+                const int record_header_size = (m_record.bits_per_move == 4? 1 : 2);
+                cu::hopefully( n_available >= record_header_size ) or CPPUTIL_FAIL( "Truncated game record." );
+                if( m_record.bits_per_move == 4 ) {
+                    m_record.n_moves        = m_p[0] & 0x7F;
+                    m_record.ends_with_win  = (m_p[0] & 0x80) != 0;
+                } else {
+                    const unsigned record_header = m_p[0] | m_p[1] << 8;
+                    m_record.n_moves        = int( record_header & 0x7FFF );
+                    m_record.ends_with_win  = (record_header & 0x8000) != 0;
+                }
+                cu::hopefully( m_record.n_moves <= m_n_cells ) or CPPUTIL_FAIL( "Corrupt game record." );
+                m_record.moves_data = m_p + record_header_size;
+                const int n_move_bytes = move_bytes_for( m_record.bits_per_move, m_record.n_moves );
+                cu::hopefully( n_available - record_header_size >= n_move_bytes )
+                    or CPPUTIL_FAIL( "Truncated game record." );
+            }
+
+        public:
+            Iterator( const uint8_t* p, const uint8_t* beyond, const int bits_per_move, const int n_cells ):
+                m_p( p ), m_beyond( beyond ), m_n_cells( n_cells ), m_record{ p, 0, false, bits_per_move }
+            { decode_header(); }
+
+            auto operator*() const -> const Record_ref& { return m_record; }
+
+            auto operator++()
+                -> Iterator&
+            {
+                m_p = m_record.moves_data + move_bytes_for( m_record.bits_per_move, m_record.n_moves );
+                decode_header();
+                return *this;
+            }
+
+            auto operator!=( const Iterator& other ) const -> bool { return m_p != other.m_p; }
+        };
+
+        Reader( const string& path ):
+            m_file( path, Mapped_file::sequential ),
+            m_header( header_from( m_file.data(), m_file.n_bytes() ) )
+        {}
+
+        auto header() const -> const Header& { return m_header; }
+        auto n_cells() const -> int { return m_header.width*m_header.height; }
+        auto n_bytes() const -> int64_t { return m_file.n_bytes(); }
+
+        auto begin() const
+            -> Iterator
+        {
+            const uint8_t* const beyond = m_file.data() + m_file.n_bytes();
+            return {m_file.data() + header_size, beyond, m_header.bits_per_move, n_cells()};
+        }
+
+        auto end() const
+            -> Iterator
+        {
+            const uint8_t* const beyond = m_file.data() + m_file.n_bytes();
+            return {beyond, beyond, m_header.bits_per_move, n_cells()};
+        }
+    };
+
+    template< class Board >
+    auto has_geometry_of( const Header& header )
+        -> bool
+    {
+        return header.width == Board::width and header.height == Board::height
+            and header.run_length == Board::run_length;
+    }
+}  // namespace ttt::game_records
@@ -0,0 +1,76 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t, uint8_t
+#include <stdio.h>      // fopen, fread, fclose
+
+#ifndef _WIN32
+#   include <fcntl.h>       // open
+#   include <sys/mman.h>    // mmap, munmap, madvise
+#   include <sys/stat.h>    // fstat
+#   include <unistd.h>      // close
+#endif
+
+#include <string>
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    using   std::string,
+            std::vector;
+
+    // The contents of a file, read-only. With POSIX the file is memory-mapped, so that pages
+    // are loaded on demand and shared between processes; elsewhere it’s read in full, since
+    // mapping in Windows would need <windows.h>.
+    class Mapped_file:
+        public cu::No_copying
+    {
+        const uint8_t*      m_data          = nullptr;
+        int64_t             m_n_bytes       = 0;
+        #ifdef _WIN32
+            vector<uint8_t> m_contents;
+        #endif
+
+    public:
+        enum Access{ sequential, random };
+
+        Mapped_file( const string& path, const Access access = sequential )
+        {
+            #ifdef _WIN32
+                (void) access;
+                FILE* const f = fopen( path.c_str(), "rb" );
+                cu::hopefully( f != nullptr ) or CPPUTIL_FAIL( "Can’t open “" + path + "”." );
+                uint8_t buffer[1 << 16];
+                for( size_t n; (n = fread( buffer, 1, sizeof( buffer ), f )) > 0; ) {
+                    m_contents.insert( m_contents.end(), buffer, buffer + n );
+                }
+                fclose( f );
+                m_data = m_contents.data();
+                m_n_bytes = int64_t( m_contents.size() );
+            #else
+                const int fd = open( path.c_str(), O_RDONLY );
+                cu::hopefully( fd >= 0 ) or CPPUTIL_FAIL( "Can’t open “" + path + "”." );
+                struct stat info;
+                const bool got_size = (fstat( fd, &info ) == 0);
+                m_n_bytes = (got_size? int64_t( info.st_size ) : 0);
+                void* const p = (m_n_bytes > 0
+                    ? mmap( nullptr, size_t( m_n_bytes ), PROT_READ, MAP_PRIVATE, fd, 0 )
+                    : MAP_FAILED);
+                close( fd );
+                cu::hopefully( p != MAP_FAILED ) or CPPUTIL_FAIL( "Can’t map “" + path + "”." );
+                madvise( p, size_t( m_n_bytes ), (access == sequential? MADV_SEQUENTIAL : MADV_RANDOM) );
+                m_data = static_cast<const uint8_t*>( p );
+            #endif
+        }
+
+        ~Mapped_file()
+        {
+            #ifndef _WIN32
+                munmap( const_cast<uint8_t*>( m_data ), size_t( m_n_bytes ) );
+            #endif
+        }
+
+        auto data() const -> const uint8_t* { return m_data; }
+        auto n_bytes() const -> int64_t { return m_n_bytes; }
+    };
+}  // namespace ttt
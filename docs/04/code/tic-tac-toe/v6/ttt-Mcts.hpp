@@ -0,0 +1,279 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::cell_state
+#include <cpp/instrumentation.hpp>  // CPPUTIL_TIMED_SCOPE
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <math.h>       // log, sqrt
+#include <stdint.h>     // int16_t, int32_t, int64_t, uint32_t
+
+#include <algorithm>    // std::(max, min)
+#include <atomic>
+#include <chrono>
+#include <functional>   // std::function
+#include <random>       // std::random_device
+#include <thread>
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    namespace chr = std::chrono;
+    using   std::max, std::min,
+            std::atomic, std::memory_order_acquire, std::memory_order_relaxed,
+            std::memory_order_release,
+            std::function,
+            std::random_device,
+            std::thread,
+            std::vector;
+
+    // Monte Carlo tree search with UCT selection and random playouts, for any board size.
+    //
+    // The threads share one tree (“tree parallelism”). Visit counts and scores are atomic
+    // and updated without locks, and a visit is counted before its playout is done (a
+    // “virtual loss”), which steers other threads to other parts of the tree meanwhile.
+    template< class Game >
+    class Mcts_
+    {
+    public:
+        struct Options
+        {
+            int         n_threads       = max( 1, int( thread::hardware_concurrency() ) );
+            int64_t     max_playouts    = 20'000;
+            double      max_seconds     = 0.25;
+            int         max_nodes       = 1 << 20;      // Expansion stops when all are used.
+            double      exploration     = 1.4;          // The UCT constant c.
+            unsigned    seed            = random_device()();
+
+            // Optional hooks, e.g. for a search in the background: `should_stop` is polled by
+            // every search thread, and `on_progress` is called by the calling thread with the
+            // number of playouts done so far, every `progress_interval` of its own playouts.
+            function<bool()>            should_stop;
+            function<void( int64_t )>   on_progress;
+            int64_t                     progress_interval   = 1'000;
+        };
+
+        struct Statistics
+        {
+            int64_t     n_playouts  = 0;
+            int         n_nodes     = 0;
+            double      seconds     = 0;
+        };
+
+    private:
+        using Board = typename Game::Board;
+
+        struct Node
+        {
+            enum{ unexpanded = -1, being_expanded = -2, not_expandable = -3 };
+
+            atomic<int32_t>     n_visits        {0};
+            atomic<int32_t>     n_half_points   {0};    // For the player who moved here.
+            atomic<int32_t>     first_child     {unexpanded};
+            int16_t             n_children      = 0;
+            int16_t             move            = -1;
+        };
+
+        Options             m_options;
+        vector<Node>        m_nodes;
+        atomic<int>         m_n_nodes               {0};
+        atomic<int64_t>     m_n_started_playouts    {0};
+        atomic<int64_t>     m_n_playouts            {0};
+        Statistics          m_stats;
+
+        auto select_child_of( const Node& parent ) const
+            -> int
+        {
+            const int first = parent.first_child.load( memory_order_acquire );
+            const int n_parent_visits = parent.n_visits.load( memory_order_relaxed );
+            const double log_parent_visits = log( max( 1, n_parent_visits ) );
+            int     best_index  = first;
+            double  best_value  = -1;
+            for( int i = first; i < first + parent.n_children; ++i ) {
+                const int n_visits = m_nodes[i].n_visits.load( memory_order_relaxed );
+                if( n_visits == 0 ) { return i; }
+                const int n_half_points = m_nodes[i].n_half_points.load( memory_order_relaxed );
+                const double mean = n_half_points/(2.0*n_visits);
+                const double exploration_term = sqrt( log_parent_visits/n_visits );
+                const double value = mean + m_options.exploration*exploration_term;
+                if( value > best_value ) { best_value = value; best_index = i; }
+            }
+            return best_index;
+        }
+
+        // Creates the children of node `i` unless another thread is already doing that.
+        void try_to_expand( const int i, const Game& game )
+        {
+            Node& node = m_nodes[i];
+            int32_t expected = Node::unexpanded;
+            if( not node.first_child.compare_exchange_strong( expected, Node::being_expanded ) ) {
+                return;
+            }
+            const int n_children = Board::n_cells - game.n_moves;
+            const int first = m_n_nodes.fetch_add( n_children );
+            if( first + n_children > int( m_nodes.size() ) ) {
+                node.first_child.store( Node::not_expandable, memory_order_release );
+                return;
+            }
+            int j = first;
+            for( int cell = 0; cell < Board::n_cells; ++cell ) {
+                if( game.board.cells[cell] == cell_state::empty ) {
+                    m_nodes[j++].move = int16_t( cell );
+                }
+            }
+            node.n_children = int16_t( n_children );
+            node.first_child.store( first, memory_order_release );
+        }
+
+        static void random_playout( Game& game, cu::Random_bits& bits )
+        {
+            int free_cells[Board::n_cells];
+            int n_free = 0;
+            for( int cell = 0; cell < Board::n_cells; ++cell ) {
+                if( game.board.cells[cell] == cell_state::empty ) { free_cells[n_free++] = cell; }
+            }
+            while( not game.is_over() ) {
+                const int i = int( bits.up_to( uint32_t( n_free ) ) );
+                game.make_move( free_cells[i] );
+                free_cells[i] = free_cells[--n_free];
+            }
+        }
+
+        // Half-points for the player who made the last move of a game sequence.
+        static auto half_points_for( const cell_state::Enum player, const Game& game )
+            -> int
+        {
+            if( not game.win_line ) { return 1; }
+            return (game.board.cells[game.win_line->start] == player? 2 : 0);
+        }
+
+        auto should_stop_at( const chr::steady_clock::time_point deadline ) const
+            -> bool
+        {
+            return chr::steady_clock::now() >= deadline
+                or (m_options.should_stop and m_options.should_stop());
+        }
+
+        void run_playouts(
+            const Game&                         root_game,
+            const unsigned                      seed,
+            const chr::steady_clock::time_point deadline,
+            const bool                          reports_progress
+            )
+        {
+            cu::Random_bits bits( seed );
+            vector<int> path;
+            for( int64_t n = 0; ; ++n ) {
+                const int64_t n_started = m_n_started_playouts.fetch_add( 1, memory_order_relaxed );
+                if( n_started >= m_options.max_playouts ) { break; }
+                if( n % 64 == 0 and should_stop_at( deadline ) ) { break; }
+                if( reports_progress and n > 0 and n % m_options.progress_interval == 0 ) {
+                    m_options.on_progress( m_n_playouts.load( memory_order_relaxed ) );
+                }
+
+                // Selection, counting the visits up front.
+                Game game = root_game;
+                path.clear();
+                int i = 0;
+                path.push_back( i );
+                m_nodes[i].n_visits.fetch_add( 1, memory_order_relaxed );
+                while( not game.is_over() ) {
+                    if( m_nodes[i].first_child.load( memory_order_acquire ) < 0 ) {
+                        if( m_nodes[i].n_visits.load( memory_order_relaxed ) <= 1 ) { break; }
+                        try_to_expand( i, game );
+                        if( m_nodes[i].first_child.load( memory_order_acquire ) < 0 ) { break; }
+                    }
+                    i = select_child_of( m_nodes[i] );
+                    game.make_move( m_nodes[i].move );
+                    path.push_back( i );
+                    m_nodes[i].n_visits.fetch_add( 1, memory_order_relaxed );
+                }
+
+                // Simulation and backpropagation.
+                random_playout( game, bits );
+                cell_state::Enum mover = cell_state::opponent_of( root_game.player_to_move() );
+                for( const int node_index: path ) {
+                    m_nodes[node_index].n_half_points.fetch_add(
+                        half_points_for( mover, game ), memory_order_relaxed
+                        );
+                    mover = cell_state::opponent_of( mover );
+                }
+                m_n_playouts.fetch_add( 1, memory_order_relaxed );
+            }
+        }
+
+    public:
+        Mcts_( const Options& options = {} ):
+            m_options( options ),
+            m_nodes( size_t( max( 1, options.max_nodes ) ) )
+        {}
+
+        auto options() const -> const Options& { return m_options; }
+        auto stats() const -> const Statistics& { return m_stats; }
+
+        // The most visited move at the root after the budget is spent. Not thread-safe in
+        // itself, i.e. use one `Mcts_` instance per concurrent search.
+        auto best_move_for( const Game& game )
+            -> int
+        {
+            CPPUTIL_TIMED_SCOPE( "ttt::Mcts_::best_move_for" );
+            assert( not game.is_over() );
+            for( int i = 0, n = m_n_nodes.load(); i < n and i < int( m_nodes.size() ); ++i ) {
+                Node& node = m_nodes[i];
+                node.n_visits = 0;  node.n_half_points = 0;  node.first_child = Node::unexpanded;
+                node.n_children = 0;  node.move = -1;
+            }
+            m_n_nodes = 1;
+            m_n_started_playouts = 0;
+            m_n_playouts = 0;
+
+            const auto start_time = chr::steady_clock::now();
+            const auto budget = chr::duration<double>( m_options.max_seconds );
+            const auto deadline =
+                start_time + chr::duration_cast<chr::steady_clock::duration>( budget );
+            {
+                vector<thread> workers;
+                for( int t = 1; t < m_options.n_threads; ++t ) {
+                    workers.emplace_back( [this, &game, t, deadline]{
+                        run_playouts( game, m_options.seed + t, deadline, false );
+                    } );
+                }
+                run_playouts( game, m_options.seed, deadline, bool( m_options.on_progress ) );
+                for( thread& worker: workers ) { worker.join(); }
+            }
+            const auto elapsed = chr::steady_clock::now() - start_time;
+            m_stats.seconds = chr::duration<double>( elapsed ).count();
+            m_stats.n_playouts = m_n_playouts.load();
+            m_stats.n_nodes = min( m_n_nodes.load(), int( m_nodes.size() ) );
+
+            const Node& root = m_nodes[0];
+            if( root.first_child.load() < 0 ) {
+                return game.board.nth_free_cell( 0 );      // Budget too small to expand the root.
+            }
+            int best_index = root.first_child;
+            for( int i = root.first_child; i < root.first_child + root.n_children; ++i ) {
+                if( m_nodes[i].n_visits > m_nodes[best_index].n_visits ) { best_index = i; }
+            }
+            return m_nodes[best_index].move;
+        }
+
+        // Options for the instance per thread: the search runs in the calling thread only, with
+        // 2¹⁸ nodes (4 MB), since `Game_::find_computer_move` may be called for every move and
+        // from many threads at once. For a parallel search use an `Mcts_` with other options.
+        static auto per_thread_options()
+            -> Options
+        {
+            Options result;
+            result.n_threads    = 1;
+            result.max_nodes    = 1 << 18;
+            return result;
+        }
+
+        // An instance per thread, with `per_thread_options()` and the node storage allocated once.
+        static auto for_this_thread()
+            -> Mcts_&
+        {
+            static thread_local Mcts_ the_search( per_thread_options() );
+            return the_search;
+        }
+    };
+}  // namespace ttt
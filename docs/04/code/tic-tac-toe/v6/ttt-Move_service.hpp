@@ -0,0 +1,240 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Game.hpp"             // ttt::(Game, Game_, strategy)
+#include "ttt-Mcts.hpp"             // ttt::Mcts_
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int64_t, uint64_t
+
+#include <algorithm>    // std::max
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>   // std::function
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>      // std::move
+
+namespace ttt {
+    namespace cu = cpp::util;
+    namespace chr = std::chrono;
+    using   std::max,
+            std::atomic,
+            std::condition_variable,
+            std::function,
+            std::mutex, std::unique_lock,
+            std::optional,
+            std::thread,
+            std::move;
+
+    // Computes computer moves on a worker thread, so that a search doesn’t block the thread
+    // that requests it, typically a GUI thread with a message loop.
+    //
+    // Results and progress reports are passed to a sink function, which is called on the
+    // worker thread. In a GUI the sink would post a message to the window, and in a test it
+    // can just queue the events. Each request gets a ticket number, and an event is only
+    // delivered if its request is still the current one, i.e. hasn’t been cancelled or
+    // superseded; the receiver should still compare the ticket with `current_ticket()`
+    // because an event can be cancelled after it has been delivered to the sink.
+    template< class Game >
+    class Move_service_:
+        public cu::No_copying
+    {
+    public:
+        struct Event
+        {
+            enum Kind{ progress, move_found };
+
+            Kind        kind;
+            uint64_t    ticket;
+            int         move;               // For `move_found`.
+            int64_t     n_playouts;         // For `progress` during a Monte Carlo search.
+            double      search_seconds;     // For `move_found`.
+        };
+
+        using Sink = function<void( const Event& )>;
+
+        // `max_request_seconds` is the most time spent in `request_move_for` on the caller’s
+        // thread, to compare with `max_search_seconds`, which is kept off that thread.
+        struct Statistics
+        {
+            int64_t     n_requests              = 0;
+            int64_t     n_moves_delivered       = 0;
+            int64_t     n_cancelled             = 0;
+            double      max_request_seconds     = 0;
+            double      total_search_seconds    = 0;
+            double      max_search_seconds      = 0;
+        };
+
+    private:
+        struct Request{ uint64_t ticket; Game game; };
+
+        using Mcts_options = typename Mcts_<Game>::Options;
+
+        Sink                    m_sink;
+        strategy::Enum          m_strategy;
+        Mcts_options            m_mcts_options;
+        optional<Mcts_<Game>>   m_mcts;             // Created by the worker on first use.
+
+        mutex                   m_mutex;            // Guards the members up to `m_worker`.
+        condition_variable      m_wakeup;
+        optional<Request>       m_pending_request;
+        bool                    m_is_searching      = false;
+        bool                    m_is_shutting_down  = false;
+        Statistics              m_stats;
+
+        atomic<uint64_t>        m_current_ticket    {0};
+        atomic<uint64_t>        m_search_ticket     {0};
+        thread                  m_worker;
+
+        auto search_is_current() const
+            -> bool
+        { return m_search_ticket.load() == m_current_ticket.load(); }
+
+        auto mcts_options_from( Mcts_options options )
+            -> Mcts_options
+        {
+            options.should_stop = [this]() -> bool { return not search_is_current(); };
+            options.on_progress = [this]( const int64_t n_playouts )
+            {
+                if( search_is_current() ) {
+                    m_sink( {Event::progress, m_search_ticket.load(), -1, n_playouts, 0} );
+                }
+            };
+            return options;
+        }
+
+        auto move_for( const Game& game )
+            -> int
+        {
+            if( m_strategy == strategy::mcts ) {
+                if( not m_mcts ) { m_mcts.emplace( mcts_options_from( m_mcts_options ) ); }
+                return m_mcts->best_move_for( game );
+            }
+            return game.find_computer_move( m_strategy );
+        }
+
+        void serve_requests()
+        {
+            for( ;; ) {
+                Request request;
+                {
+                    unique_lock<mutex> lock( m_mutex );
+                    m_is_searching = false;
+                    m_wakeup.notify_all();
+                    m_wakeup.wait( lock, [this]{ return m_pending_request or m_is_shutting_down; } );
+                    if( m_is_shutting_down ) { return; }
+                    request = move( *m_pending_request );
+                    m_pending_request.reset();
+                    m_is_searching = true;
+                }
+                m_search_ticket = request.ticket;
+                if( not search_is_current() ) {
+                    unique_lock<mutex> lock( m_mutex );
+                    ++m_stats.n_cancelled;
+                    continue;
+                }
+
+                const auto start_time = chr::steady_clock::now();
+                const int cell_index = move_for( request.game );
+                const auto elapsed = chr::steady_clock::now() - start_time;
+                const double seconds = chr::duration<double>( elapsed ).count();
+
+                const bool is_current = search_is_current();
+                {
+                    unique_lock<mutex> lock( m_mutex );
+                    m_stats.total_search_seconds += seconds;
+                    m_stats.max_search_seconds = max( m_stats.max_search_seconds, seconds );
+                    ++(is_current? m_stats.n_moves_delivered : m_stats.n_cancelled);
+                }
+                if( is_current ) {
+                    m_sink( {Event::move_found, request.ticket, cell_index, 0, seconds} );
+                }
+            }
+        }
+
+    public:
+        // The Monte Carlo search state, with its node storage, is only allocated for
+        // `strategy::mcts`, when the first move is requested.
+        Move_service_(
+            Sink                    sink,
+            const strategy::Enum    choice          = strategy::heuristic,
+            const Mcts_options&     mcts_options    = Mcts_<Game>::per_thread_options()
+            ):
+            m_sink( move( sink ) ),
+            m_strategy( choice ),
+            m_mcts_options( mcts_options ),
+            m_worker( [this]{ serve_requests(); } )
+        {}
+
+        ~Move_service_()
+        {
+            {
+                unique_lock<mutex> lock( m_mutex );
+                m_is_shutting_down = true;
+                ++m_current_ticket;         // Stops any ongoing search.
+            }
+            m_wakeup.notify_all();
+            m_worker.join();
+        }
+
+        auto current_ticket() const -> uint64_t { return m_current_ticket.load(); }
+
+        // Starts a computation of a move for the player to move in `game`, which must not be
+        // over, and returns its ticket. Any earlier request is cancelled.
+        auto request_move_for( const Game& game )
+            -> uint64_t
+        {
+            assert( not game.is_over() );
+            const auto start_time = chr::steady_clock::now();
+            uint64_t ticket;
+            {
+                unique_lock<mutex> lock( m_mutex );
+                ticket = ++m_current_ticket;
+                if( m_pending_request ) { ++m_stats.n_cancelled; }
+                m_pending_request = Request{ ticket, game };
+                ++m_stats.n_requests;
+            }
+            m_wakeup.notify_all();
+            const auto elapsed = chr::steady_clock::now() - start_time;
+            const double seconds = chr::duration<double>( elapsed ).count();
+            {
+                unique_lock<mutex> lock( m_mutex );
+                m_stats.max_request_seconds = max( m_stats.max_request_seconds, seconds );
+            }
+            return ticket;
+        }
+
+        // Cancels the current request, if any, e.g. when a new game is started. Returns
+        // without waiting for the worker to stop searching.
+        void cancel()
+        {
+            unique_lock<mutex> lock( m_mutex );
+            ++m_current_ticket;
+            if( m_pending_request ) { ++m_stats.n_cancelled;  m_pending_request.reset(); }
+        }
+
+        auto is_busy()
+            -> bool
+        {
+            unique_lock<mutex> lock( m_mutex );
+            return m_is_searching or m_pending_request.has_value();
+        }
+
+        void wait_until_idle()
+        {
+            unique_lock<mutex> lock( m_mutex );
+            m_wakeup.wait( lock, [this]{ return not m_is_searching and not m_pending_request; } );
+        }
+
+        auto stats()
+            -> Statistics
+        {
+            unique_lock<mutex> lock( m_mutex );
+            return m_stats;
+        }
+    };
+
+    using Move_service = Move_service_<Game>;
+}  // namespace ttt
@@ -0,0 +1,114 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board, cell_state)
+
+#include <stdint.h>     // int8_t
+
+#include <array>
+
+// The complete game tree is solved at compile time. With MSVC this needs a higher
+// constexpr evaluation limit than the default, e.g. option "/constexpr:steps100000000".
+// So `ttt-Game.hpp` only includes this header, for `strategy::table`, with
+// `TTT_WITH_MOVE_TABLE` defined.
+
+namespace ttt {
+    using   std::array;
+
+    namespace impl::move_table {
+        using Bits = Board::Bits;
+
+        enum{ n_keys = 19'683 };    // 3⁹.
+        constexpr int8_t unknown = -128;
+
+        struct Entry
+        {
+            int8_t  move    = -1;       // -1 for a finished game or an unreachable position.
+            int8_t  score   = unknown;
+        };
+
+        using Entries   = array<Entry, n_keys>;
+        using Key_parts = array<int, Board::n_bit_patterns>;
+
+        constexpr auto make_key_parts()
+            -> Key_parts
+        {
+            Key_parts result = {};
+            for( int bits = 0; bits < Board::n_bit_patterns; ++bits ) {
+                int power = 1;
+                for( int i = 0; i < Board::n_cells; ++i ) {
+                    if( bits & Board::bit( i ) ) { result[bits] += power; }
+                    power *= 3;
+                }
+            }
+            return result;
+        }
+
+        constexpr Key_parts key_parts = make_key_parts();  // `bits` → Σ 3ⁱ over its 1-bits.
+
+        constexpr auto key_for( const Bits crosses, const Bits circles )
+            -> int
+        { return key_parts[crosses] + 2*key_parts[circles]; }
+
+        // Negamax without pruning, memoized in `entries`, in a constexpr-friendly form.
+        constexpr auto solve(
+            Entries&            entries,
+            const Bits          crosses,
+            const Bits          circles,
+            const bool          cross_is_to_move
+            ) -> int
+        {
+            const int key = key_for( crosses, circles );
+            if( entries[key].score != unknown ) { return entries[key].score; }
+
+            const Bits own          = (cross_is_to_move? crosses : circles);
+            const Bits opponent     = (cross_is_to_move? circles : crosses);
+            const Bits free_cells   = Bits( Board::all_cells & ~(crosses | circles) );
+            int n_free = 0;
+            for( int i = 0; i < Board::n_cells; ++i ) { n_free += !!(free_cells & Board::bit( i )); }
+
+            Entry result = {};
+            if( Board::win_line_indices[opponent] >= 0 ) {
+                result.score = int8_t( -(1 + n_free) );
+            } else if( n_free == 0 ) {
+                result.score = 0;
+            } else {
+                for( int i = 0; i < Board::n_cells; ++i ) {
+                    if( not (free_cells & Board::bit( i )) ) { continue; }
+                    const Bits new_own = Bits( own | Board::bit( i ) );
+                    const int score = -(cross_is_to_move
+                        ? solve( entries, new_own, circles, false )
+                        : solve( entries, crosses, new_own, true ));
+                    if( result.move < 0 or score > result.score ) {
+                        result = {int8_t( i ), int8_t( score )};
+                    }
+                }
+            }
+            entries[key] = result;
+            return result.score;
+        }
+
+        constexpr auto make_entries()
+            -> Entries
+        {
+            Entries result = {};
+            solve( result, 0, 0, true );
+            return result;
+        }
+    }  // namespace impl::move_table
+
+    // Best move and outcome for every position reachable from the empty board, indexed by
+    // a base 3 key where cell i contributes its `cell_state` value times 3ⁱ. A score is as
+    // for `Solver`: from the point of view of the player to move, 0 for a draw, and else
+    // ±(1 + the number of cells left free after the deciding move).
+    struct Move_table
+    {
+        using Entry = impl::move_table::Entry;
+        static constexpr int8_t unknown = impl::move_table::unknown;    // Unreachable.
+
+        static constexpr array<Entry, impl::move_table::n_keys> entries =
+            impl::move_table::make_entries();
+
+        static auto entry_for( const Board& board )
+            -> Entry
+        { return entries[impl::move_table::key_for( board.player_bits[0], board.player_bits[1] )]; }
+    };
+}  // namespace ttt
@@ -0,0 +1,170 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board, cell_state)
+#include "ttt-Symmetry.hpp"         // ttt::Symmetry
+#include <cpp/instrumentation.hpp>  // CPPUTIL_TIMED_SCOPE
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int8_t, int64_t, uint32_t
+
+#include <algorithm>    // std::(max, min)
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    using   std::max, std::min,
+            std::vector;
+
+    // Perfect play via negamax search with alpha-beta pruning and a transposition table.
+    //
+    // A score is from the point of view of the player to move: 0 for a draw, positive for a
+    // win and negative for a loss. The magnitude is 1 + the number of cells left free after
+    // the deciding move, so that quick wins and slow losses are preferred. Being relative to
+    // the position rather than to the search root, scores can be cached across searches.
+    //
+    // With `Table_keys::canonical` the table is keyed on the canonical symmetric variant of
+    // each position, so that the 8 variants share one entry.
+    class Solver
+    {
+    public:
+        using Bits = Board::Bits;
+
+        struct Result{ int move; int score; };
+
+        struct Table_keys{ enum Enum{ raw, canonical }; };
+
+        struct Statistics
+        {
+            int64_t     n_nodes         = 0;
+            int64_t     n_table_probes  = 0;
+            int64_t     n_table_hits    = 0;
+
+            auto hit_rate() const
+                -> double
+            { return (n_table_probes == 0? 0.0 : double( n_table_hits )/n_table_probes); }
+        };
+
+        // Center first, then corners, then edges.
+        static constexpr int move_order[Board::n_cells] = { 4, 0, 2, 6, 8, 1, 3, 5, 7 };
+
+    private:
+        enum{ infinity = Board::n_cells + 2 };
+
+        struct Bound{ enum Enum: int8_t{ none, exact, lower, upper }; };
+
+        struct Entry
+        {
+            uint32_t        key     = 0;
+            int8_t          score   = 0;
+            Bound::Enum     bound   = Bound::none;
+            int8_t          move    = -1;
+        };
+
+        vector<Entry>       m_table;
+        unsigned            m_index_mask;
+        Table_keys::Enum    m_keys;
+        Statistics          m_stats     = {};
+
+        static auto key_for( const Bits own, const Bits opponent )
+            -> uint32_t
+        { return (uint32_t( own ) << 16) | opponent; }
+
+        struct Table_key{ uint32_t key; int transform; };
+
+        auto table_key_for( const Bits own, const Bits opponent ) const
+            -> Table_key
+        {
+            if( m_keys == Table_keys::canonical ) {
+                const Symmetry::Canonical c = Symmetry::canonical( own, opponent );
+                return {key_for( c.own, c.opponent ), c.transform};
+            }
+            return {key_for( own, opponent ), 0};
+        }
+
+        auto entry_for( const uint32_t key )
+            -> Entry&
+        { return m_table[(key*0x9E3779B1u >> 8) & m_index_mask]; }
+
+        auto negamax( const Bits own, const Bits opponent, int alpha, int beta )
+            -> Result
+        {
+            ++m_stats.n_nodes;
+            const Bits free_cells = Bits( Board::all_cells & ~(own | opponent) );
+            if( Board::is_win( opponent ) ) { return {-1, -(1 + cu::bit_count( free_cells ))}; }
+            if( free_cells == 0 ) { return {-1, 0}; }
+
+            const int original_alpha = alpha;
+            const auto [key, transform] = table_key_for( own, opponent );
+            Entry& entry = entry_for( key );
+            ++m_stats.n_table_probes;
+            int first_move = -1;
+            if( entry.bound != Bound::none and entry.key == key ) {
+                ++m_stats.n_table_hits;
+                const int move = Symmetry::pre_image_of_move( entry.move, transform );
+                switch( entry.bound ) {
+                    case Bound::exact:  return {move, entry.score};
+                    case Bound::lower:  alpha = max<int>( alpha, entry.score ); break;
+                    case Bound::upper:  beta = min<int>( beta, entry.score ); break;
+                    case Bound::none:   break;
+                }
+                if( alpha >= beta ) { return {move, entry.score}; }
+                first_move = move;
+            }
+
+            Result best = {-1, -infinity};
+            const auto try_move = [&]( const int i ) -> bool   // Returns `true` for a cutoff.
+            {
+                const int score = -negamax( opponent, Bits( own | Board::bit( i ) ), -beta, -alpha ).score;
+                if( score > best.score ) { best = {i, score}; }
+                alpha = max( alpha, score );
+                return alpha >= beta;
+            };
+
+            bool cutoff = (first_move >= 0 and try_move( first_move ));
+            for( int j = 0; not cutoff and j < Board::n_cells; ++j ) {
+                const int i = move_order[j];
+                if( i != first_move and (free_cells & Board::bit( i )) ) {
+                    cutoff = try_move( i );
+                }
+            }
+
+            entry.key   = key;
+            entry.score = int8_t( best.score );
+            entry.move  = int8_t( Symmetry::image_of_move( best.move, transform ) );
+            entry.bound = (best.score <= original_alpha? Bound::upper
+                : best.score >= beta? Bound::lower
+                : Bound::exact);
+            return best;
+        }
+
+    public:
+        Solver( const int log2_table_size = 14, const Table_keys::Enum keys = Table_keys::raw ):
+            m_table( size_t( 1 ) << log2_table_size ),
+            m_index_mask( (1u << log2_table_size) - 1 ),
+            m_keys( keys )
+        {}
+
+        auto stats() const -> const Statistics& { return m_stats; }
+        void reset_stats() { m_stats = {}; }
+        void clear_table() { m_table.assign( m_table.size(), Entry() ); }
+
+        // The best move for `player`, who is to move; the board must have a free cell.
+        auto best_move_for( const Board& board, const cell_state::Enum player )
+            -> Result
+        {
+            CPPUTIL_TIMED_SCOPE( "ttt::Solver::best_move_for" );
+            assert( board.free_cells() != 0 );
+            const Bits own = board.bits_of( player );
+            const Bits opponent = board.bits_of( cell_state::opponent_of( player ) );
+            return negamax( own, opponent, -infinity, +infinity );
+        }
+
+        // An instance per thread, with the table kept warm across games.
+        static auto for_this_thread()
+            -> Solver&
+        {
+            static thread_local Solver the_solver;
+            return the_solver;
+        }
+    };
+}  // namespace ttt
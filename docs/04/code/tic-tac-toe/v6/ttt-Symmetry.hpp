@@ -0,0 +1,144 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board, Board_)
+
+#include <stdint.h>     // int8_t, uint64_t
+
+#include <array>
+
+namespace ttt {
+    using   std::array;
+
+    namespace impl::symmetry {
+        enum{ n_transforms = 8 };
+
+        // Transform t maps cell i = size*y + x of a `size`×`size` board to the cell returned.
+        // Transforms 4 through 7 are transforms 0 through 3 preceded by a reflection.
+        constexpr auto image_of( const int size, const int i, const int t )
+            -> int
+        {
+            int x = i % size;
+            int y = i / size;
+            if( t >= 4 ) { x = size - 1 - x; }         // Reflection in the vertical axis.
+            for( int r = 0; r < t % 4; ++r ) {          // Rotation by 90 degrees.
+                const int new_x = y;
+                y = size - 1 - x;
+                x = new_x;
+            }
+            return y*size + x;
+        }
+
+        template< int size >
+        using Cell_maps_ = array<array<int8_t, size*size>, n_transforms>;
+
+        template< int size >
+        constexpr auto make_cell_maps( const bool inverse )
+            -> Cell_maps_<size>
+        {
+            Cell_maps_<size> result = {};
+            for( int t = 0; t < n_transforms; ++t ) {
+                for( int i = 0; i < size*size; ++i ) {
+                    const int image = image_of( size, i, t );
+                    if( inverse ) {
+                        result[t][image] = int8_t( i );
+                    } else {
+                        result[t][i] = int8_t( image );
+                    }
+                }
+            }
+            return result;
+        }
+
+        template< class Bits, int size >
+        using Chunk_tables_ = array<array<array<Bits, 256>, (size*size + 7)/8>, n_transforms>;
+
+        // For each transform and each 8-bit chunk of a bitboard, the image of every chunk value.
+        template< class Bits, int size >
+        constexpr auto make_chunk_tables()
+            -> Chunk_tables_<Bits, size>
+        {
+            constexpr int n_cells = size*size;
+            Chunk_tables_<Bits, size> result = {};
+            for( int t = 0; t < n_transforms; ++t ) {
+                for( int chunk = 0; 8*chunk < n_cells; ++chunk ) {
+                    for( int byte = 0; byte < 256; ++byte ) {
+                        uint64_t bits = 0;
+                        for( int b = 0; b < 8; ++b ) {
+                            const int i = 8*chunk + b;
+                            if( i < n_cells and (byte & (1 << b)) ) {
+                                bits |= uint64_t( 1 ) << image_of( size, i, t );
+                            }
+                        }
+                        result[t][chunk][byte] = Bits( bits );
+                    }
+                }
+            }
+            return result;
+        }
+    }  // namespace impl::symmetry
+
+    // The 8 symmetries of a square board (the dihedral group D4): 4 rotations, each optionally
+    // preceded by a reflection. Symmetric positions have the same game-theoretic value, so a
+    // cache or opening book keyed on the canonical (minimal) representative needs about 8
+    // times fewer entries.
+    //
+    // Cell permutations are precomputed at compile time, and a bitboard is transformed with
+    // one table load per 8 cells.
+    template< class Board_type >
+    struct Symmetry_
+    {
+        using Board = Board_type;
+        using Bits  = typename Board::Bits;
+
+        static_assert( Board::width == Board::height, "Only a square board has 8 symmetries." );
+        static_assert( Board::bits_are_integral );
+
+        enum{ n_transforms = impl::symmetry::n_transforms, size = Board::width };
+        enum{ n_chunks = (Board::n_cells + 7)/8 };
+
+        static constexpr impl::symmetry::Cell_maps_<size> images =
+            impl::symmetry::make_cell_maps<size>( false );
+        static constexpr impl::symmetry::Cell_maps_<size> pre_images =
+            impl::symmetry::make_cell_maps<size>( true );
+        static constexpr impl::symmetry::Chunk_tables_<Bits, size> chunk_tables =
+            impl::symmetry::make_chunk_tables<Bits, size>();
+
+        static auto transformed( const Bits bits, const int t )
+            -> Bits
+        {
+            Bits result = 0;
+            for( int chunk = 0; chunk < n_chunks; ++chunk ) {
+                result |= chunk_tables[t][chunk][(bits >> 8*chunk) & 0xFF];
+            }
+            return result;
+        }
+
+        // The cell of a move on the original board in the transformed board, and vice versa.
+        static auto image_of_move( const int i, const int t ) -> int { return images[t][i]; }
+        static auto pre_image_of_move( const int i, const int t ) -> int { return pre_images[t][i]; }
+
+        struct Canonical
+        {
+            Bits    own;            // The player to move.
+            Bits    opponent;
+            int     transform;      // Maps the original position to the canonical one.
+        };
+
+        // The symmetric variant with the smallest (own, opponent) pair, and its transform.
+        static auto canonical( const Bits own, const Bits opponent )
+            -> Canonical
+        {
+            Canonical result = {own, opponent, 0};
+            for( int t = 1; t < n_transforms; ++t ) {
+                const Bits t_own = transformed( own, t );
+                if( t_own > result.own ) { continue; }
+                const Bits t_opponent = transformed( opponent, t );
+                if( t_own < result.own or t_opponent < result.opponent ) {
+                    result = {t_own, t_opponent, t};
+                }
+            }
+            return result;
+        }
+    };
+
+    using Symmetry = Symmetry_<Board>;
+}  // namespace ttt
@@ -0,0 +1,413 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board_, cell_state)
+#include "ttt-Mapped_file.hpp"      // ttt::Mapped_file
+#include "ttt-Symmetry.hpp"         // ttt::Symmetry_
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int8_t, int64_t, uint8_t, uint32_t, uint64_t
+#include <stdio.h>      // fopen, fwrite, fclose
+#include <string.h>     // memcmp, memcpy
+
+#include <algorithm>    // std::(max, min)
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>       // std::unique_ptr
+#include <string>
+#include <thread>
+#include <utility>      // std::move
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    using   std::max, std::min,
+            std::array,
+            std::atomic, std::memory_order_acquire, std::memory_order_release,
+            std::unique_ptr,
+            std::string,
+            std::thread,
+            std::move,
+            std::vector;
+
+    // Square boards with up to 16 cells, e.g. 4×4, have few enough positions for a tablebase.
+    template< class Board >
+    constexpr bool tablebase_is_possible_for =
+        (Board::n_cells <= 16 and Board::width == Board::height);
+
+    namespace impl::tablebase {
+        enum{ max_n = 16 };
+        using Binomials = array<array<uint32_t, max_n + 1>, max_n + 1>;
+
+        constexpr auto make_binomials()
+            -> Binomials
+        {
+            Binomials result = {};
+            for( int n = 0; n <= max_n; ++n ) {
+                result[n][0] = 1;
+                for( int k = 1; k <= n; ++k ) { result[n][k] = result[n - 1][k - 1] + result[n - 1][k]; }
+            }
+            return result;
+        }
+
+        constexpr Binomials binomials = make_binomials();   // binomials[n][k] is C(n, k).
+
+        // Rank of a set of bit positions among all sets of that size, in colex order.
+        inline auto rank_of( unsigned bits )
+            -> uint32_t
+        {
+            uint32_t result = 0;
+            for( int k = 1; bits != 0; ++k, bits &= bits - 1 ) {
+                result += binomials[cu::lowest_bit_index( bits )][k];
+            }
+            return result;
+        }
+
+        inline auto set_with_rank( uint32_t rank, const int n_bits, const int n_positions )
+            -> unsigned
+        {
+            unsigned result = 0;
+            int position = n_positions - 1;
+            for( int k = n_bits; k >= 1; --k ) {
+                while( binomials[position][k] > rank ) { --position; }
+                result |= 1u << position;
+                rank -= binomials[position][k];
+                --position;
+            }
+            return result;
+        }
+
+        // The bits of `bits` moved down to be contiguous over the zero bits of `mask`.
+        inline auto squeezed( const unsigned bits, const unsigned mask )
+            -> unsigned
+        {
+            unsigned result = 0;
+            int j = 0;
+            for( int i = 0; (mask | bits) >> i != 0; ++i ) {
+                if( mask & (1u << i) ) { continue; }
+                result |= ((bits >> i) & 1u) << j;
+                ++j;
+            }
+            return result;
+        }
+
+        // Inverse of `squeezed`.
+        inline auto spread( const unsigned bits, const unsigned mask, const int n_cells )
+            -> unsigned
+        {
+            unsigned result = 0;
+            int j = 0;
+            for( int i = 0; i < n_cells; ++i ) {
+                if( mask & (1u << i) ) { continue; }
+                result |= ((bits >> j) & 1u) << i;
+                ++j;
+            }
+            return result;
+        }
+    }  // namespace impl::tablebase
+
+    // The perfect-play score of every position of a small board, computed by retrograde
+    // analysis: positions with n pieces are valued from those with n + 1 pieces, from the
+    // full board back to the empty board. Scores are as for `Solver`, i.e. relative to the
+    // player to move, ±(1 + the number of cells left free after the deciding move) for a win
+    // or loss, so that the distance to the result is also known, and 0 for a draw.
+    //
+    // A position is ranked by its number of pieces, then its set of crosses, then its set of
+    // circles among the remaining cells, which densely numbers all positions with a legal
+    // number of pieces of each kind. The file only stores the scores of positions that are
+    // canonical under the board’s 8 symmetries and can occur in play; a bitmap over the dense
+    // ranks with a running count per 64 bits maps a dense rank to a stored score.
+    //
+    // A tablebase is immutable once loaded, so any number of threads can probe it without
+    // locking.
+    template< class Board_type >
+    class Tablebase_:
+        public cu::No_copying
+    {
+    public:
+        using Board     = Board_type;
+        using Bits      = typename Board::Bits;
+        using Symmetry  = Symmetry_<Board>;
+
+        static_assert( tablebase_is_possible_for<Board> );
+        enum{ n_cells = Board::n_cells, version = 1, header_size = 32 };
+
+        struct Result{ int move; int score; };
+
+        struct Generation_statistics
+        {
+            int64_t     n_positions         = 0;    // All with a legal number of pieces.
+            int64_t     n_stored            = 0;
+            int64_t     n_bytes             = 0;
+            double      seconds             = 0;
+        };
+
+        static auto n_crosses_for( const int n_pieces ) -> int { return (n_pieces + 1)/2; }
+        static auto n_circles_for( const int n_pieces ) -> int { return n_pieces/2; }
+
+        static auto layer_size( const int n_pieces )
+            -> uint32_t
+        {
+            using impl::tablebase::binomials;
+            const int n_crosses = n_crosses_for( n_pieces );
+            return binomials[n_cells][n_crosses]
+                * binomials[n_cells - n_crosses][n_circles_for( n_pieces )];
+        }
+
+        static auto layer_start( const int n_pieces )
+            -> uint32_t
+        {
+            uint32_t result = 0;
+            for( int n = 0; n < n_pieces; ++n ) { result += layer_size( n ); }
+            return result;
+        }
+
+        static auto rank_in_layer( const Bits crosses, const Bits circles )
+            -> uint32_t
+        {
+            using namespace impl::tablebase;
+            const int n_crosses = cu::bit_count( crosses );
+            const uint32_t n_circle_sets =
+                binomials[n_cells - n_crosses][cu::bit_count( circles )];
+            return rank_of( crosses )*n_circle_sets + rank_of( squeezed( circles, crosses ) );
+        }
+
+        struct Position{ Bits crosses; Bits circles; };
+
+        static auto position_at( const int n_pieces, const uint32_t rank )
+            -> Position
+        {
+            using namespace impl::tablebase;
+            const int n_crosses = n_crosses_for( n_pieces );
+            const int n_circles = n_circles_for( n_pieces );
+            const uint32_t n_circle_sets = binomials[n_cells - n_crosses][n_circles];
+            const unsigned crosses = set_with_rank( rank/n_circle_sets, n_crosses, n_cells );
+            const unsigned squeezed_circles =
+                set_with_rank( rank % n_circle_sets, n_circles, n_cells - n_crosses );
+            return {Bits( crosses ), Bits( spread( squeezed_circles, crosses, n_cells ) )};
+        }
+
+    private:
+        struct File_header
+        {
+            char        magic[4];
+            uint8_t     version;
+            uint8_t     width;
+            uint8_t     height;
+            uint8_t     run_length;
+            uint32_t    n_positions;
+            uint32_t    n_stored;
+            uint32_t    n_words;
+            uint8_t     reserved[12];
+        };
+        static_assert( sizeof( File_header ) == header_size );
+
+        static auto expected_header()
+            -> File_header
+        {
+            File_header result = {};
+            memcpy( result.magic, "tttT", 4 );
+            result.version      = version;
+            result.width        = uint8_t( Board::width );
+            result.height       = uint8_t( Board::height );
+            result.run_length   = uint8_t( Board::run_length );
+            result.n_positions  = layer_start( n_cells + 1 );
+            result.n_words      = (result.n_positions + 63)/64;
+            return result;
+        }
+
+        Mapped_file         m_file;
+        const uint64_t*     m_stored_bits;      // Bit i is set if position i is stored.
+        const uint32_t*     m_n_stored_before;  // Per 64-bit word of `m_stored_bits`.
+        const int8_t*       m_scores;
+
+        static inline unique_ptr<Tablebase_>        the_owner;
+        static inline atomic<const Tablebase_*>     the_loaded  {nullptr};
+
+        // Only for a position with a player to move, i.e. not for one after a win.
+        static auto is_stored( const Position& p, const bool circle_to_move )
+            -> bool
+        {
+            const Bits to_move = (circle_to_move? p.circles : p.crosses);
+            if( Board::is_win( to_move ) ) { return false; }
+            const typename Symmetry::Canonical c = Symmetry::canonical( p.crosses, p.circles );
+            return c.own == p.crosses and c.opponent == p.circles;
+        }
+
+        // Values the positions with n pieces with ranks in [first, beyond) from the scores
+        // of the positions with n + 1 pieces.
+        static void value_layer_part(
+            const int                   n_pieces,
+            const uint32_t              first,
+            const uint32_t              beyond,
+            const vector<int8_t>&       next_layer,
+            vector<int8_t>&             layer,
+            vector<uint8_t>&            stored_flags
+            )
+        {
+            const bool circle_to_move = (n_pieces % 2 == 1);
+            for( uint32_t rank = first; rank < beyond; ++rank ) {
+                const Position p = position_at( n_pieces, rank );
+                const Bits own          = (circle_to_move? p.circles : p.crosses);
+                const Bits opponent     = (circle_to_move? p.crosses : p.circles);
+                const Bits free_cells   = Bits( Board::all_cells & ~(own | opponent) );
+                int score;
+                if( Board::is_win( opponent ) ) {
+                    score = -(1 + cu::bit_count( free_cells ));
+                } else if( Board::is_win( own ) or free_cells == 0 ) {
+                    score = 0;      // After the game ended, or a draw.
+                } else {
+                    score = -(n_cells + 2);
+                    for( unsigned bits = free_cells; bits != 0; bits &= bits - 1 ) {
+                        const Bits cell = Board::bit( cu::lowest_bit_index( bits ) );
+                        const uint32_t child_rank = (circle_to_move
+                            ? rank_in_layer( p.crosses, Bits( p.circles | cell ) )
+                            : rank_in_layer( Bits( p.crosses | cell ), p.circles ));
+                        score = max( score, -next_layer[child_rank] );
+                    }
+                }
+                layer[rank] = int8_t( score );
+                stored_flags[rank] = is_stored( p, circle_to_move );
+            }
+        }
+
+    public:
+        explicit Tablebase_( const string& path ):
+            m_file( path, Mapped_file::random )
+        {
+            const File_header expected = expected_header();
+            File_header header;
+            cu::hopefully( m_file.n_bytes() >= header_size )
+                or CPPUTIL_FAIL( "“" + path + "” is not a tablebase." );
+            memcpy( &header, m_file.data(), header_size );
+            header.n_stored = 0;
+            cu::hopefully( memcmp( &header, &expected, header_size ) == 0 )
+                or CPPUTIL_FAIL( "“" + path + "” is not a tablebase for this board." );
+            memcpy( &header, m_file.data(), header_size );
+
+            const uint8_t* p = m_file.data() + header_size;
+            m_stored_bits = reinterpret_cast<const uint64_t*>( p );
+            p += 8*int64_t( header.n_words );
+            m_n_stored_before = reinterpret_cast<const uint32_t*>( p );
+            p += 4*int64_t( header.n_words );
+            m_scores = reinterpret_cast<const int8_t*>( p );
+            cu::hopefully( p + header.n_stored == m_file.data() + m_file.n_bytes() )
+                or CPPUTIL_FAIL( "“" + path + "” has the wrong size." );
+        }
+
+        // The score of a position where the player to move hasn’t lost yet.
+        auto score_of( const Bits crosses, const Bits circles ) const
+            -> int
+        {
+            const typename Symmetry::Canonical c = Symmetry::canonical( crosses, circles );
+            const int n_pieces = cu::bit_count( Bits( crosses | circles ) );
+            const uint32_t i = layer_start( n_pieces ) + rank_in_layer( c.own, c.opponent );
+            const uint64_t word = m_stored_bits[i/64];
+            const uint64_t bit = uint64_t( 1 ) << (i % 64);
+            assert( word & bit );
+            const int n_before = int( m_n_stored_before[i/64] ) + cu::bit_count( word & (bit - 1) );
+            return m_scores[n_before];
+        }
+
+        // The best move for `player`, who is to move; the board must have a free cell.
+        auto best_move_for( const Board& board, const cell_state::Enum player ) const
+            -> Result
+        {
+            assert( board.free_cells() != 0 );
+            const Bits crosses = board.bits_of( cell_state::cross );
+            const Bits circles = board.bits_of( cell_state::circle );
+            Result best = {-1, -(n_cells + 2)};
+            for( unsigned bits = board.free_cells(); bits != 0; bits &= bits - 1 ) {
+                const int i = cu::lowest_bit_index( bits );
+                const Bits cell = Board::bit( i );
+                const int score = (player == cell_state::cross
+                    ? -score_of( Bits( crosses | cell ), circles )
+                    : -score_of( crosses, Bits( circles | cell ) ));
+                if( score > best.score ) { best = {i, score}; }
+            }
+            return best;
+        }
+
+        // Writes the tablebase file, computing each layer with `n_threads` threads.
+        static auto generate( const string& path, const int n_threads )
+            -> Generation_statistics
+        {
+            using Clock = std::chrono::steady_clock;
+            const auto start_time = Clock::now();
+
+            File_header header = expected_header();
+            vector<uint64_t> stored_bits( header.n_words );
+            vector<int8_t> stored_scores;
+            vector<int8_t> next_layer;
+            vector<vector<int8_t>> stored_scores_per_layer( n_cells + 1 );
+            for( int n_pieces = n_cells; n_pieces >= 0; --n_pieces ) {
+                const uint32_t size = layer_size( n_pieces );
+                vector<int8_t> layer( size );
+                vector<uint8_t> stored_flags( size );
+                const uint32_t chunk_size = 4096;
+                atomic<uint32_t> next_chunk_start{ 0 };
+                const auto work = [&]
+                {
+                    for( ;; ) {
+                        const uint32_t first = next_chunk_start.fetch_add( chunk_size );
+                        if( first >= size ) { break; }
+                        value_layer_part(
+                            n_pieces, first, min( first + chunk_size, size ),
+                            next_layer, layer, stored_flags
+                            );
+                    }
+                };
+                vector<thread> workers;
+                for( int t = 1; t < n_threads; ++t ) { workers.emplace_back( work ); }
+                work();
+                for( thread& worker: workers ) { worker.join(); }
+
+                const uint32_t start = layer_start( n_pieces );
+                for( uint32_t rank = 0; rank < size; ++rank ) {
+                    if( stored_flags[rank] ) {
+                        stored_bits[(start + rank)/64] |= uint64_t( 1 ) << ((start + rank) % 64);
+                        stored_scores_per_layer[n_pieces].push_back( layer[rank] );
+                    }
+                }
+                next_layer = move( layer );
+            }
+
+            vector<uint32_t> n_stored_before( header.n_words );
+            uint32_t n_stored = 0;
+            for( uint32_t i = 0; i < header.n_words; ++i ) {
+                n_stored_before[i] = n_stored;
+                n_stored += uint32_t( cu::bit_count( stored_bits[i] ) );
+            }
+            header.n_stored = n_stored;
+
+            FILE* const f = fopen( path.c_str(), "wb" );
+            cu::hopefully( f != nullptr ) or CPPUTIL_FAIL( "Can’t create “" + path + "”." );
+            bool ok = (fwrite( &header, header_size, 1, f ) == 1);
+            ok = ok and fwrite( stored_bits.data(), 8, header.n_words, f ) == header.n_words;
+            ok = ok and fwrite( n_stored_before.data(), 4, header.n_words, f ) == header.n_words;
+            for( const vector<int8_t>& scores: stored_scores_per_layer ) {
+                ok = ok and fwrite( scores.data(), 1, scores.size(), f ) == scores.size();
+            }
+            ok = (fclose( f ) == 0) and ok;
+            cu::hopefully( ok ) or CPPUTIL_FAIL( "Writing “" + path + "” failed." );
+
+            Generation_statistics result;
+            result.n_positions  = header.n_positions;
+            result.n_stored     = n_stored;
+            result.n_bytes      = header_size + 12*int64_t( header.n_words ) + n_stored;
+            result.seconds      = std::chrono::duration<double>( Clock::now() - start_time ).count();
+            return result;
+        }
+
+        // Makes a tablebase available to `find_computer_move` for all threads. Should be
+        // called before the probing threads are started, and only once.
+        static void load( const string& path )
+        {
+            assert( not the_owner );
+            the_owner.reset( new Tablebase_( path ) );
+            the_loaded.store( the_owner.get(), memory_order_release );
+        }
+
+        static auto loaded() -> const Tablebase_* { return the_loaded.load( memory_order_acquire ); }
+    };
+}  // namespace ttt
@@ -0,0 +1,301 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::cell_state
+#include <cpp/instrumentation.hpp>  // CPPUTIL_TIMED_SCOPE
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int16_t, int64_t
+#include <stdlib.h>     // abs
+
+#include <algorithm>    // std::(max, max_element, min, stable_sort)
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    namespace chr = std::chrono;
+    using   std::max, std::min, std::stable_sort,
+            std::array,
+            std::vector;
+
+    namespace difficulty {
+        enum Enum{ easy, medium, hard, expert };
+    }  // namespace difficulty
+
+    // Limits for a timed search. A zero `random_margin` gives the best move found, and
+    // otherwise the move is chosen at random among those that score at most that much below
+    // the best, in units of the static evaluation, where one open line of 1 own cell is 4.
+    struct Search_budget
+    {
+        int         max_depth;
+        int64_t     max_microseconds;
+        int         random_margin;
+    };
+
+    constexpr auto budget_for( const difficulty::Enum level )
+        -> Search_budget
+    {
+        switch( level ) {
+            case difficulty::easy:      return {1, 2'000, 48};
+            case difficulty::medium:    return {3, 20'000, 12};
+            case difficulty::hard:      return {64, 200'000, 0};
+            case difficulty::expert:    return {64, 1'000'000, 0};
+        }
+        return {};
+    }
+
+    // Iterative deepening negamax with alpha-beta pruning under a hard deadline, for any board
+    // size. The clock is checked every 64 nodes, and when the deadline has passed the search
+    // unwinds at once and the best move so far is returned: that of the last completed
+    // iteration, or of the interrupted iteration if a root move searched in it scored
+    // higher. So a search overshoots its budget by at most 64 nodes and the unwinding.
+    //
+    // The static evaluation sums, over the lines that only one player has cells in, a weight
+    // of 4^(number of cells) for that player. On boards with more than 16 cells only the free
+    // cells next to occupied ones are considered as moves.
+    template< class Game >
+    class Timed_search_:
+        public cu::No_copying
+    {
+    public:
+        using Board     = typename Game::Board;
+        using Bits      = typename Board::Bits;
+
+        struct Result
+        {
+            int         move;
+            int         score;
+            int         depth;              // Of the last completed iteration, 0 if none.
+            int64_t     n_nodes;
+            int64_t     microseconds;
+        };
+
+        // The clock is checked every `check_interval` nodes, about every 512 line evaluations
+        // of `static_score`, so e.g. every 64 nodes on 3×3 and every node on 15×15, which
+        // bounds the search’s own overshoot of a deadline to a few µs for any board size.
+        enum{ win_score = 1 << 28, check_interval = (Board::n_lines < 512? 512/Board::n_lines : 1) };
+
+    private:
+        enum{ n_cells = Board::n_cells, infinity = win_score + 1 };
+        static constexpr bool uses_neighborhoods = (n_cells > 16);
+
+        static auto make_line_bits()
+            -> array<Bits, Board::n_lines>
+        {
+            array<Bits, Board::n_lines> result = {};
+            for( int i = 0; i < Board::n_lines; ++i ) { result[i] = Board::bits_of( Board::lines[i] ); }
+            return result;
+        }
+
+        static auto make_column_bits( const int x )
+            -> Bits
+        {
+            Bits result = {};
+            for( int y = 0; y < Board::height; ++y ) { result |= Board::bit( Board::width*y + x ); }
+            return result;
+        }
+
+        static inline const array<Bits, Board::n_lines> line_bits = make_line_bits();
+        static inline const Bits left_column = make_column_bits( 0 );
+        static inline const Bits right_column = make_column_bits( Board::width - 1 );
+
+        struct Root_move{ int move; int score; };
+
+        Game                        m_game;
+        chr::steady_clock::time_point   m_deadline;
+        int64_t                     m_n_nodes           = 0;
+        bool                        m_is_stopped        = false;
+        vector<vector<int16_t>>     m_move_lists;       // Per ply, to avoid allocation.
+
+        // Own cells per line, without the incremental counts of a board with a win table.
+        auto line_count( const cell_state::Enum player, const int line_index ) const
+            -> int
+        {
+            if constexpr( Board::has_win_table ) {
+                const Bits bits = Bits( m_game.board.bits_of( player ) & line_bits[line_index] );
+                return impl::board::bit_count( bits );
+            } else {
+                return m_game.board.line_counts[player - 1][line_index];
+            }
+        }
+
+        auto static_score() const
+            -> int
+        {
+            const cell_state::Enum player = m_game.player_to_move();
+            const cell_state::Enum opponent = cell_state::opponent_of( player );
+            int result = 0;
+            for( int i = 0; i < Board::n_lines; ++i ) {
+                const int n_own = line_count( player, i );
+                const int n_opponent = line_count( opponent, i );
+                if( n_opponent == 0 ) {
+                    result += (n_own == 0? 0 : 1 << 2*n_own);
+                } else if( n_own == 0 ) {
+                    result -= 1 << 2*n_opponent;
+                }
+            }
+            return result;
+        }
+
+        // Free cells next to occupied cells, or the center cell of an empty board.
+        auto candidate_cells() const
+            -> Bits
+        {
+            const Bits occupied = m_game.board.occupied_cells();
+            if( occupied == Bits() ) { return Board::bit( Board::width*(Board::height/2) + Board::width/2 ); }
+            const Bits row_neighborhood = Bits( occupied
+                | Bits( Bits( occupied & ~right_column ) << 1 )
+                | Bits( Bits( occupied & ~left_column ) >> 1 ) );
+            const Bits neighborhood = Bits( row_neighborhood
+                | Bits( row_neighborhood << Board::width )
+                | Bits( row_neighborhood >> Board::width ) );
+            return Bits( neighborhood & m_game.board.free_cells() );
+        }
+
+        void generate_moves( vector<int16_t>& moves ) const
+        {
+            moves.clear();
+            const Bits cells = (uses_neighborhoods? candidate_cells() : m_game.board.free_cells());
+            if constexpr( Board::bits_are_integral ) {
+                for( auto bits = cells; bits != 0; bits &= bits - 1 ) {
+                    moves.push_back( int16_t( cu::lowest_bit_index( bits ) ) );
+                }
+            } else {
+                for( int i = 0; i < n_cells; ++i ) {
+                    if( cells[i] ) { moves.push_back( int16_t( i ) ); }
+                }
+            }
+        }
+
+        auto is_out_of_time()
+            -> bool
+        {
+            if( not m_is_stopped and m_n_nodes % check_interval == 0 ) {
+                m_is_stopped = (chr::steady_clock::now() >= m_deadline);
+            }
+            return m_is_stopped;
+        }
+
+        auto negamax( const int depth, const int ply, int alpha, const int beta )
+            -> int
+        {
+            ++m_n_nodes;
+            if( is_out_of_time() ) { return 0; }        // The caller discards the score.
+            if( m_game.win_line ) { return -(win_score - ply); }
+            if( m_game.n_moves == n_cells ) { return 0; }
+            if( depth == 0 ) { return static_score(); }
+
+            vector<int16_t>& moves = m_move_lists[ply];
+            generate_moves( moves );
+            int best = -infinity;
+            for( const int move: moves ) {
+                m_game.make_move( move );
+                const int score = -negamax( depth - 1, ply + 1, -beta, -alpha );
+                m_game.unmake_move();
+                if( m_is_stopped ) { return best; }
+                best = max( best, score );
+                alpha = max( alpha, score );
+                if( alpha >= beta ) { break; }
+            }
+            return best;
+        }
+
+        // Searches the root moves in order, each with the window lowered by `margin` below the
+        // best score so far so that all moves within the margin get exact scores. Returns
+        // the number of root moves fully searched before any timeout.
+        auto search_root( vector<Root_move>& root_moves, const int depth, const int margin )
+            -> int
+        {
+            int best = -infinity;
+            int n_searched = 0;
+            for( Root_move& root_move: root_moves ) {
+                const int alpha = (best == -infinity? -infinity : max( -infinity, best - margin - 1 ));
+                m_game.make_move( root_move.move );
+                const int score = -negamax( depth - 1, 1, -infinity, -alpha );
+                m_game.unmake_move();
+                if( m_is_stopped ) { break; }
+                root_move.score = score;
+                best = max( best, score );
+                ++n_searched;
+            }
+            return n_searched;
+        }
+
+        static auto random_choice_among( const vector<Root_move>& root_moves, const int margin )
+            -> Root_move
+        {
+            int best = -infinity;
+            for( const Root_move& m: root_moves ) { best = max( best, m.score ); }
+            vector<Root_move> candidates;
+            for( const Root_move& m: root_moves ) {
+                if( m.score >= best - margin ) { candidates.push_back( m ); }
+            }
+            return candidates[cu::random_up_to( int( candidates.size() ) )];
+        }
+
+    public:
+        // The best move for the player to move in `game`, which must not be over.
+        auto best_move_for( const Game& game, const Search_budget& budget )
+            -> Result
+        {
+            CPPUTIL_TIMED_SCOPE( "ttt::Timed_search_::best_move_for" );
+            assert( not game.is_over() and budget.max_depth >= 1 );
+            const auto start_time = chr::steady_clock::now();
+            m_deadline = start_time + chr::microseconds( budget.max_microseconds );
+            m_game = game;
+            m_n_nodes = 0;
+            m_is_stopped = false;
+            m_move_lists.resize( size_t( n_cells + 1 ) );
+
+            vector<Root_move> root_moves;
+            vector<int16_t> moves;
+            generate_moves( moves );
+            for( const int move: moves ) { root_moves.push_back( {move, -infinity} ); }
+
+            const auto by_descending_score = []( const Root_move& a, const Root_move& b ) -> bool
+            {
+                return a.score > b.score;
+            };
+            vector<Root_move> completed = root_moves;    // Of the last completed iteration.
+            int completed_depth = 0;
+            Root_move choice = completed[0];
+            const int max_depth = min( budget.max_depth, n_cells - game.n_moves );
+            for( int depth = 1; depth <= max_depth; ++depth ) {
+                const int n_searched = search_root( root_moves, depth, budget.random_margin );
+                if( n_searched < int( root_moves.size() ) ) {
+                    // Interrupted. The previous best move was searched first, so the best of
+                    // the fully searched moves is at least as good, at a greater depth.
+                    if( n_searched > 0 and completed_depth > 0 and budget.random_margin == 0 ) {
+                        choice = *std::max_element( root_moves.begin(), root_moves.begin() + n_searched,
+                            []( const Root_move& a, const Root_move& b ) { return a.score < b.score; }
+                            );
+                    }
+                    break;
+                }
+                stable_sort( root_moves.begin(), root_moves.end(), by_descending_score );
+                completed = root_moves;
+                completed_depth = depth;
+                choice = completed[0];
+                if( abs( choice.score ) > win_score - n_cells ) { break; }     // Decided.
+            }
+
+            if( budget.random_margin > 0 and completed_depth > 0 ) {
+                choice = random_choice_among( completed, budget.random_margin );
+            }
+            const auto elapsed = chr::steady_clock::now() - start_time;
+            return {
+                choice.move, choice.score, completed_depth, m_n_nodes,
+                chr::duration_cast<chr::microseconds>( elapsed ).count()
+            };
+        }
+
+        // An instance per thread, with its buffers kept across searches.
+        static auto for_this_thread()
+            -> Timed_search_&
+        {
+            static thread_local Timed_search_ the_search;
+            return the_search;
+        }
+    };
+}  // namespace ttt
@@ -0,0 +1,208 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Board.hpp"            // ttt::(Board, cell_state)
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int8_t, uint64_t
+
+#include <array>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    using   std::array;
+
+    namespace impl::ultimate {
+        enum{ n_sub_boards = Board::n_cells, n_cells = n_sub_boards*Board::n_cells };
+
+        constexpr auto make_line_bits()
+            -> array<Board::Bits, Board::n_lines>
+        {
+            array<Board::Bits, Board::n_lines> result = {};
+            for( int i = 0; i < Board::n_lines; ++i ) { result[i] = Board::bits_of( Board::lines[i] ); }
+            return result;
+        }
+
+        // Keys per player and cell, then one per constraint: any sub-board or sub-board i.
+        struct Zobrist_keys
+        {
+            array<array<uint64_t, n_cells>, 2>      cells;
+            array<uint64_t, n_sub_boards + 1>       forced;
+        };
+
+        constexpr auto make_zobrist_keys()
+            -> Zobrist_keys
+        {
+            Zobrist_keys result = {};
+            cu::Splitmix64 bits( 0x556C74696D617465u );
+            for( auto& player_keys: result.cells ) {
+                for( uint64_t& key: player_keys ) { key = bits.next(); }
+            }
+            for( uint64_t& key: result.forced ) { key = bits.next(); }
+            return result;
+        }
+    }  // namespace impl::ultimate
+
+    // Ultimate tic-tac-toe: a 3×3 arrangement of 3×3 sub-boards. A move in cell c of a
+    // sub-board sends the opponent to sub-board c, or anywhere if sub-board c is decided, i.e.
+    // won or full. Winning a sub-board claims the corresponding cell of the meta-board, and a
+    // line on the meta-board wins the game. If all sub-boards are decided without that, it’s
+    // a draw.
+    //
+    // A move is numbered 9*s + c for cell c of sub-board s. Both the sub-boards and the
+    // meta-board are `ttt::Board`s, so win checks are table lookups. Moves are unmade from an
+    // inline stack, and a Zobrist hash of the cells and the constraint is kept up to date.
+    struct Ultimate_game
+    {
+        using Bits = Board::Bits;
+
+        enum{
+            n_sub_boards    = impl::ultimate::n_sub_boards,
+            n_cells         = impl::ultimate::n_cells,
+            any_sub_board   = -1
+        };
+
+        static constexpr array<Bits, Board::n_lines> line_bits = impl::ultimate::make_line_bits();
+        static constexpr impl::ultimate::Zobrist_keys zobrist_keys =
+            impl::ultimate::make_zobrist_keys();
+
+        // Weights for the static evaluation, relative to 1 per open two-in-a-row on a sub-board.
+        enum{
+            meta_cell_weight    = 8,        // Per sub-board won, plus as much again for the center.
+            meta_two_weight     = 24,       // Per open two-in-a-row of won sub-boards.
+            win_score           = 1'000'000
+        };
+
+        struct Undo{ int8_t move; int8_t forced; bool won_sub_board; };
+
+        array<Board, n_sub_boards>      sub_boards      = {};
+        Board                           meta            = {};   // Cell s is set when s is won.
+        Bits                            decided         = 0;    // Sub-boards won or full.
+        int                             forced          = any_sub_board;
+        int                             n_moves         = 0;
+        bool                            is_won          = false;    // By the last move.
+        uint64_t                        hash            = zobrist_keys.forced[0];
+        array<Undo, n_cells>            undo_stack      = {};
+
+        auto player_to_move() const
+            -> cell_state::Enum
+        { return (n_moves % 2 == 0? cell_state::cross : cell_state::circle); }
+
+        auto is_over() const -> bool { return is_won or decided == Board::all_cells; }
+
+        // The sub-boards where the player to move may play.
+        auto playable_sub_boards() const
+            -> Bits
+        { return (forced == any_sub_board? Bits( Board::all_cells & ~decided ) : Board::bit( forced )); }
+
+        // Stores the legal moves in `moves` and returns their number, 0 if the game is over.
+        auto legal_moves( array<int8_t, n_cells>& moves ) const
+            -> int
+        {
+            if( is_won ) { return 0; }
+            int n = 0;
+            for( unsigned subs = playable_sub_boards(); subs != 0; subs &= subs - 1 ) {
+                const int s = cu::lowest_bit_index( subs );
+                for( unsigned cells = sub_boards[s].free_cells(); cells != 0; cells &= cells - 1 ) {
+                    moves[n++] = int8_t( Board::n_cells*s + cu::lowest_bit_index( cells ) );
+                }
+            }
+            return n;
+        }
+
+        void make_move( const int move )
+        {
+            assert( not is_over() );
+            const int s = move/Board::n_cells;
+            const int c = move % Board::n_cells;
+            assert( playable_sub_boards() & Board::bit( s ) );
+            const cell_state::Enum player = player_to_move();
+            Board& sub_board = sub_boards[s];
+
+            Undo& undo = undo_stack[n_moves];
+            undo = {int8_t( move ), int8_t( forced ), false};
+            sub_board.set( c, player );
+            hash ^= zobrist_keys.cells[player - 1][move];
+            if( sub_board.win_line_through( c, player ) ) {
+                undo.won_sub_board = true;
+                meta.set( s, player );
+                decided |= Board::bit( s );
+                is_won = meta.win_line_through( s, player ).has_value();
+            } else if( sub_board.free_cells() == 0 ) {
+                decided |= Board::bit( s );
+            }
+            hash ^= zobrist_keys.forced[forced + 1];
+            forced = ((decided & Board::bit( c ))? int( any_sub_board ) : c);
+            hash ^= zobrist_keys.forced[forced + 1];
+            ++n_moves;
+        }
+
+        // Takes back the last move. Play continued after every earlier position, so none of
+        // them was won.
+        void unmake_move()
+        {
+            assert( n_moves > 0 );
+            --n_moves;
+            const Undo& undo = undo_stack[n_moves];
+            const int s = undo.move/Board::n_cells;
+            const int c = undo.move % Board::n_cells;
+            const cell_state::Enum player = player_to_move();
+            hash ^= zobrist_keys.forced[forced + 1];
+            forced = undo.forced;
+            hash ^= zobrist_keys.forced[forced + 1];
+            hash ^= zobrist_keys.cells[player - 1][undo.move];
+            sub_boards[s].unset( c );
+            if( undo.won_sub_board ) { meta.unset( s ); }
+            decided &= Bits( ~Board::bit( s ) );
+            is_won = false;
+        }
+
+        // The winner of the game so far, or `cell_state::empty`.
+        auto winner() const
+            -> cell_state::Enum
+        {
+            if( not is_won ) { return cell_state::empty; }
+            return cell_state::opponent_of( player_to_move() );
+        }
+
+        // A heuristic score of a position that isn’t over, from the point of view of the player
+        // to move: won sub-boards and open meta-board lines of them, and open two-in-a-rows
+        // within the undecided sub-boards.
+        auto static_score() const
+            -> int
+        {
+            const cell_state::Enum player = player_to_move();
+            const cell_state::Enum opponent = cell_state::opponent_of( player );
+            const int sign = (player == cell_state::cross? 1 : -1);
+            const auto score_for_cross = [&]( const Board& board, const Bits blocked, const int two_weight )
+                -> int
+            {
+                const Bits crosses = board.bits_of( cell_state::cross );
+                const Bits circles = board.bits_of( cell_state::circle );
+                int result = 0;
+                for( const Bits line: line_bits ) {
+                    if( line & blocked ) { continue; }
+                    const int n_crosses = cu::bit_count( Bits( crosses & line ) );
+                    const int n_circles = cu::bit_count( Bits( circles & line ) );
+                    if( n_crosses == 2 and n_circles == 0 ) { result += two_weight; }
+                    if( n_circles == 2 and n_crosses == 0 ) { result -= two_weight; }
+                }
+                return result;
+            };
+
+            const Bits dead = Bits( decided & ~meta.occupied_cells() );
+            const Bits center = Board::bit( Board::n_cells/2 );
+            int result = meta_weighted_cells( meta.bits_of( player ), center )
+                - meta_weighted_cells( meta.bits_of( opponent ), center );
+            result += sign*score_for_cross( meta, dead, meta_two_weight );
+            for( unsigned subs = Board::all_cells & ~decided; subs != 0; subs &= subs - 1 ) {
+                result += sign*score_for_cross( sub_boards[cu::lowest_bit_index( subs )], 0, 1 );
+            }
+            return result;
+        }
+
+    private:
+        static auto meta_weighted_cells( const Bits won, const Bits center )
+            -> int
+        { return meta_cell_weight*(cu::bit_count( won ) + cu::bit_count( Bits( won & center ) )); }
+    };
+}  // namespace ttt
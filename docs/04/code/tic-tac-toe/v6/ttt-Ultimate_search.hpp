@@ -0,0 +1,290 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include "ttt-Ultimate_game.hpp"    // ttt::Ultimate_game
+#include <cpp/util.hpp>
+
+#include <assert.h>
+#include <stdint.h>     // int8_t, int32_t, int64_t, uint32_t, uint64_t
+#include <stdlib.h>     // abs
+
+#include <algorithm>    // std::(max, min, rotate)
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ttt {
+    namespace cu = cpp::util;
+    namespace chr = std::chrono;
+    using   std::max, std::min, std::rotate,
+            std::array,
+            std::atomic, std::memory_order_relaxed,
+            std::thread,
+            std::vector;
+
+    // Iterative deepening alpha-beta search for ultimate tic-tac-toe, parallelized as “lazy
+    // SMP”: every thread searches the same root independently, and they share only a
+    // transposition table, so that each thread’s results prune the other threads’ trees.
+    // Helper threads search every other iteration one ply deeper and try the moves in a
+    // rotated order, so that they tend to fill the table ahead of the main thread; the main
+    // thread’s result is the answer.
+    //
+    // The table is lock-free: an entry is two 64-bit atomics, the position’s hash xor the
+    // data, and the data, so that an entry torn by concurrent writes is detected by its key
+    // not matching and is treated as a miss.
+    class Ultimate_search:
+        public cu::No_copying
+    {
+    public:
+        using Game = Ultimate_game;
+
+        struct Options
+        {
+            int         n_threads           = max( 1, int( thread::hardware_concurrency() ) );
+            int         max_depth           = 8;
+            double      max_seconds         = 1e9;
+            int         log2_table_size     = 20;
+        };
+
+        struct Result
+        {
+            int         move;
+            int         score;              // As for `Ultimate_game::static_score`, or a win.
+            int         depth;              // Of the last iteration completed by the main thread.
+            int64_t     n_nodes;            // For all threads.
+            double      seconds;
+        };
+
+    private:
+        enum{ win_score = Game::win_score, infinity = win_score + 1, max_win_ply = Game::n_cells };
+        struct Bound{ enum Enum{ none, exact, lower, upper }; };
+
+        struct Table_entry
+        {
+            atomic<uint64_t>    check   {0};    // The hash xor `data`.
+            atomic<uint64_t>    data    {0};
+        };
+
+        // Packed into a table entry’s `data`.
+        struct Table_data
+        {
+            int             score;
+            int             depth;
+            Bound::Enum     bound;
+            int             move;
+
+            auto packed() const
+                -> uint64_t
+            {
+                return uint64_t( uint32_t( score ) ) | uint64_t( depth & 0xFF ) << 32
+                    | uint64_t( bound ) << 40 | uint64_t( move & 0xFF ) << 48;
+            }
+
+            static auto from( const uint64_t bits )
+                -> Table_data
+            {
+                return {
+                    int32_t( uint32_t( bits ) ), int( bits >> 32 & 0xFF ),
+                    Bound::Enum( bits >> 40 & 0xFF ), int( int8_t( bits >> 48 & 0xFF ) )
+                };
+            }
+        };
+
+        // Each search thread’s own state.
+        struct Worker
+        {
+            int                 index;
+            Game                game;
+            int64_t             n_nodes         = 0;
+            int                 root_move       = -1;   // The best move of the last iteration.
+            bool                has_deadline    = false;
+            chr::steady_clock::time_point   deadline;
+        };
+
+        Options                 m_options;
+        vector<Table_entry>     m_table;
+        uint64_t                m_index_mask;
+        atomic<bool>            m_should_stop       {false};
+
+        // Win scores are stored relative to the position rather than to the root.
+        static auto is_win_score( const int score ) -> bool { return abs( score ) > win_score - max_win_ply; }
+
+        static auto table_score_from( const int score, const int ply )
+            -> int
+        { return (not is_win_score( score )? score : score > 0? score + ply : score - ply); }
+
+        static auto score_from_table( const int score, const int ply )
+            -> int
+        { return (not is_win_score( score )? score : score > 0? score - ply : score + ply); }
+
+        auto entry_for( const uint64_t hash ) -> Table_entry& { return m_table[hash & m_index_mask]; }
+
+        auto probe( const uint64_t hash, Table_data& data )
+            -> bool
+        {
+            Table_entry& entry = entry_for( hash );
+            const uint64_t packed = entry.data.load( memory_order_relaxed );
+            if( (entry.check.load( memory_order_relaxed ) ^ packed) != hash ) { return false; }
+            data = Table_data::from( packed );
+            return data.bound != Bound::none;
+        }
+
+        void store( const uint64_t hash, const Table_data& data )
+        {
+            Table_entry& entry = entry_for( hash );
+            const uint64_t packed = data.packed();
+            entry.check.store( hash ^ packed, memory_order_relaxed );
+            entry.data.store( packed, memory_order_relaxed );
+        }
+
+        auto should_stop( Worker& worker )
+            -> bool
+        {
+            if( worker.has_deadline and worker.n_nodes % 1024 == 0
+                and chr::steady_clock::now() >= worker.deadline ) {
+                m_should_stop = true;
+            }
+            return m_should_stop.load( memory_order_relaxed );
+        }
+
+        // Puts `first_move`, if any, first and otherwise keeps the generated order, rotated per
+        // helper thread.
+        static void order( array<int8_t, Game::n_cells>& moves, const int n_moves,
+            const int first_move, const int worker_index )
+        {
+            if( worker_index > 0 and n_moves > 1 ) {
+                rotate( moves.begin(), moves.begin() + worker_index % n_moves, moves.begin() + n_moves );
+            }
+            for( int i = 0; i < n_moves; ++i ) {
+                if( moves[i] == first_move ) {
+                    rotate( moves.begin(), moves.begin() + i, moves.begin() + i + 1 );
+                    break;
+                }
+            }
+        }
+
+        auto negamax( Worker& worker, const int depth, const int ply, int alpha, int beta )
+            -> int
+        {
+            Game& game = worker.game;
+            ++worker.n_nodes;
+            if( should_stop( worker ) ) { return 0; }
+            if( game.is_won ) { return -(win_score - ply); }
+            array<int8_t, Game::n_cells> moves;
+            const int n_moves = game.legal_moves( moves );
+            if( n_moves == 0 ) { return 0; }
+            if( depth == 0 ) { return game.static_score(); }
+
+            const int original_alpha = alpha;
+            int first_move = -1;
+            Table_data data;
+            if( probe( game.hash, data ) ) {
+                const int score = score_from_table( data.score, ply );
+                if( ply > 0 and data.depth >= depth ) {     // The root needs its best move.
+                    switch( data.bound ) {
+                        case Bound::exact:  return score;
+                        case Bound::lower:  alpha = max( alpha, score ); break;
+                        case Bound::upper:  beta = min( beta, score ); break;
+                        case Bound::none:   break;
+                    }
+                    if( alpha >= beta ) { return score; }
+                }
+                first_move = data.move;
+            }
+
+            order( moves, n_moves, first_move, worker.index );
+            int best_score = -infinity;
+            int best_move = moves[0];
+            for( int i = 0; i < n_moves; ++i ) {
+                game.make_move( moves[i] );
+                const int score = -negamax( worker, depth - 1, ply + 1, -beta, -alpha );
+                game.unmake_move();
+                if( m_should_stop.load( memory_order_relaxed ) ) { return 0; }
+                if( score > best_score ) { best_score = score; best_move = moves[i]; }
+                alpha = max( alpha, score );
+                if( alpha >= beta ) { break; }
+            }
+
+            const Bound::Enum bound = (best_score <= original_alpha? Bound::upper
+                : best_score >= beta? Bound::lower
+                : Bound::exact);
+            store( game.hash, {table_score_from( best_score, ply ), depth, bound, best_move} );
+            if( ply == 0 ) { worker.root_move = best_move; }
+            return best_score;
+        }
+
+        // Iterative deepening on `worker.game`. The result is that of the last completed
+        // iteration, with a move of -1 if none was completed.
+        auto search( Worker& worker )
+            -> Result
+        {
+            Result result = {-1, 0, 0, 0, 0};
+            for( int iteration = 1; iteration <= m_options.max_depth; ++iteration ) {
+                const int depth = min( m_options.max_depth, iteration + worker.index % 2 );
+                const int score = negamax( worker, depth, 0, -infinity, +infinity );
+                if( m_should_stop.load( memory_order_relaxed ) ) { break; }
+                result.move = worker.root_move;
+                result.score = score;
+                result.depth = depth;
+            }
+            return result;
+        }
+
+    public:
+        Ultimate_search(): Ultimate_search( Options() ) {}
+
+        explicit Ultimate_search( const Options& options ):
+            m_options( options ),
+            m_table( size_t( 1 ) << options.log2_table_size ),
+            m_index_mask( (uint64_t( 1 ) << options.log2_table_size) - 1 )
+        {
+            assert( options.n_threads >= 1 and options.max_depth >= 1 );
+        }
+
+        void clear_table()
+        {
+            for( Table_entry& entry: m_table ) {
+                entry.check.store( 0, memory_order_relaxed );
+                entry.data.store( 0, memory_order_relaxed );
+            }
+        }
+
+        // The best move for the player to move in `game`, which must not be over. The table is
+        // kept across calls.
+        auto best_move_for( const Game& game )
+            -> Result
+        {
+            assert( not game.is_over() );
+            const auto start_time = chr::steady_clock::now();
+            m_should_stop = false;
+
+            vector<Worker> workers( size_t( m_options.n_threads ) );
+            for( int i = 0; i < m_options.n_threads; ++i ) {
+                workers[i].index = i;
+                workers[i].game = game;
+            }
+            Worker& main_worker = workers[0];
+            main_worker.has_deadline = (m_options.max_seconds < 1e9);
+            main_worker.deadline = start_time + chr::duration_cast<chr::steady_clock::duration>(
+                chr::duration<double>( min( m_options.max_seconds, 1e9 ) )
+                );
+
+            vector<thread> helpers;
+            for( int i = 1; i < m_options.n_threads; ++i ) {
+                helpers.emplace_back( [this, &workers, i]{ search( workers[i] ); } );
+            }
+            Result result = search( main_worker );
+            m_should_stop = true;
+            for( thread& helper: helpers ) { helper.join(); }
+
+            if( result.move < 0 ) {     // The time was up before the first iteration completed.
+                array<int8_t, Game::n_cells> moves;
+                game.legal_moves( moves );
+                result.move = (main_worker.root_move >= 0? main_worker.root_move : moves[0]);
+            }
+            for( const Worker& worker: workers ) { result.n_nodes += worker.n_nodes; }
+            result.seconds = chr::duration<double>( chr::steady_clock::now() - start_time ).count();
+            return result;
+        }
+    };
+}  // namespace ttt
@@ -0,0 +1,414 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>     // cpp::util::(No_copying, Range)
+
+#include <assert.h>         // assert
+#include <stdint.h>         // int64_t, uint64_t
+
+#include <algorithm>        // std::max
+#include <atomic>           // std::(atomic, atomic_thread_fence, memory_order_...)
+#include <condition_variable>   // std::condition_variable
+#include <deque>            // std::deque
+#include <exception>        // std::(exception_ptr, current_exception, rethrow_exception)
+#include <functional>       // std::function
+#include <memory>           // std::unique_ptr
+#include <mutex>            // std::(mutex, unique_lock)
+#include <thread>           // std::(thread, this_thread::yield)
+#include <utility>          // std::(exchange, forward, move)
+#include <vector>           // std::vector
+
+namespace cpp::util {
+    using   std::max,
+            std::atomic, std::atomic_thread_fence,
+            std::memory_order_relaxed, std::memory_order_acquire, std::memory_order_release,
+            std::memory_order_seq_cst,
+            std::condition_variable,
+            std::deque,
+            std::exception_ptr, std::current_exception, std::rethrow_exception,
+            std::function,
+            std::unique_ptr,
+            std::mutex, std::unique_lock,
+            std::thread,
+            std::move,
+            std::vector;
+
+    class Task_group;
+
+    namespace impl::thread_pool {
+        struct Task
+        {
+            function<void()>    work;
+            Task_group*         group;
+        };
+
+        // Chase and Lev’s work-stealing deque, with the memory orders of Lê, Pop, Cohen and
+        // Zappa Nardelli, “Correct and Efficient Work-Stealing for Weak Memory Models” (2013).
+        // The owner pushes and pops at the bottom, thieves steal from the top. The ring buffer
+        // is doubled when full; old buffers are kept until destruction, since a thief may
+        // still read from one.
+        class Work_deque:
+            public No_copying
+        {
+            struct Ring
+            {
+                int64_t                         mask;
+                unique_ptr<atomic<Task*>[]>     slots;
+
+                explicit Ring( const int64_t capacity ):
+                    mask( capacity - 1 ),
+                    slots( new atomic<Task*>[size_t( capacity )] )
+                {}
+
+                auto capacity() const -> int64_t { return mask + 1; }
+                auto at( const int64_t i ) -> atomic<Task*>& { return slots[size_t( i & mask )]; }
+            };
+
+            atomic<int64_t>             m_top       {0};
+            atomic<int64_t>             m_bottom    {0};
+            atomic<Ring*>               m_ring;
+            vector<unique_ptr<Ring>>    m_rings;        // Owned by the owner thread.
+
+            auto grown( Ring& ring, const int64_t top, const int64_t bottom )
+                -> Ring*
+            {
+                m_rings.push_back( unique_ptr<Ring>( new Ring( 2*ring.capacity() ) ) );
+                Ring* const result = m_rings.back().get();
+                for( int64_t i = top; i < bottom; ++i ) {
+                    result->at( i ).store( ring.at( i ).load( memory_order_relaxed ), memory_order_relaxed );
+                }
+                return result;
+            }
+
+        public:
+            explicit Work_deque( const int64_t initial_capacity = 256 )
+            {
+                m_rings.push_back( unique_ptr<Ring>( new Ring( initial_capacity ) ) );
+                m_ring.store( m_rings.back().get(), memory_order_relaxed );
+            }
+
+            void push( Task* const task )       // Owner only.
+            {
+                const int64_t bottom = m_bottom.load( memory_order_relaxed );
+                const int64_t top = m_top.load( memory_order_acquire );
+                Ring* ring = m_ring.load( memory_order_relaxed );
+                if( bottom - top > ring->capacity() - 1 ) {
+                    ring = grown( *ring, top, bottom );
+                    m_ring.store( ring, memory_order_release );
+                }
+                ring->at( bottom ).store( task, memory_order_relaxed );
+                m_bottom.store( bottom + 1, memory_order_release );      // As a release fence.
+            }
+
+            auto pop()                          // Owner only.
+                -> Task*
+            {
+                const int64_t bottom = m_bottom.load( memory_order_relaxed ) - 1;
+                Ring* const ring = m_ring.load( memory_order_relaxed );
+                m_bottom.store( bottom, memory_order_relaxed );
+                atomic_thread_fence( memory_order_seq_cst );
+                int64_t top = m_top.load( memory_order_relaxed );
+                if( top > bottom ) {
+                    m_bottom.store( bottom + 1, memory_order_relaxed );
+                    return nullptr;
+                }
+                Task* result = ring->at( bottom ).load( memory_order_relaxed );
+                if( top == bottom ) {       // The last task, which a thief may be stealing.
+                    if( not m_top.compare_exchange_strong(
+                        top, top + 1, memory_order_seq_cst, memory_order_relaxed
+                        ) ) {
+                        result = nullptr;
+                    }
+                    m_bottom.store( bottom + 1, memory_order_relaxed );
+                }
+                return result;
+            }
+
+            auto steal()                        // Any thread.
+                -> Task*
+            {
+                int64_t top = m_top.load( memory_order_acquire );
+                atomic_thread_fence( memory_order_seq_cst );
+                const int64_t bottom = m_bottom.load( memory_order_acquire );
+                if( top >= bottom ) { return nullptr; }
+                Ring* const ring = m_ring.load( memory_order_acquire );
+                Task* const result = ring->at( top ).load( memory_order_relaxed );
+                if( not m_top.compare_exchange_strong(
+                    top, top + 1, memory_order_seq_cst, memory_order_relaxed
+                    ) ) {
+                    return nullptr;         // Lost a race with the owner or another thief.
+                }
+                return result;
+            }
+        };
+    }  // namespace impl::thread_pool
+
+    // A work-stealing thread pool. Each worker thread has a Chase-Lev deque: tasks spawned by a
+    // worker go to the bottom of its own deque and are run from there last in first out, for
+    // cache locality, while idle workers steal the oldest tasks from the top of other deques,
+    // which for recursively split work are the largest pieces. Tasks submitted from other
+    // threads go to a shared queue. Idle workers spin briefly and then sleep.
+    //
+    // Tasks are normally run via a `Task_group`, which provides waiting, cancellation and
+    // exception propagation, or via `parallel_for`.
+    class Thread_pool:
+        public No_copying
+    {
+        friend class Task_group;
+        using Task = impl::thread_pool::Task;
+        using Work_deque = impl::thread_pool::Work_deque;
+
+        struct Worker
+        {
+            Work_deque      deque;
+            uint64_t        random_state;
+            thread          os_thread;
+        };
+
+        vector<unique_ptr<Worker>>  m_workers;
+        mutex                       m_mutex;            // Guards the shared queue and sleeping.
+        condition_variable          m_wakeup;
+        deque<Task*>                m_shared_queue;
+        atomic<int64_t>             m_n_queued          {0};    // In all deques and the queue.
+        atomic<int>                 m_n_sleeping        {0};
+        atomic<bool>                m_is_stopping       {false};
+
+        static inline thread_local Thread_pool*     t_pool          = nullptr;
+        static inline thread_local Worker*          t_worker        = nullptr;
+
+        static void run( Task* task );      // Defined after `Task_group`.
+
+        void wake_a_sleeper()
+        {
+            if( m_n_sleeping.load( memory_order_seq_cst ) > 0 ) {
+                unique_lock<mutex> lock( m_mutex );
+                m_wakeup.notify_one();
+            }
+        }
+
+        void push( Task* const task )
+        {
+            if( t_pool == this ) {
+                t_worker->deque.push( task );
+            } else {
+                unique_lock<mutex> lock( m_mutex );
+                m_shared_queue.push_back( task );
+            }
+            m_n_queued.fetch_add( 1, memory_order_seq_cst );
+            wake_a_sleeper();
+        }
+
+        auto steal_from_a_random_worker( uint64_t& random_state )
+            -> Task*
+        {
+            const int n = int( m_workers.size() );
+            random_state ^= random_state << 13;  random_state ^= random_state >> 7;
+            random_state ^= random_state << 17;     // Marsaglia’s xorshift64.
+            const int first = int( random_state % unsigned( n ) );
+            for( int i = 0; i < n; ++i ) {
+                Worker& victim = *m_workers[(first + i) % n];
+                if( &victim == t_worker ) { continue; }
+                if( Task* const task = victim.deque.steal() ) { return task; }
+            }
+            return nullptr;
+        }
+
+        auto take_from_shared_queue()
+            -> Task*
+        {
+            unique_lock<mutex> lock( m_mutex );
+            if( m_shared_queue.empty() ) { return nullptr; }
+            Task* const result = m_shared_queue.front();
+            m_shared_queue.pop_front();
+            return result;
+        }
+
+        // Own deque first, then other workers’ deques, then the shared queue.
+        auto find_task( uint64_t& random_state )
+            -> Task*
+        {
+            if( m_n_queued.load( memory_order_relaxed ) == 0 ) { return nullptr; }
+            Task* task = (t_pool == this? t_worker->deque.pop() : nullptr);
+            if( not task ) { task = steal_from_a_random_worker( random_state ); }
+            if( not task ) { task = take_from_shared_queue(); }
+            if( task ) { m_n_queued.fetch_sub( 1, memory_order_relaxed ); }
+            return task;
+        }
+
+        void serve( Worker& worker )
+        {
+            t_pool = this;
+            t_worker = &worker;
+            int n_idle_rounds = 0;
+            while( not m_is_stopping.load( memory_order_relaxed ) ) {
+                if( Task* const task = find_task( worker.random_state ) ) {
+                    run( task );
+                    n_idle_rounds = 0;
+                } else if( ++n_idle_rounds < 64 ) {
+                    std::this_thread::yield();
+                } else {
+                    unique_lock<mutex> lock( m_mutex );
+                    m_n_sleeping.fetch_add( 1, memory_order_seq_cst );
+                    m_wakeup.wait( lock, [this]{
+                        return m_n_queued.load( memory_order_seq_cst ) > 0
+                            or m_is_stopping.load( memory_order_relaxed );
+                    } );
+                    m_n_sleeping.fetch_sub( 1, memory_order_relaxed );
+                    n_idle_rounds = 0;
+                }
+            }
+            t_pool = nullptr;
+            t_worker = nullptr;
+        }
+
+        // For a thread waiting for a task group: runs one task, if any can be found.
+        auto try_to_run_a_task()
+            -> bool
+        {
+            static thread_local uint64_t random_state = 0x9E3779B97F4A7C15u;
+            Task* const task = find_task( t_pool == this? t_worker->random_state : random_state );
+            if( not task ) { return false; }
+            run( task );
+            return true;
+        }
+
+    public:
+        explicit Thread_pool( const int n_threads = max( 1, int( thread::hardware_concurrency() ) ) )
+        {
+            assert( n_threads >= 1 );
+            for( int i = 0; i < n_threads; ++i ) {
+                m_workers.push_back( unique_ptr<Worker>( new Worker{ Work_deque(), 0x9E3779B97F4A7C15u*(i + 1), {} } ) );
+            }
+            for( const unique_ptr<Worker>& p_worker: m_workers ) {
+                Worker& worker = *p_worker;
+                worker.os_thread = thread( [this, &worker]{ serve( worker ); } );
+            }
+        }
+
+        // Should be destroyed after all task groups have been waited for.
+        ~Thread_pool()
+        {
+            {
+                unique_lock<mutex> lock( m_mutex );
+                m_is_stopping = true;
+            }
+            m_wakeup.notify_all();
+            for( const unique_ptr<Worker>& p_worker: m_workers ) { p_worker->os_thread.join(); }
+        }
+
+        auto n_threads() const -> int { return int( m_workers.size() ); }
+
+        // A pool with a thread per hardware thread, created on first use.
+        static auto shared()
+            -> Thread_pool&
+        {
+            static Thread_pool the_pool;
+            return the_pool;
+        }
+    };
+
+    // A set of tasks run in a `Thread_pool`, that can be waited for and cancelled. Cancelling
+    // makes tasks that haven’t started yet do nothing; running tasks can poll `is_cancelled`.
+    // The first exception thrown by a task cancels the group and is rethrown by `wait`.
+    class Task_group:
+        public No_copying
+    {
+        friend class Thread_pool;
+
+        Thread_pool&        m_pool;
+        atomic<int64_t>     m_n_unfinished      {0};
+        atomic<bool>        m_is_cancelled      {false};
+        mutex               m_exception_mutex;
+        exception_ptr       m_exception;
+
+        void run_task_work( function<void()>& work )
+        {
+            if( not m_is_cancelled.load( memory_order_relaxed ) ) {
+                try {
+                    work();
+                } catch( ... ) {
+                    unique_lock<mutex> lock( m_exception_mutex );
+                    if( not m_exception ) { m_exception = current_exception(); }
+                    m_is_cancelled = true;
+                }
+            }
+            m_n_unfinished.fetch_sub( 1, memory_order_release );
+        }
+
+        void wait_without_rethrow()
+        {
+            int n_idle_rounds = 0;
+            while( m_n_unfinished.load( memory_order_acquire ) > 0 ) {
+                if( m_pool.try_to_run_a_task() ) {
+                    n_idle_rounds = 0;
+                } else if( ++n_idle_rounds > 16 ) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    public:
+        explicit Task_group( Thread_pool& pool = Thread_pool::shared() ): m_pool( pool ) {}
+        ~Task_group() { wait_without_rethrow(); }
+
+        auto pool() const -> Thread_pool& { return m_pool; }
+
+        template< class Func >
+        void run( Func&& f )
+        {
+            m_n_unfinished.fetch_add( 1, memory_order_relaxed );
+            m_pool.push( new impl::thread_pool::Task{ function<void()>( std::forward<Func>( f ) ), this } );
+        }
+
+        void cancel() { m_is_cancelled = true; }
+        auto is_cancelled() const -> bool { return m_is_cancelled.load( memory_order_relaxed ); }
+
+        // Waits for all tasks, helping to run tasks meanwhile, then rethrows any task exception.
+        void wait()
+        {
+            wait_without_rethrow();
+            if( m_exception ) { rethrow_exception( std::exchange( m_exception, nullptr ) ); }
+        }
+    };
+
+    inline void Thread_pool::run( Task* const task )
+    {
+        const unique_ptr<Task> owner( task );
+        task->group->run_task_work( task->work );
+    }
+
+    // Calls `f( Range )` for disjoint subranges that together cover `range`, each at most
+    // `grain_size` values, in parallel. The range is split in halves recursively, so that a
+    // thief steals large pieces. Returns when all calls have returned; rethrows any exception.
+    template< class Func >
+    void parallel_for( Task_group& group, const Range& range, const int grain_size, const Func& f )
+    {
+        assert( grain_size >= 1 );
+        struct Splitter
+        {
+            Task_group&     group;
+            int             grain_size;
+            const Func&     f;
+
+            void operator()( Range r ) const
+            {
+                while( r.last - r.first + 1 > grain_size and not group.is_cancelled() ) {
+                    const int middle = r.first + (r.last - r.first)/2;
+                    const Splitter self = *this;
+                    group.run( [self, upper = Range{ middle + 1, r.last }]{ self( upper ); } );
+                    r.last = middle;
+                }
+                if( not group.is_cancelled() ) { f( r ); }
+            }
+        };
+        if( range.last < range.first ) { return; }
+        const Splitter splitter = { group, grain_size, f };
+        group.run( [&splitter, range]{ splitter( range ); } );     // So that `f` throwing is handled.
+        group.wait();
+    }
+
+    template< class Func >
+    void parallel_for( const Range& range, const int grain_size, const Func& f )
+    {
+        Task_group group;
+        parallel_for( group, range, grain_size, f );
+    }
+}  // namespace cpp::util
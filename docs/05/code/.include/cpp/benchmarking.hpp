@@ -0,0 +1,268 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>     // CPPUTIL_FAIL, cpp::util::(hopefully, No_copying)
+
+#include <limits.h>         // INT_MAX
+#include <math.h>           // sqrt
+#include <stdint.h>         // int64_t
+#include <stdio.h>          // snprintf
+#include <stdlib.h>         // strtod, strtol
+
+#include <algorithm>        // std::(max, min, sort)
+#include <chrono>           // std::chrono::*
+#include <string>           // std::string
+#include <string_view>      // std::string_view
+#include <utility>          // std::move
+#include <vector>           // std::vector
+
+#ifdef _MSC_VER
+#   include <intrin.h>      // _ReadWriteBarrier
+#endif
+
+// A small micro-benchmark runner: warmup, an iteration count per sample calibrated to a
+// minimum sample time, a number of samples, and mean, median, standard deviation, min and
+// max of the time per iteration, reported as text, CSV or JSON. E.g.
+//
+//      bm::Runner runner( bm::options_from( n_args, args ) );
+//      runner.run( "random_in", []{ bm::do_not_optimize( cu::random_in({ 1, 6 }) ); } );
+//      fputs( runner.report().c_str(), stdout );
+//
+// The function passed to `run` does one iteration; it should pass its result to
+// `do_not_optimize`, so that the compiler can’t remove the work.
+namespace cpp::util::benchmarking {
+    namespace chr = std::chrono;
+    using   std::max, std::min, std::sort,
+            std::string,
+            std::string_view,
+            std::move,
+            std::vector;
+
+    // Makes the compiler assume that `value` is read, and for a non-const `value` also written.
+    #ifdef _MSC_VER
+        namespace impl { inline const volatile void* volatile the_sink; }
+
+        template< class T >
+        inline void do_not_optimize( const T& value )
+        {
+            impl::the_sink = &value;
+            _ReadWriteBarrier();
+        }
+
+        inline void clobber_memory() { _ReadWriteBarrier(); }
+    #else
+        template< class T >
+        inline void do_not_optimize( const T& value ) { asm volatile( "" : : "m"( value ) : "memory" ); }
+
+        template< class T >
+        inline void do_not_optimize( T& value ) { asm volatile( "" : "+m"( value ) : : "memory" ); }
+
+        // Makes the compiler assume that all memory is read and written.
+        inline void clobber_memory() { asm volatile( "" : : : "memory" ); }
+    #endif
+
+    struct Format{ enum Enum{ text, csv, json }; };
+
+    struct Options
+    {
+        double          warmup_seconds      = 0.05;
+        double          sample_seconds      = 0.01;     // Minimum time per sample.
+        int             n_samples           = 15;
+        string          filter              = "";       // Runs only names containing this.
+        Format::Enum    format              = Format::text;
+    };
+
+    // Times per iteration, in nanoseconds.
+    struct Result
+    {
+        string      name;
+        int64_t     iterations_per_sample;
+        int         n_samples;
+        double      mean_ns;
+        double      median_ns;
+        double      stddev_ns;
+        double      min_ns;
+        double      max_ns;
+    };
+
+    // Recognizes `--format text|csv|json`, `--filter` substring, `--min-time` seconds per
+    // sample and `--samples` count, an integer ≥ 1.
+    inline auto options_from( const int n_args, char** args )
+        -> Options
+    {
+        Options result;
+        for( int i = 1; i < n_args; ++i ) {
+            const string_view name = args[i];
+            hopefully( i + 1 < n_args ) or CPPUTIL_FAIL( "Missing value for option " + string( name ) + "." );
+            const string_view value = args[++i];
+            const auto number = [&]() -> double
+            {
+                const double v = strtod( value.data(), nullptr );
+                hopefully( v > 0 ) or CPPUTIL_FAIL( "Option " + string( name ) + " needs a positive number." );
+                return v;
+            };
+            const auto count = [&]() -> int
+            {
+                char* p_end = nullptr;
+                const long v = strtol( value.data(), &p_end, 10 );
+                hopefully( p_end != value.data() and *p_end == '\0' and 1 <= v and v <= INT_MAX )
+                    or CPPUTIL_FAIL( "Option " + string( name ) + " needs a positive integer." );
+                return int( v );
+            };
+            if( name == "--format" ) {
+                if(      value == "text" )  { result.format = Format::text; }
+                else if( value == "csv" )   { result.format = Format::csv; }
+                else if( value == "json" )  { result.format = Format::json; }
+                else { CPPUTIL_FAIL( "Unknown format “" + string( value ) + "”; use text, csv or json." ); }
+            }
+            else if( name == "--filter" )       { result.filter = value; }
+            else if( name == "--min-time" )     { result.sample_seconds = number(); }
+            else if( name == "--samples" )      { result.n_samples = count(); }
+            else { CPPUTIL_FAIL( "Unknown option “" + string( name ) + "”." ); }
+        }
+        return result;
+    }
+
+    class Runner:
+        public No_copying
+    {
+        Options             m_options;
+        vector<Result>      m_results;
+
+        template< class Func >
+        static auto seconds_for( const int64_t n_iterations, Func& f )
+            -> double
+        {
+            const auto start = chr::steady_clock::now();
+            for( int64_t i = 0; i < n_iterations; ++i ) { f(); }
+            return chr::duration<double>( chr::steady_clock::now() - start ).count();
+        }
+
+        static auto summary_of( string name, const int64_t n_iterations, vector<double> ns )
+            -> Result
+        {
+            const int n = int( ns.size() );
+            double sum = 0;
+            for( const double v: ns ) { sum += v; }
+            const double mean = sum/n;
+            double sum_of_squares = 0;
+            for( const double v: ns ) { sum_of_squares += (v - mean)*(v - mean); }
+            sort( ns.begin(), ns.end() );
+            const double median = (n % 2 == 1? ns[n/2] : (ns[n/2 - 1] + ns[n/2])/2);
+            return {
+                move( name ), n_iterations, n,
+                mean, median, (n > 1? sqrt( sum_of_squares/(n - 1) ) : 0.0), ns.front(), ns.back()
+            };
+        }
+
+        // JSON and CSV names are quoted; quotes and backslashes in names are escaped.
+        static auto quoted( const string& s, const char escape )
+            -> string
+        {
+            string result = "\"";
+            for( const char ch: s ) {
+                if( ch == '"' or (escape == '\\' and ch == '\\') ) { result += escape; }
+                result += ch;
+            }
+            return result + "\"";
+        }
+
+    public:
+        Runner(): Runner( Options() ) {}
+        explicit Runner( const Options& options ):
+            m_options( options )
+        {
+            hopefully( options.n_samples >= 1 ) or CPPUTIL_FAIL( "A benchmark needs at least 1 sample." );
+        }
+
+        auto options() const -> const Options& { return m_options; }
+        auto results() const -> const vector<Result>& { return m_results; }
+
+        // Warms up while increasing the number of iterations per sample until a sample takes at
+        // least `sample_seconds`, then measures `n_samples` samples.
+        template< class Func >
+        void run( const string& name, Func&& f )
+        {
+            if( name.find( m_options.filter ) == string::npos ) { return; }
+            const auto warmup_end = chr::steady_clock::now() + chr::duration<double>( m_options.warmup_seconds );
+            int64_t n_iterations = 1;
+            for( ;; ) {
+                const double seconds = seconds_for( n_iterations, f );
+                const bool is_calibrated = (seconds >= m_options.sample_seconds);
+                if( is_calibrated and chr::steady_clock::now() >= warmup_end ) { break; }
+                if( not is_calibrated ) {
+                    // Grows at least 2× and at most 10× per round, aiming at 1.2× the sample time.
+                    const double wanted = 1.2*m_options.sample_seconds/max( seconds, 1e-9 );
+                    n_iterations = int64_t( double( n_iterations )*min( 10.0, max( 2.0, wanted ) ) );
+                }
+            }
+            vector<double> ns_per_iteration;
+            for( int i = 0; i < m_options.n_samples; ++i ) {
+                ns_per_iteration.push_back( 1e9*seconds_for( n_iterations, f )/double( n_iterations ) );
+            }
+            m_results.push_back( summary_of( name, n_iterations, move( ns_per_iteration ) ) );
+        }
+
+        auto as_text() const
+            -> string
+        {
+            string result;
+            char line[256];
+            snprintf( line, sizeof( line ), "%-40s %12s %12s %10s %12s %12s %12s\n",
+                "Benchmark", "median ns", "mean ns", "stddev %", "min ns", "max ns", "iterations"
+                );
+            result += line;
+            for( const Result& r: m_results ) {
+                snprintf( line, sizeof( line ), "%-40s %12.2f %12.2f %10.2f %12.2f %12.2f %12lld\n",
+                    r.name.c_str(), r.median_ns, r.mean_ns, 100*r.stddev_ns/r.mean_ns,
+                    r.min_ns, r.max_ns, (long long) r.iterations_per_sample
+                    );
+                result += line;
+            }
+            return result;
+        }
+
+        auto as_csv() const
+            -> string
+        {
+            string result = "name,median_ns,mean_ns,stddev_ns,min_ns,max_ns,iterations,samples\n";
+            char fields[192];
+            for( const Result& r: m_results ) {
+                snprintf( fields, sizeof( fields ), ",%.3f,%.3f,%.3f,%.3f,%.3f,%lld,%d\n",
+                    r.median_ns, r.mean_ns, r.stddev_ns, r.min_ns, r.max_ns,
+                    (long long) r.iterations_per_sample, r.n_samples
+                    );
+                result += quoted( r.name, '"' ) + fields;
+            }
+            return result;
+        }
+
+        auto as_json() const
+            -> string
+        {
+            string result = "[";
+            char fields[256];
+            for( const Result& r: m_results ) {
+                snprintf( fields, sizeof( fields ),
+                    "\"median_ns\": %.3f, \"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, "
+                    "\"max_ns\": %.3f, \"iterations\": %lld, \"samples\": %d",
+                    r.median_ns, r.mean_ns, r.stddev_ns, r.min_ns, r.max_ns,
+                    (long long) r.iterations_per_sample, r.n_samples
+                    );
+                result += string( result.size() == 1? "\n" : ",\n" )
+                    + "    {\"name\": " + quoted( r.name, '\\' ) + ", " + fields + "}";
+            }
+            return result + "\n]\n";
+        }
+
+        // In the format of the options.
+        auto report() const
+            -> string
+        {
+            switch( m_options.format ) {
+                case Format::text:  return as_text();
+                case Format::csv:   return as_csv();
+                case Format::json:  return as_json();
+            }
+            return "";
+        }
+    };
+}  // namespace cpp::util::benchmarking
@@ -0,0 +1,102 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/util.hpp>     // CPPUTIL_ERROR, cpp::util::(int_size, Result_)
+
+#include <stdint.h>         // uint8_t, uint32_t
+
+#include <string>           // std::(string, u16string)
+#include <string_view>      // std::(string_view, u16string_view)
+#include <utility>          // std::move
+
+// Portable UTF-8 ⇄ UTF-16 conversion, e.g. for code that is also built and tested outside
+// Windows, where `winapi::kernel::to_utf16` isn’t available. Invalid input, i.e. overlong or
+// truncated UTF-8 sequences, encoded surrogates, values above U+10FFFF and unpaired UTF-16
+// surrogates, is reported as an error with the offending position as code.
+namespace cpp::util {
+    using   std::string, std::u16string,
+            std::string_view, std::u16string_view,
+            std::move;
+
+    inline auto try_utf16_from_utf8( const string_view& s, u16string result_buffer = {} )
+        -> Result_<u16string>
+    {
+        result_buffer.resize( s.size() );   // At most one UTF-16 value per byte.
+        char16_t* p_out = result_buffer.data();
+        const auto p_bytes = reinterpret_cast<const uint8_t*>( s.data() );
+        const int n = int_size( s );
+        int i = 0;
+        while( i < n ) {
+            const uint8_t lead = p_bytes[i];
+            if( lead < 0x80 ) {
+                *p_out++ = lead;  ++i;
+                continue;
+            }
+            const int n_continuation = (lead >= 0xF0? 3 : lead >= 0xE0? 2 : lead >= 0xC2? 1 : -1);
+            if( n_continuation < 0 or lead > 0xF4 or i + n_continuation >= n ) {
+                return CPPUTIL_ERROR( i, "Invalid or truncated UTF-8 sequence" );
+            }
+            uint32_t code = lead & (0x3F >> n_continuation);
+            for( int j = 1; j <= n_continuation; ++j ) {
+                const uint8_t byte = p_bytes[i + j];
+                if( (byte & 0xC0) != 0x80 ) { return CPPUTIL_ERROR( i, "Invalid UTF-8 continuation byte" ); }
+                code = (code << 6) | (byte & 0x3F);
+            }
+            const uint32_t lowest_for_length[] = { 0, 0x80, 0x800, 0x10000 };
+            const bool is_surrogate = (0xD800 <= code and code <= 0xDFFF);
+            if( code < lowest_for_length[n_continuation] or is_surrogate or code > 0x10FFFF ) {
+                return CPPUTIL_ERROR( i, "Overlong UTF-8 sequence or invalid code point" );
+            }
+            if( code < 0x10000 ) {
+                *p_out++ = char16_t( code );
+            } else {
+                code -= 0x10000;
+                *p_out++ = char16_t( 0xD800 + (code >> 10) );
+                *p_out++ = char16_t( 0xDC00 + (code & 0x3FF) );
+            }
+            i += 1 + n_continuation;
+        }
+        result_buffer.resize( size_t( p_out - result_buffer.data() ) );
+        return result_buffer;
+    }
+
+    inline auto try_utf8_from_utf16( const u16string_view& s, string result_buffer = {} )
+        -> Result_<string>
+    {
+        result_buffer.resize( 3*s.size() );     // At most 3 bytes per UTF-16 value.
+        char* p_out = result_buffer.data();
+        const int n = int_size( s );
+        for( int i = 0; i < n; ++i ) {
+            uint32_t code = s[i];
+            if( 0xD800 <= code and code <= 0xDFFF ) {
+                const bool is_pair = (code <= 0xDBFF and i + 1 < n and 0xDC00 <= s[i + 1] and s[i + 1] <= 0xDFFF);
+                if( not is_pair ) { return CPPUTIL_ERROR( i, "Unpaired UTF-16 surrogate" ); }
+                code = 0x10000 + ((code - 0xD800) << 10) + (s[i + 1] - 0xDC00u);
+                ++i;
+            }
+            if( code < 0x80 ) {
+                *p_out++ = char( code );
+            } else if( code < 0x800 ) {
+                *p_out++ = char( 0xC0 | (code >> 6) );
+                *p_out++ = char( 0x80 | (code & 0x3F) );
+            } else if( code < 0x10000 ) {
+                *p_out++ = char( 0xE0 | (code >> 12) );
+                *p_out++ = char( 0x80 | ((code >> 6) & 0x3F) );
+                *p_out++ = char( 0x80 | (code & 0x3F) );
+            } else {
+                *p_out++ = char( 0xF0 | (code >> 18) );
+                *p_out++ = char( 0x80 | ((code >> 12) & 0x3F) );
+                *p_out++ = char( 0x80 | ((code >> 6) & 0x3F) );
+                *p_out++ = char( 0x80 | (code & 0x3F) );
+            }
+        }
+        result_buffer.resize( size_t( p_out - result_buffer.data() ) );
+        return result_buffer;
+    }
+
+    inline auto utf16_from_utf8( const string_view& s, u16string result_buffer = {} )
+        -> u16string
+    { return try_utf16_from_utf8( s, move( result_buffer ) ).or_throw(); }
+
+    inline auto utf8_from_utf16( const u16string_view& s, string result_buffer = {} )
+        -> string
+    { return try_utf8_from_utf16( s, move( result_buffer ) ).or_throw(); }
+}  // namespace cpp::util
@@ -1,25 +1,37 @@
 ﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
 
 #include <assert.h>         // assert
+#include <stddef.h>         // size_t
 #include <functional>       // std::reference_wrapper
+#include <initializer_list> // std::initializer_list
 #include <iterator>         // std::size
 #include <random>           // std::(random_device, mt19937, uniform_int_distribution)
 #include <stdexcept>        // std::(exception, runtime_error)
 #include <string>           // std::string
-#include <type_traits>      // std::(enable_if_t, is_same_v)
+#include <type_traits>      // std::(conditional_t, enable_if_t, is_same_v)
+#include <utility>          // std::(index_sequence, index_sequence_for, in_place_index, move)
+#include <variant>          // std::(get_if, variant)
 
 #define CPPUTIL_FAIL( s ) ::cpp::util::fail( std::string( __func__ ) + " - " + (s) )
 
 #define CPPUTIL_WITH( name, initializer ) \
     if( auto&& name = initializer; ((void) name, true) )
 
+// C++17 has no `std::source_location`, hence macros. The message must be a string literal.
+#define CPPUTIL_SOURCE_LOCATION ::cpp::util::Source_location{ __FILE__, __LINE__, __func__ }
+#define CPPUTIL_ERROR( code, message ) \
+    ::cpp::util::Error{ (code), "" message, CPPUTIL_SOURCE_LOCATION }
+
 namespace cpp::util {
     using   std::reference_wrapper,
             std::size,
             std::random_device, std::mt19937, std::uniform_int_distribution,
             std::exception, std::runtime_error,
             std::string,
-            std::enable_if_t, std::is_same_v;
+            std::conditional_t, std::enable_if_t, std::is_same_v,
+            std::index_sequence, std::index_sequence_for, std::in_place_index, std::move,
+            std::get_if, std::variant,
+            std::initializer_list;
 
     constexpr auto utf8_is_the_execution_character_set()
         -> bool
@@ -39,6 +51,76 @@ namespace cpp::util {
         >
     inline auto operator>>( Success, const Value v ) -> bool { return v; }
 
+    struct Source_location
+    {
+        const char*     file;
+        int             line;
+        const char*     function;
+    };
+
+    // A failure description that can be created and passed around without allocation, e.g.
+    // in a loop that only tests a condition. `code` is e.g. a `GetLastError` value, or 0.
+    struct Error
+    {
+        int                 code;
+        const char*         message;        // Static, e.g. a literal.
+        Source_location     where;
+
+        // As the `CPPUTIL_FAIL` message, plus any code.
+        auto text() const
+            -> string
+        {
+            string result = string( where.function ) + " - " + message;
+            if( code != 0 ) { result += " (code " + std::to_string( code ) + ")"; }
+            return result;
+        }
+    };
+
+    // A value or an `Error`, expected-style. Use `or_throw()` to bridge to the exception based
+    // `hopefully(...) or fail(...)` idiom, which it throws as, i.e. with a `runtime_error`.
+    template< class Value >
+    class [[nodiscard]] Result_
+    {
+        variant<Value, Error>   m_state;
+
+    public:
+        Result_( Value v ): m_state( in_place_index<0>, move( v ) ) {}
+        Result_( const Error& e ): m_state( in_place_index<1>, e ) {}
+
+        auto is_ok() const -> bool { return m_state.index() == 0; }
+        explicit operator bool() const { return is_ok(); }
+
+        auto value() const -> const Value& { assert( is_ok() ); return *get_if<0>( &m_state ); }
+        auto value() -> Value& { assert( is_ok() ); return *get_if<0>( &m_state ); }
+        auto error() const -> const Error& { assert( not is_ok() ); return *get_if<1>( &m_state ); }
+
+        auto or_throw() &&
+            -> Value
+        {
+            hopefully( is_ok() ) or fail( error().text() );
+            return move( value() );
+        }
+    };
+
+    template<>
+    class [[nodiscard]] Result_<void>
+    {
+        Error       m_error     = {};
+        bool        m_is_ok     = true;
+
+    public:
+        Result_() {}
+        Result_( const Error& e ): m_error( e ), m_is_ok( false ) {}
+
+        auto is_ok() const -> bool { return m_is_ok; }
+        explicit operator bool() const { return is_ok(); }
+        auto error() const -> const Error& { assert( not is_ok() ); return m_error; }
+
+        void or_throw() const { hopefully( is_ok() ) or fail( error().text() ); }
+    };
+
+    using Status = Result_<void>;
+
     struct No_copying
     {
         No_copying( const No_copying& ) = delete;
@@ -91,29 +173,42 @@ namespace cpp::util {
     };
         
     namespace impl::types {
-        // Logic to find the index of the first T in a list of types, or -1 if none.
-
-        constexpr auto successor_if_not_negative( const int v ) -> int { return (v < 0? v : 1 + v); }
-
-        template< template <class> class Is_match_, class... Args > struct First_match_;
-        
-        template< template <class> class Is_match_ > struct First_match_< Is_match_> { enum{ index = -1 }; };
-
-        template< template <class> class Is_match_, class First, class... More_args >
-        struct First_match_< Is_match_, First, More_args... >
+        // Logic to find the index of the first true value, or -1 if none. A linear scan in a
+        // constexpr function instantiates no templates, as opposed to recursion over the types.
+        constexpr auto index_of_first_true( const initializer_list<bool> values )
+            -> int
         {
-            enum
-            { index = Is_match_< First >::value
-                ? 0
-                : successor_if_not_negative( First_match_< Is_match_, More_args... >::index )
-            };
-        };
+            int i = 0;
+            for( const bool value: values ) {
+                if( value ) { return i; }
+                ++i;
+            }
+            return -1;
+        }
+
+        template< class U, class... Types >
+        constexpr bool is_one_of_ = (... or is_same_v< U, Types >);
 
         template< class T, class... Args >
-        constexpr int index_of_first_ = First_match_< Is_one_of_<T>::template Result_, Args... >::index;
+        constexpr int index_of_first_ = index_of_first_true({ is_same_v< T, Args >... });
 
         template< template<class> class Is_match_, class... Args >
-        constexpr int index_of_first_match_ = First_match_< Is_match_, Args... >::index;
+        constexpr int index_of_first_match_ = index_of_first_true({ Is_match_< Args >::value... });
+
+        // Type selection by index via overload resolution against bases, without recursion.
+        template< size_t i, class T > struct Indexed_ {};
+
+        template< class Indices, class... Types > struct Indexed_types_;
+
+        template< size_t... indices, class... Types >
+        struct Indexed_types_< index_sequence< indices... >, Types... >:
+            Indexed_< indices, Types >...
+        {};
+
+        template< size_t i, class T >
+        auto type_at_( const Indexed_< i, T >& ) -> T;   // Only for `decltype`.
+
+        template< template<class> class Predicate_, class... Types > struct Filtered_;
     }  // namespace impl::types
 
     template< class... Types >
@@ -129,9 +224,38 @@ namespace cpp::util {
 
         template< class... T >
         static constexpr int index_of_first_of_ =
-            impl::types::index_of_first_match_< Is_one_of_<T...>::template Result_, Types... >;
+            impl::types::index_of_first_true({ impl::types::is_one_of_< Types, T... >... });
+
+        template< int i >
+        using at_ = decltype( impl::types::type_at_< i >(
+            impl::types::Indexed_types_< index_sequence_for< Types... >, Types... >()
+            ) );
+
+        // `Fn_<T>` is the result type for T, e.g. with `Fn_` = `std::add_pointer_t`.
+        template< template<class> class Fn_ >
+        using transform_ = Types_< Fn_< Types >... >;
+
+        // The types T with `Predicate_<T>::value` true, e.g. with `Predicate_` = `std::is_pointer`.
+        template< template<class> class Predicate_ >
+        using filter_ = typename impl::types::Filtered_< Predicate_, Types... >::Result;
     };
 
+    namespace impl::types {
+        // Concatenation, as the operator of a fold expression over types.
+        template< class... Types, class... More >
+        constexpr auto operator+( Types_< Types... >, Types_< More... > )
+            -> Types_< Types..., More... >
+        { return {}; }
+
+        template< template<class> class Predicate_, class... Types >
+        struct Filtered_
+        {
+            using Result = decltype( (Types_<>() + ... +
+                conditional_t< Predicate_< Types >::value, Types_< Types >, Types_<> >()
+                ) );
+        };
+    }  // namespace impl::types
+
     template< class T, class Arg >
     constexpr auto is_of_type_( Arg ) -> bool { return is_same_v< T, Arg >; }
 
@@ -0,0 +1,67 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <math.h>           // cos, sin
+
+// A 2D affine transform with the members and conventions of the GDI `XFORM` that
+// `SetWorldTransform` takes, so that a transform can be given to either, but applied to
+// coordinates in portable code, e.g. once per shape by the `raster` shape rasterizers.
+namespace raster {
+    struct Vec2{ double x; double y; };
+
+    // Maps (x, y) to (x*m11 + y*m21 + dx, x*m12 + y*m22 + dy), as `XFORM` with `eM11` etc.
+    struct Affine
+    {
+        double  m11;
+        double  m12;
+        double  m21;
+        double  m22;
+        double  dx;
+        double  dy;
+
+        static constexpr auto identity() -> Affine { return {1, 0, 0, 1, 0, 0}; }
+        static constexpr auto translation( const double x, const double y ) -> Affine { return {1, 0, 0, 1, x, y}; }
+        static constexpr auto scaling( const double sx, const double sy ) -> Affine { return {sx, 0, 0, sy, 0, 0}; }
+
+        // Clockwise on the screen with y downwards, as GDI’s `MM_TEXT` mapping mode.
+        static auto rotation( const double radians )
+            -> Affine
+        {
+            const double c = cos( radians );
+            const double s = sin( radians );
+            return {c, s, -s, c, 0, 0};
+        }
+
+        auto determinant() const -> double { return m11*m22 - m12*m21; }
+
+        auto applied_to( const Vec2& p ) const
+            -> Vec2
+        { return {p.x*m11 + p.y*m21 + dx, p.x*m12 + p.y*m22 + dy}; }
+
+        // Only the linear part, e.g. for a direction or an offset.
+        auto linearly_applied_to( const Vec2& v ) const
+            -> Vec2
+        { return {v.x*m11 + v.y*m21, v.x*m12 + v.y*m22}; }
+
+        // This transform followed by `other`, as GDI `CombineTransform( &result, this, &other )`.
+        auto then( const Affine& other ) const
+            -> Affine
+        {
+            return {
+                m11*other.m11 + m12*other.m21,  m11*other.m12 + m12*other.m22,
+                m21*other.m11 + m22*other.m21,  m21*other.m12 + m22*other.m22,
+                dx*other.m11 + dy*other.m21 + other.dx,  dx*other.m12 + dy*other.m22 + other.dy
+            };
+        }
+
+        // Requires a non-zero determinant.
+        auto inverse() const
+            -> Affine
+        {
+            const double d = determinant();
+            const double i11 = m22/d;
+            const double i12 = -m12/d;
+            const double i21 = -m21/d;
+            const double i22 = m11/d;
+            return { i11, i12, i21, i22, -(dx*i11 + dy*i21), -(dx*i12 + dy*i22) };
+        }
+    };
+}  // namespace raster
@@ -0,0 +1,152 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <assert.h>         // assert
+#include <stddef.h>         // ptrdiff_t, size_t
+#include <stdint.h>         // uint8_t, uint32_t
+
+#include <algorithm>        // std::(max, min)
+#include <vector>           // std::vector
+
+// Portable 32-bit pixel memory access, for software rendering that doesn’t call GDI and so can
+// be built, tested and benchmarked also outside Windows. A pixel is a `uint32_t` 0xAARRGGBB,
+// i.e. the byte order B, G, R, A of a 32-bit DIB section. `winapi::gdi::Bitmap_32::pixels()`
+// gives a view of a DIB section’s memory without copying.
+namespace raster {
+    using   std::max, std::min,
+            std::vector;
+
+    using Pixel = uint32_t;
+
+    constexpr auto rgb( const int r, const int g, const int b, const int alpha = 255 )
+        -> Pixel
+    { return Pixel( alpha ) << 24 | Pixel( r ) << 16 | Pixel( g ) << 8 | Pixel( b ); }
+
+    // A GDI `COLORREF` is 0x00BBGGRR, e.g. a `winapi::gdi::color_names` value.
+    constexpr auto pixel_from_colorref( const uint32_t colorref )
+        -> Pixel
+    { return rgb( colorref & 0xFF, (colorref >> 8) & 0xFF, (colorref >> 16) & 0xFF ); }
+
+    struct Point{ int x; int y; };
+
+    // As a GDI `RECT`: `right` and `bottom` are beyond the rectangle.
+    struct Rect
+    {
+        int     left;
+        int     top;
+        int     right;
+        int     bottom;
+
+        auto width() const -> int { return right - left; }
+        auto height() const -> int { return bottom - top; }
+        auto is_empty() const -> bool { return right <= left or bottom <= top; }
+    };
+
+    inline auto intersection_of( const Rect& a, const Rect& b )
+        -> Rect
+    { return { max( a.left, b.left ), max( a.top, b.top ), min( a.right, b.right ), min( a.bottom, b.bottom ) }; }
+
+    struct Row_order{ enum Enum{ top_down, bottom_up }; };
+
+    // Non-owning. Row y, counted from the top, starts at `p_top_row + y*stride`, so for bottom-up
+    // memory such as a DIB section with positive `biHeight` the stride is negative.
+    class Pixel_view_32
+    {
+        struct Address_range{ const Pixel* p_first; const Pixel* p_beyond; };
+
+        Pixel*          m_p_top_row     = nullptr;
+        int             m_width         = 0;
+        int             m_height        = 0;
+        ptrdiff_t       m_stride        = 0;    // In pixels.
+
+    public:
+        Pixel_view_32() {}
+
+        Pixel_view_32( Pixel* const p_top_row, const int width, const int height, const ptrdiff_t stride ):
+            m_p_top_row( p_top_row ), m_width( width ), m_height( height ), m_stride( stride )
+        { assert( width >= 0 and height >= 0 ); }
+
+        // `p_memory` is the start of the memory, which is the bottom row for bottom-up order.
+        // `stride_in_bytes` is positive and a multiple of 4.
+        static auto of_memory(
+            void* const                 p_memory,
+            const int                   width,
+            const int                   height,
+            const ptrdiff_t             stride_in_bytes,
+            const Row_order::Enum       row_order
+            ) -> Pixel_view_32
+        {
+            assert( stride_in_bytes % ptrdiff_t( sizeof( Pixel ) ) == 0 );
+            const ptrdiff_t stride = stride_in_bytes/ptrdiff_t( sizeof( Pixel ) );
+            assert( stride >= width );
+            const auto p_start = static_cast<Pixel*>( p_memory );
+            if( row_order == Row_order::top_down or height == 0 ) {
+                return Pixel_view_32( p_start, width, height, stride );
+            }
+            return Pixel_view_32( p_start + (height - 1)*stride, width, height, -stride );
+        }
+
+        auto width() const -> int { return m_width; }
+        auto height() const -> int { return m_height; }
+        auto stride() const -> ptrdiff_t { return m_stride; }
+        auto bounds() const -> Rect { return {0, 0, m_width, m_height}; }
+        auto is_empty() const -> bool { return m_width == 0 or m_height == 0; }
+
+        auto row( const int y ) const
+            -> Pixel*
+        {
+            assert( 0 <= y and y < m_height );
+            return m_p_top_row + y*m_stride;
+        }
+
+        auto at( const int x, const int y ) const
+            -> Pixel&
+        {
+            assert( 0 <= x and x < m_width );
+            return row( y )[x];
+        }
+
+        // The part of this view within `area`, with coordinates relative to `area`’s top left.
+        auto sub( const Rect& area ) const
+            -> Pixel_view_32
+        {
+            const Rect r = intersection_of( area, bounds() );
+            if( r.is_empty() ) { return Pixel_view_32(); }
+            return Pixel_view_32( m_p_top_row + r.top*m_stride + r.left, r.width(), r.height(), m_stride );
+        }
+
+        // Whether the two views may share memory, i.e. whether their address ranges overlap.
+        auto may_overlap( const Pixel_view_32& other ) const
+            -> bool
+        {
+            if( is_empty() or other.is_empty() ) { return false; }
+            const auto range_of = []( const Pixel_view_32& v ) -> Address_range
+            {
+                const Pixel* const p_first = v.row( v.m_stride < 0? v.m_height - 1 : 0 );
+                const Pixel* const p_last = v.row( v.m_stride < 0? 0 : v.m_height - 1 ) + v.m_width;
+                return {p_first, p_last};
+            };
+            const Address_range a = range_of( *this );
+            const Address_range b = range_of( other );
+            return a.p_first < b.p_beyond and b.p_first < a.p_beyond;
+        }
+    };
+
+    // Owning top-down pixel memory, e.g. for tests and off-screen rendering.
+    class Pixel_buffer_32
+    {
+        int             m_width;
+        int             m_height;
+        vector<Pixel>   m_pixels;
+
+    public:
+        Pixel_buffer_32( const int width, const int height, const Pixel initial = 0 ):
+            m_width( width ), m_height( height ), m_pixels( size_t( width )*size_t( height ), initial )
+        {}
+
+        auto width() const -> int { return m_width; }
+        auto height() const -> int { return m_height; }
+        auto data() -> Pixel* { return m_pixels.data(); }
+        auto data() const -> const Pixel* { return m_pixels.data(); }
+
+        auto view() -> Pixel_view_32 { return Pixel_view_32( m_pixels.data(), m_width, m_height, m_width ); }
+    };
+}  // namespace raster
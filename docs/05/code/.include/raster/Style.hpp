@@ -0,0 +1,19 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Pixel_view_32.hpp>     // raster::Pixel
+
+#include <optional>         // std::optional
+
+namespace raster {
+    using std::optional;
+
+    // The pen and brush of GDI shape drawing, as `DC_PEN` and `DC_BRUSH` with the colors set by
+    // `SetDCPenColor` and `SetDCBrushColor`. No pen or no brush is as `NULL_PEN` or `NULL_BRUSH`.
+    // The outline is drawn inside the shape’s boundary, as with `PS_INSIDEFRAME`, which for the
+    // default width 1 is where GDI draws it anyway.
+    struct Style
+    {
+        optional<Pixel>     pen_color;
+        optional<Pixel>     brush_color;
+        double              pen_width       = 1;
+    };
+}  // namespace raster
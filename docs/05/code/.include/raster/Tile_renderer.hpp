@@ -0,0 +1,151 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <cpp/Thread_pool.hpp>          // cpp::util::(parallel_for, Task_group, Thread_pool)
+#include <cpp/util.hpp>                 // cpp::util::Range
+#include <raster/Affine.hpp>            // raster::(Affine, Vec2)
+#include <raster/Pixel_view_32.hpp>     // raster::(Pixel, Pixel_view_32, Point, Rect)
+#include <raster/Style.hpp>             // raster::Style
+#include <raster/ellipses.hpp>          // raster::impl::Ellipse_quadric
+#include <raster/polygons.hpp>          // raster::impl::Convex_polygon
+#include <raster/primitives.hpp>        // raster::fill
+#include <raster/scanline.hpp>          // raster::impl::(draw_convex_shape, Interval)
+
+#include <math.h>           // ceil, floor
+
+#include <algorithm>        // std::(max, min)
+#include <variant>          // std::(variant, visit)
+#include <vector>           // std::vector
+
+// A display list of shapes, and a renderer that draws it with the image split into square
+// tiles, 64×64 pixels by default, so that a tile’s pixels stay in the L1/L2 cache while all the
+// shapes that touch it are drawn. Each shape is binned to the tiles that its bounding box
+// touches, then the tiles are drawn in parallel in a `cpp::util::Thread_pool`, each tile with
+// its shapes in list order. The result is the same as drawing the whole list directly.
+namespace raster {
+    namespace cu = cpp::util;
+    using   std::variant, std::visit;
+
+    // Shapes in drawing order, each set up once when added: transformed to pixel coordinates,
+    // with the inner shape of its outline, and with its pixel bounds.
+    class Display_list
+    {
+    public:
+        template< class Shape >
+        struct Item_
+        {
+            Shape       outer;
+            Shape       inner;
+            Style       style;
+            Rect        bounds;
+        };
+
+        using Item = variant<Item_<impl::Ellipse_quadric>, Item_<impl::Convex_polygon>>;
+
+    private:
+        Pixel           m_background;
+        vector<Item>    m_items;
+
+        template< class Shape >
+        void add( const Shape& shape, const Style& style )
+        {
+            const impl::Interval x = shape.x_extent();
+            const impl::Interval y = shape.y_extent();
+            if( x.is_empty() or y.is_empty() ) { return; }
+            const double pen_width = (style.pen_color? max( 0.0, style.pen_width ) : 0.0);
+            const Rect bounds = {
+                int( floor( x.start ) ), int( floor( y.start ) ), int( ceil( x.end ) ), int( ceil( y.end ) )
+                };
+            m_items.push_back( Item_<Shape>{ shape, shape.inset( pen_width ), style, bounds } );
+        }
+
+    public:
+        explicit Display_list( const Pixel background ): m_background( background ) {}
+
+        void add_ellipse(
+            const Vec2& center, const double rx, const double ry, const Affine& transform, const Style& style
+            )
+        { add( impl::Ellipse_quadric::image_of( center, rx, ry, transform ), style ); }
+
+        // The polygon must be convex.
+        void add_polygon( const vector<Vec2>& vertices, const Affine& transform, const Style& style )
+        {
+            vector<Vec2> transformed;
+            transformed.reserve( vertices.size() );
+            for( const Vec2& v: vertices ) { transformed.push_back( transform.applied_to( v ) ); }
+            add( impl::Convex_polygon( transformed ), style );
+        }
+
+        void clear() { m_items.clear(); }
+
+        auto background() const -> Pixel { return m_background; }
+        auto items() const -> const vector<Item>& { return m_items; }
+    };
+
+    namespace impl {
+        // Draws the item into `canvas`, which is the part of the image with top left `origin`.
+        inline void draw_item( const Pixel_view_32& canvas, const Display_list::Item& item, const Point& origin )
+        {
+            visit( [&]( const auto& shape_item ) {
+                draw_convex_shape( canvas, shape_item.outer, shape_item.inner, shape_item.style, origin );
+            }, item );
+        }
+    }  // namespace impl
+
+    // Draws the list in the calling thread without tiles, e.g. for small images or comparison.
+    inline void draw_directly( const Display_list& list, const Pixel_view_32& image )
+    {
+        fill( image, list.background() );
+        for( const Display_list::Item& item: list.items() ) { impl::draw_item( image, item, {0, 0} ); }
+    }
+
+    // Reuses its tile bins from frame to frame, so that steady state rendering doesn’t allocate
+    // except for the thread pool’s tasks. Not thread safe: one renderer per rendering thread.
+    class Tile_renderer
+    {
+        cu::Thread_pool&        m_pool;
+        int                     m_tile_size;
+        vector<vector<int>>     m_bins;         // Item indices per tile, row by row of tiles.
+
+    public:
+        explicit Tile_renderer( cu::Thread_pool& pool = cu::Thread_pool::shared(), const int tile_size = 64 ):
+            m_pool( pool ), m_tile_size( tile_size )
+        {}
+
+        auto tile_size() const -> int { return m_tile_size; }
+
+        void render( const Display_list& list, const Pixel_view_32& image )
+        {
+            if( image.is_empty() ) { return; }
+            const int n_columns = (image.width() + m_tile_size - 1)/m_tile_size;
+            const int n_rows = (image.height() + m_tile_size - 1)/m_tile_size;
+            const int n_tiles = n_columns*n_rows;
+            m_bins.resize( size_t( max<int>( n_tiles, int( m_bins.size() ) ) ) );
+            for( int i = 0; i < n_tiles; ++i ) { m_bins[i].clear(); }
+
+            const vector<Display_list::Item>& items = list.items();
+            for( int i = 0; i < int( items.size() ); ++i ) {
+                const Rect r = intersection_of(
+                    visit( []( const auto& shape_item ) -> Rect { return shape_item.bounds; }, items[i] ),
+                    image.bounds()
+                    );
+                if( r.is_empty() ) { continue; }
+                for( int row = r.top/m_tile_size; row <= (r.bottom - 1)/m_tile_size; ++row ) {
+                    for( int column = r.left/m_tile_size; column <= (r.right - 1)/m_tile_size; ++column ) {
+                        m_bins[row*n_columns + column].push_back( i );
+                    }
+                }
+            }
+
+            cu::Task_group group( m_pool );
+            cu::parallel_for( group, cu::Range{ 0, n_tiles - 1 }, 1, [&]( const cu::Range& tiles ) {
+                for( int i = tiles.first; i <= tiles.last; ++i ) {
+                    const Point origin = {(i % n_columns)*m_tile_size, (i/n_columns)*m_tile_size};
+                    const Pixel_view_32 tile = image.sub(
+                        {origin.x, origin.y, origin.x + m_tile_size, origin.y + m_tile_size}
+                        );
+                    fill( tile, list.background() );
+                    for( const int item_index: m_bins[i] ) { impl::draw_item( tile, items[item_index], origin ); }
+                }
+            } );
+        }
+    };
+}  // namespace raster
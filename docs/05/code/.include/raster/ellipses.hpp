@@ -0,0 +1,179 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Affine.hpp>            // raster::(Affine, Vec2)
+#include <raster/Pixel_view_32.hpp>     // raster::(Pixel_view_32, Rect)
+#include <raster/Style.hpp>             // raster::Style
+#include <raster/scanline.hpp>          // raster::impl::(draw_convex_shape, Interval, ...)
+
+#include <math.h>           // atan2, cos, sin, sqrt
+
+#include <algorithm>        // std::max
+
+// Antialiased ellipses, filled with the brush and outlined with the pen of a `Style`, drawn
+// directly into 32-bit pixel memory, as a portable alternative to GDI `Ellipse`, also for an
+// ellipse transformed by an `Affine` as with GDI `SetWorldTransform`. The scanline
+// rasterization is described in `scanline.hpp`.
+namespace raster {
+    namespace impl {
+        // The points p with (p - center)ᵀM(p - center) ≤ 1, where M = [[a, b], [b, c]], set up
+        // once per ellipse from its principal axes.
+        class Ellipse_quadric
+        {
+            Vec2        m_center;
+            double      m_r1;           // Semi-axis in direction `m_angle`.
+            double      m_r2;           // The perpendicular semi-axis.
+            double      m_angle;
+            double      m_a             = 0;
+            double      m_b             = 0;
+            double      m_c             = 0;
+            double      m_x_extent      = 0;    // Half width.
+            double      m_y_extent      = 0;    // Half height.
+            Vec2        m_rightmost     = {};   // Relative to the center; the leftmost is its negation.
+
+        public:
+            Ellipse_quadric( const Vec2& center, const double r1, const double r2, const double angle = 0 ):
+                m_center( center ), m_r1( r1 ), m_r2( r2 ), m_angle( angle )
+            {
+                if( is_empty() ) { return; }
+                const double lambda_1 = 1/(r1*r1);
+                const double lambda_2 = 1/(r2*r2);
+                const double cos_v = cos( angle );
+                const double sin_v = sin( angle );
+                m_a = lambda_1*cos_v*cos_v + lambda_2*sin_v*sin_v;
+                m_b = (lambda_1 - lambda_2)*sin_v*cos_v;
+                m_c = lambda_1*sin_v*sin_v + lambda_2*cos_v*cos_v;
+                const double det = m_a*m_c - m_b*m_b;
+                m_x_extent = sqrt( m_c/det );
+                m_y_extent = sqrt( m_a/det );
+                m_rightmost = {m_x_extent, -m_b*m_x_extent/m_c};
+            }
+
+            // The image of the ellipse with center `center` and radii rx, ry under `t`.
+            static auto image_of( const Vec2& center, const double rx, const double ry, const Affine& t )
+                -> Ellipse_quadric
+            {
+                // The image is {t(center) + L·u : |u| ≤ 1} with L the linear part of `t` times
+                // diag(rx, ry). Its semi-axes are the square roots of the eigenvalues of L·Lᵀ.
+                const Vec2 column_1 = t.linearly_applied_to( {rx, 0} );
+                const Vec2 column_2 = t.linearly_applied_to( {0, ry} );
+                const double p = column_1.x*column_1.x + column_2.x*column_2.x;
+                const double q = column_1.x*column_1.y + column_2.x*column_2.y;
+                const double r = column_1.y*column_1.y + column_2.y*column_2.y;
+                const double mean = (p + r)/2;
+                const double spread = sqrt( (p - r)*(p - r)/4 + q*q );
+                const double angle = atan2( 2*q, p - r )/2;
+                return Ellipse_quadric(
+                    t.applied_to( center ), sqrt( mean + spread ), sqrt( max( 0.0, mean - spread ) ), angle
+                    );
+            }
+
+            auto is_empty() const -> bool { return not (m_r1 > 0 and m_r2 > 0); }
+
+            // The ellipse with both semi-axes `d` shorter, i.e. with an outline of width d.
+            auto inset( const double d ) const
+                -> Ellipse_quadric
+            { return Ellipse_quadric( m_center, m_r1 - d, m_r2 - d, m_angle ); }
+
+            auto x_extent() const
+                -> Interval
+            {
+                if( is_empty() ) { return {}; }
+                return {m_center.x - m_x_extent, m_center.x + m_x_extent};
+            }
+
+            auto y_extent() const
+                -> Interval
+            {
+                if( is_empty() ) { return {}; }
+                return {m_center.y - m_y_extent, m_center.y + m_y_extent};
+            }
+
+            auto span_on_line( const double y ) const
+                -> Interval
+            {
+                if( is_empty() ) { return {}; }
+                const double dy = y - m_center.y;
+                const double discriminant = (m_b*dy)*(m_b*dy) - m_a*(m_c*dy*dy - 1);
+                if( discriminant < 0 ) { return {}; }
+                const double root = sqrt( discriminant );
+                return {m_center.x + (-m_b*dy - root)/m_a, m_center.x + (-m_b*dy + root)/m_a};
+            }
+
+            auto strip_hull(
+                const double y_top, const double y_bottom, const Interval& top_span, const Interval& bottom_span
+                ) const -> Interval
+            {
+                Interval result = hull_of( top_span, bottom_span );
+                if( is_empty() ) { return result; }
+                const Interval strip = {y_top, y_bottom};
+                if( strip.contains( m_center.y - m_rightmost.y ) ) {
+                    result = extended_to( result, m_center.x - m_rightmost.x );
+                }
+                if( strip.contains( m_center.y + m_rightmost.y ) ) {
+                    result = extended_to( result, m_center.x + m_rightmost.x );
+                }
+                return result;
+            }
+
+            // The distance is to first order, which is accurate for the boundary pixels where
+            // the coverage is used.
+            auto coverage_at( const double x, const double y ) const
+                -> int
+            {
+                if( is_empty() ) { return 0; }
+                const double dx = x - m_center.x;
+                const double dy = y - m_center.y;
+                const double gx = m_a*dx + m_b*dy;          // Half the gradient.
+                const double gy = m_b*dx + m_c*dy;
+                const double gradient_length = 2*sqrt( gx*gx + gy*gy );
+                if( gradient_length == 0 ) { return 255; }  // The center.
+                return coverage_from_distance( (dx*gx + dy*gy - 1)/gradient_length );
+            }
+        };
+
+        inline void draw( const Pixel_view_32& canvas, const Ellipse_quadric& ellipse, const Style& style )
+        {
+            const double pen_width = (style.pen_color? max( 0.0, style.pen_width ) : 0.0);
+            draw_convex_shape( canvas, ellipse, ellipse.inset( pen_width ), style );
+        }
+    }  // namespace impl
+
+    // The ellipse with center (cx, cy) and radii rx and ry. The outline is `style.pen_width`
+    // wide inside the ellipse boundary.
+    inline void draw_ellipse(
+        const Pixel_view_32& canvas, const double cx, const double cy, const double rx, const double ry,
+        const Style& style
+        )
+    {
+        impl::draw( canvas, impl::Ellipse_quadric( {cx, cy}, rx, ry ), style );
+    }
+
+    // The ellipse inscribed in `bounds`, with the same arguments as GDI `Ellipse`, and like
+    // `Ellipse` drawing nothing at or beyond `bounds.right` and `bounds.bottom`.
+    inline void draw_ellipse( const Pixel_view_32& canvas, const Rect& bounds, const Style& style )
+    {
+        draw_ellipse(
+            canvas, (bounds.left + bounds.right)/2.0, (bounds.top + bounds.bottom)/2.0,
+            bounds.width()/2.0, bounds.height()/2.0, style
+            );
+    }
+
+    // The image under `transform` of the ellipse with `center` and radii rx and ry. The
+    // outline is `style.pen_width` pixels wide regardless of the transform, as with the
+    // cosmetic pen `DC_PEN` under `SetWorldTransform`.
+    inline void draw_ellipse(
+        const Pixel_view_32& canvas, const Vec2& center, const double rx, const double ry,
+        const Affine& transform, const Style& style
+        )
+    {
+        impl::draw( canvas, impl::Ellipse_quadric::image_of( center, rx, ry, transform ), style );
+    }
+
+    // As GDI `Ellipse` with `bounds` in world coordinates after `SetWorldTransform( transform )`.
+    inline void draw_ellipse(
+        const Pixel_view_32& canvas, const Rect& bounds, const Affine& transform, const Style& style
+        )
+    {
+        const Vec2 center = {(bounds.left + bounds.right)/2.0, (bounds.top + bounds.bottom)/2.0};
+        draw_ellipse( canvas, center, bounds.width()/2.0, bounds.height()/2.0, transform, style );
+    }
+}  // namespace raster
@@ -0,0 +1,305 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Pixel_view_32.hpp>     // raster::Pixel
+
+#include <stddef.h>         // ptrdiff_t
+#include <string.h>         // memmove
+
+#include <vector>           // std::vector
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#   include <immintrin.h>   // SSE2 and AVX2 intrinsics
+#   define RASTER_KERNELS_X86
+#elif defined( __aarch64__ ) || defined( _M_ARM64 )
+#   include <arm_neon.h>
+#   define RASTER_KERNELS_NEON
+#endif
+#ifdef _MSC_VER
+#   include <intrin.h>      // __cpuid, __cpuidex, _xgetbv
+#   define RASTER_TARGET_AVX2
+#else
+#   define RASTER_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#endif
+
+// Row kernels for 32-bit pixel memory, in a scalar version and in SIMD versions for SSE2, AVX2
+// and NEON, and `best()`, the fastest set supported by the CPU, chosen at run time. The AVX2
+// code is compiled with a function target attribute, so no compiler option is needed.
+// Defining `RASTER_NO_SIMD` makes `best()` the scalar set, e.g. for comparison.
+namespace raster::kernels {
+    using std::vector;
+
+    // Operations on the n pixels of a row. `copy` works as `memmove`, i.e. the source and
+    // target may overlap. `masked_copy` copies the source pixels with alpha at least 128, i.e.
+    // with the top bit set, as with a 1-bit alpha mask, also with overlap.
+    struct Set
+    {
+        const char*     name;
+        void            (*fill)( Pixel* p_to, ptrdiff_t n, Pixel color );
+        void            (*copy)( Pixel* p_to, const Pixel* p_from, ptrdiff_t n );
+        void            (*masked_copy)( Pixel* p_to, const Pixel* p_from, ptrdiff_t n );
+    };
+
+    namespace impl {
+        // Whether a copy from `p_from` to `p_to` must go from the end to not overwrite source
+        // pixels before they’re read.
+        inline auto must_copy_backwards( const Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            -> bool
+        { return p_from < p_to and p_to < p_from + n; }
+
+        inline auto masked( const Pixel source, const Pixel destination )
+            -> Pixel
+        { return (source & 0x80000000? source : destination); }
+
+        inline void scalar_masked_copy_from( const ptrdiff_t i_end, Pixel* const p_to, const Pixel* const p_from,
+            const ptrdiff_t n, const bool backwards )
+        {
+            if( backwards ) {
+                for( ptrdiff_t i = i_end - 1; i >= 0; --i ) { p_to[i] = masked( p_from[i], p_to[i] ); }
+            } else {
+                for( ptrdiff_t i = i_end; i < n; ++i ) { p_to[i] = masked( p_from[i], p_to[i] ); }
+            }
+        }
+    }  // namespace impl
+
+    namespace scalar {
+        inline void fill( Pixel* const p_to, const ptrdiff_t n, const Pixel color )
+        {
+            for( ptrdiff_t i = 0; i < n; ++i ) { p_to[i] = color; }
+        }
+
+        inline void copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+        {
+            memmove( p_to, p_from, sizeof( Pixel )*size_t( n ) );
+        }
+
+        inline void masked_copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+        {
+            const bool backwards = impl::must_copy_backwards( p_to, p_from, n );
+            impl::scalar_masked_copy_from( (backwards? n : 0), p_to, p_from, n, backwards );
+        }
+
+        inline const Set set = { "scalar", fill, copy, masked_copy };
+    }  // namespace scalar
+
+    // The SIMD versions share structure: whole vectors first, in the direction that handles
+    // overlap, then the remaining pixels with scalar code. Unaligned loads and stores are
+    // used throughout; on current CPUs they cost the same as aligned ones for aligned data.
+    #ifdef RASTER_KERNELS_X86
+        namespace sse2 {
+            inline void fill( Pixel* const p_to, const ptrdiff_t n, const Pixel color )
+            {
+                const __m128i v = _mm_set1_epi32( int( color ) );
+                ptrdiff_t i = 0;
+                for( ; i + 4 <= n; i += 4 ) { _mm_storeu_si128( reinterpret_cast<__m128i*>( p_to + i ), v ); }
+                for( ; i < n; ++i ) { p_to[i] = color; }
+            }
+
+            template< bool is_masked >
+            inline void copy_( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                const auto step = [&]( const ptrdiff_t i )
+                {
+                    const __m128i s = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p_from + i ) );
+                    __m128i* const p_target = reinterpret_cast<__m128i*>( p_to + i );
+                    if constexpr( is_masked ) {
+                        const __m128i mask = _mm_srai_epi32( s, 31 );
+                        const __m128i d = _mm_loadu_si128( p_target );
+                        _mm_storeu_si128( p_target, _mm_or_si128( _mm_and_si128( mask, s ), _mm_andnot_si128( mask, d ) ) );
+                    } else {
+                        _mm_storeu_si128( p_target, s );
+                    }
+                };
+                const bool backwards = impl::must_copy_backwards( p_to, p_from, n );
+                ptrdiff_t i;
+                if( backwards ) {
+                    for( i = n; i >= 4; i -= 4 ) { step( i - 4 ); }
+                } else {
+                    for( i = 0; i + 4 <= n; i += 4 ) { step( i ); }
+                }
+                if constexpr( is_masked ) {
+                    impl::scalar_masked_copy_from( i, p_to, p_from, n, backwards );
+                } else if( backwards ) {
+                    for( --i; i >= 0; --i ) { p_to[i] = p_from[i]; }
+                } else {
+                    for( ; i < n; ++i ) { p_to[i] = p_from[i]; }
+                }
+            }
+
+            inline void copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<false>( p_to, p_from, n );
+            }
+
+            inline void masked_copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<true>( p_to, p_from, n );
+            }
+
+            inline const Set set = { "sse2", fill, copy, masked_copy };
+        }  // namespace sse2
+
+        namespace avx2 {
+            RASTER_TARGET_AVX2 inline void fill( Pixel* const p_to, const ptrdiff_t n, const Pixel color )
+            {
+                const __m256i v = _mm256_set1_epi32( int( color ) );
+                ptrdiff_t i = 0;
+                for( ; i + 16 <= n; i += 16 ) {
+                    _mm256_storeu_si256( reinterpret_cast<__m256i*>( p_to + i ), v );
+                    _mm256_storeu_si256( reinterpret_cast<__m256i*>( p_to + i + 8 ), v );
+                }
+                for( ; i + 8 <= n; i += 8 ) { _mm256_storeu_si256( reinterpret_cast<__m256i*>( p_to + i ), v ); }
+                for( ; i < n; ++i ) { p_to[i] = color; }
+            }
+
+            // A lambda can’t be given the target attribute, hence a function per vector step.
+            RASTER_TARGET_AVX2 inline void copy_8( Pixel* const p_to, const Pixel* const p_from )
+            {
+                const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p_from ) );
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>( p_to ), s );
+            }
+
+            RASTER_TARGET_AVX2 inline void masked_copy_8( Pixel* const p_to, const Pixel* const p_from )
+            {
+                const __m256i s = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p_from ) );
+                const __m256i d = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p_to ) );
+                const __m256i mask = _mm256_srai_epi32( s, 31 );
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>( p_to ), _mm256_blendv_epi8( d, s, mask ) );
+            }
+
+            template< bool is_masked >
+            RASTER_TARGET_AVX2 inline void copy_( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                const bool backwards = impl::must_copy_backwards( p_to, p_from, n );
+                ptrdiff_t i;
+                if( backwards ) {
+                    for( i = n; i >= 8; i -= 8 ) {
+                        if constexpr( is_masked ) { masked_copy_8( p_to + i - 8, p_from + i - 8 ); }
+                        else { copy_8( p_to + i - 8, p_from + i - 8 ); }
+                    }
+                } else {
+                    for( i = 0; i + 8 <= n; i += 8 ) {
+                        if constexpr( is_masked ) { masked_copy_8( p_to + i, p_from + i ); }
+                        else { copy_8( p_to + i, p_from + i ); }
+                    }
+                }
+                if constexpr( is_masked ) {
+                    impl::scalar_masked_copy_from( i, p_to, p_from, n, backwards );
+                } else if( backwards ) {
+                    for( --i; i >= 0; --i ) { p_to[i] = p_from[i]; }
+                } else {
+                    for( ; i < n; ++i ) { p_to[i] = p_from[i]; }
+                }
+            }
+
+            RASTER_TARGET_AVX2 inline void copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<false>( p_to, p_from, n );
+            }
+
+            RASTER_TARGET_AVX2 inline void masked_copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<true>( p_to, p_from, n );
+            }
+
+            inline const Set set = { "avx2", fill, copy, masked_copy };
+        }  // namespace avx2
+    #endif
+
+    #ifdef RASTER_KERNELS_NEON
+        namespace neon {
+            inline void fill( Pixel* const p_to, const ptrdiff_t n, const Pixel color )
+            {
+                const uint32x4_t v = vdupq_n_u32( color );
+                ptrdiff_t i = 0;
+                for( ; i + 4 <= n; i += 4 ) { vst1q_u32( p_to + i, v ); }
+                for( ; i < n; ++i ) { p_to[i] = color; }
+            }
+
+            template< bool is_masked >
+            inline void copy_( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                const auto step = [&]( const ptrdiff_t i )
+                {
+                    const uint32x4_t s = vld1q_u32( p_from + i );
+                    if constexpr( is_masked ) {
+                        const uint32x4_t mask = vreinterpretq_u32_s32( vshrq_n_s32( vreinterpretq_s32_u32( s ), 31 ) );
+                        vst1q_u32( p_to + i, vbslq_u32( mask, s, vld1q_u32( p_to + i ) ) );
+                    } else {
+                        vst1q_u32( p_to + i, s );
+                    }
+                };
+                const bool backwards = impl::must_copy_backwards( p_to, p_from, n );
+                ptrdiff_t i;
+                if( backwards ) {
+                    for( i = n; i >= 4; i -= 4 ) { step( i - 4 ); }
+                } else {
+                    for( i = 0; i + 4 <= n; i += 4 ) { step( i ); }
+                }
+                if constexpr( is_masked ) {
+                    impl::scalar_masked_copy_from( i, p_to, p_from, n, backwards );
+                } else if( backwards ) {
+                    for( --i; i >= 0; --i ) { p_to[i] = p_from[i]; }
+                } else {
+                    for( ; i < n; ++i ) { p_to[i] = p_from[i]; }
+                }
+            }
+
+            inline void copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<false>( p_to, p_from, n );
+            }
+
+            inline void masked_copy( Pixel* const p_to, const Pixel* const p_from, const ptrdiff_t n )
+            {
+                copy_<true>( p_to, p_from, n );
+            }
+
+            inline const Set set = { "neon", fill, copy, masked_copy };
+        }  // namespace neon
+    #endif
+
+    inline auto cpu_has_avx2()
+        -> bool
+    {
+        #if !defined( RASTER_KERNELS_X86 )
+            return false;
+        #elif defined( _MSC_VER )
+            int info[4];
+            __cpuid( info, 0 );
+            if( info[0] < 7 ) { return false; }
+            __cpuid( info, 1 );
+            const bool os_saves_avx_state = (info[2] & (1 << 27)) and (info[2] & (1 << 28))
+                and (_xgetbv( 0 ) & 6) == 6;
+            if( not os_saves_avx_state ) { return false; }
+            __cpuidex( info, 7, 0 );
+            return (info[1] & (1 << 5)) != 0;
+        #else
+            return __builtin_cpu_supports( "avx2" );
+        #endif
+    }
+
+    // The sets that this CPU supports, slowest first.
+    inline auto supported_sets()
+        -> vector<const Set*>
+    {
+        vector<const Set*> result = { &scalar::set };
+        #ifdef RASTER_KERNELS_X86
+            result.push_back( &sse2::set );         // Part of x86-64.
+            if( cpu_has_avx2() ) { result.push_back( &avx2::set ); }
+        #endif
+        #ifdef RASTER_KERNELS_NEON
+            result.push_back( &neon::set );         // Part of AArch64.
+        #endif
+        return result;
+    }
+
+    inline auto best()
+        -> const Set&
+    {
+        #ifdef RASTER_NO_SIMD
+            return scalar::set;
+        #else
+            static const Set& the_set = *supported_sets().back();
+            return the_set;
+        #endif
+    }
+}  // namespace raster::kernels
@@ -0,0 +1,172 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Affine.hpp>            // raster::(Affine, Vec2)
+#include <raster/Pixel_view_32.hpp>     // raster::Pixel_view_32
+#include <raster/Style.hpp>             // raster::Style
+#include <raster/scanline.hpp>          // raster::impl::(draw_convex_shape, Interval, ...)
+
+#include <math.h>           // fabs, sqrt, HUGE_VAL
+
+#include <algorithm>        // std::(max, min)
+#include <vector>           // std::vector
+
+// Antialiased convex polygons, filled with the brush and outlined with the pen of a `Style`,
+// drawn directly into 32-bit pixel memory, as a portable alternative to GDI `Polygon`, also
+// with the vertices transformed by an `Affine` as with GDI `SetWorldTransform`. The scanline
+// rasterization is described in `scanline.hpp`.
+namespace raster {
+    namespace impl {
+        // The intersection of the half-planes n·p + c ≤ 0 of the edges, with unit normals n,
+        // so that n·p + c is the signed distance from an edge line.
+        class Convex_polygon
+        {
+            struct Edge{ Vec2 n; double c; };
+
+            vector<Edge>    m_edges;
+            vector<Vec2>    m_vertices;         // Empty if not known, then the hull is conservative.
+            Interval        m_x_extent;
+            Interval        m_y_extent;
+
+            Convex_polygon() {}
+
+        public:
+            // The vertices are in order, in either direction, and must form a convex polygon.
+            explicit Convex_polygon( const vector<Vec2>& vertices ):
+                m_vertices( vertices )
+            {
+                const int n = int( vertices.size() );
+                double twice_area = 0;
+                for( int i = 0; i < n; ++i ) {
+                    const Vec2& p = vertices[i];
+                    const Vec2& q = vertices[(i + 1) % n];
+                    twice_area += p.x*q.y - q.x*p.y;
+                }
+                if( fabs( twice_area ) < 1e-12 ) { m_vertices.clear();  return; }      // Empty.
+                const double outward = (twice_area > 0? 1 : -1);
+                for( int i = 0; i < n; ++i ) {
+                    const Vec2& p = vertices[i];
+                    const Vec2& q = vertices[(i + 1) % n];
+                    const double length = sqrt( (q.x - p.x)*(q.x - p.x) + (q.y - p.y)*(q.y - p.y) );
+                    if( length == 0 ) { continue; }
+                    const Vec2 normal = {outward*(q.y - p.y)/length, -outward*(q.x - p.x)/length};
+                    m_edges.push_back( {normal, -(normal.x*p.x + normal.y*p.y)} );
+                    m_x_extent = extended_to( m_x_extent, p.x );
+                    m_y_extent = extended_to( m_y_extent, p.y );
+                }
+            }
+
+            auto is_empty() const -> bool { return m_edges.empty(); }
+
+            // The polygon with each edge moved `d` inwards, i.e. with an outline of width d.
+            // The vertices, which are only used for the row hulls, are the miter joins of
+            // adjacent moved edges if no edge disappears.
+            auto inset( const double d ) const
+                -> Convex_polygon
+            {
+                Convex_polygon result;
+                result.m_x_extent = m_x_extent;
+                result.m_y_extent = m_y_extent;
+                for( const Edge& e: m_edges ) { result.m_edges.push_back( {e.n, e.c + d} ); }
+                const int n = int( m_edges.size() );
+                for( int i = 0; i < n and n == int( m_vertices.size() ); ++i ) {
+                    const Vec2& n1 = m_edges[(i + n - 1) % n].n;
+                    const Vec2& n2 = m_edges[i].n;
+                    const double cos_angle = n1.x*n2.x + n1.y*n2.y;
+                    if( cos_angle <= -1 + 1e-9 ) { break; }
+                    const double f = d/(1 + cos_angle);
+                    result.m_vertices.push_back( {m_vertices[i].x - f*(n1.x + n2.x), m_vertices[i].y - f*(n1.y + n2.y)} );
+                }
+                // With no edge disappeared, each moved edge keeps its direction.
+                const int n_moved = int( result.m_vertices.size() );
+                for( int i = 0; i < n_moved and n_moved == n; ++i ) {
+                    const Vec2& p = result.m_vertices[i];
+                    const Vec2& q = result.m_vertices[(i + 1) % n];
+                    const Vec2& original_p = m_vertices[i];
+                    const Vec2& original_q = m_vertices[(i + 1) % n];
+                    if( (q.x - p.x)*(original_q.x - original_p.x) + (q.y - p.y)*(original_q.y - original_p.y) < 0 ) {
+                        result.m_vertices.clear();
+                        break;
+                    }
+                }
+                if( n_moved != n ) { result.m_vertices.clear(); }
+                return result;
+            }
+
+            auto x_extent() const -> Interval { return (is_empty()? Interval() : m_x_extent); }
+            auto y_extent() const -> Interval { return (is_empty()? Interval() : m_y_extent); }
+
+            auto span_on_line( const double y ) const
+                -> Interval
+            {
+                if( is_empty() ) { return {}; }
+                Interval result = {-HUGE_VAL, HUGE_VAL};
+                for( const Edge& e: m_edges ) {
+                    const double rest = e.n.y*y + e.c;
+                    if( e.n.x > 1e-12 ) {
+                        result.end = min( result.end, -rest/e.n.x );
+                    } else if( e.n.x < -1e-12 ) {
+                        result.start = max( result.start, -rest/e.n.x );
+                    } else if( rest > 0 ) {
+                        return {};
+                    }
+                }
+                return result;
+            }
+
+            auto strip_hull(
+                const double y_top, const double y_bottom, const Interval& top_span, const Interval& bottom_span
+                ) const -> Interval
+            {
+                if( is_empty() ) { return {}; }
+                if( m_vertices.empty() ) { return {-1e9, 1e9}; }   // Unknown vertices: any x.
+                Interval result = hull_of( top_span, bottom_span );
+                const Interval strip = {y_top, y_bottom};
+                for( const Vec2& v: m_vertices ) {
+                    if( strip.contains( v.y ) ) { result = extended_to( result, v.x ); }
+                }
+                return result;
+            }
+
+            // The product of the pixel’s coverages by the edges’ half-planes, each 1/2 minus
+            // the signed distance of the pixel center from the edge line, clamped to [0, 1].
+            // This is exact for a corner with axis-aligned edges, and for a pixel crossed by
+            // one edge, and it keeps sharp corners from being rounded out.
+            auto coverage_at( const double x, const double y ) const
+                -> int
+            {
+                if( is_empty() ) { return 0; }
+                double coverage = 1;
+                for( const Edge& e: m_edges ) {
+                    const double edge_coverage = 0.5 - (e.n.x*x + e.n.y*y + e.c);
+                    if( edge_coverage <= 0 ) { return 0; }
+                    if( edge_coverage < 1 ) { coverage *= edge_coverage; }
+                }
+                return int( 255*coverage + 0.5 );
+            }
+        };
+
+        inline void draw( const Pixel_view_32& canvas, const Convex_polygon& polygon, const Style& style )
+        {
+            const double pen_width = (style.pen_color? max( 0.0, style.pen_width ) : 0.0);
+            draw_convex_shape( canvas, polygon, polygon.inset( pen_width ), style );
+        }
+    }  // namespace impl
+
+    // The convex polygon with the `vertices` in order. The outline is `style.pen_width` wide
+    // inside the polygon boundary.
+    inline void draw_polygon( const Pixel_view_32& canvas, const vector<Vec2>& vertices, const Style& style )
+    {
+        impl::draw( canvas, impl::Convex_polygon( vertices ), style );
+    }
+
+    // The image under `transform` of the convex polygon with the `vertices` in order. The
+    // outline is `style.pen_width` pixels wide regardless of the transform.
+    inline void draw_polygon(
+        const Pixel_view_32& canvas, const vector<Vec2>& vertices, const Affine& transform, const Style& style
+        )
+    {
+        vector<Vec2> transformed;
+        transformed.reserve( vertices.size() );
+        for( const Vec2& v: vertices ) { transformed.push_back( transform.applied_to( v ) ); }
+        draw_polygon( canvas, transformed, style );
+    }
+}  // namespace raster
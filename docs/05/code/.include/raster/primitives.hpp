@@ -0,0 +1,148 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Pixel_view_32.hpp>     // raster::(Pixel, Pixel_view_32, Point, Rect)
+#include <raster/kernels.hpp>           // raster::kernels::*
+
+#include <stdint.h>         // uint32_t
+
+#include <algorithm>        // std::(max, min)
+
+// Software raster primitives on `Pixel_view_32`: fill, copy of a rectangle with overlap
+// handling, and blits with and without alpha blending or masking. All clip to the views’
+// bounds. Fill and copies use the row kernels of `raster::kernels::best()`.
+namespace raster {
+    inline void fill( const Pixel_view_32& view, const Pixel color )
+    {
+        const auto fill_row = kernels::best().fill;
+        for( int y = 0; y < view.height(); ++y ) { fill_row( view.row( y ), view.width(), color ); }
+    }
+
+    inline void fill( const Pixel_view_32& view, const Rect& area, const Pixel color )
+    {
+        fill( view.sub( area ), color );
+    }
+
+    namespace impl {
+        // Clips a copy of width×height pixels from `from_corner` in `from` to `to_corner` in `to`,
+        // adjusting the corners. Returns the source area, which is empty if nothing remains.
+        inline auto clipped_source_area(
+            const Pixel_view_32& from, Point& from_corner, const Pixel_view_32& to, Point& to_corner,
+            int width, int height
+            ) -> Rect
+        {
+            const int dx = max( { 0, -from_corner.x, -to_corner.x } );
+            const int dy = max( { 0, -from_corner.y, -to_corner.y } );
+            from_corner = {from_corner.x + dx, from_corner.y + dy};
+            to_corner = {to_corner.x + dx, to_corner.y + dy};
+            width = min( { width - dx, from.width() - from_corner.x, to.width() - to_corner.x } );
+            height = min( { height - dy, from.height() - from_corner.y, to.height() - to_corner.y } );
+            return {from_corner.x, from_corner.y, from_corner.x + width, from_corner.y + height};
+        }
+
+        // Source over destination with the source’s alpha, with exact rounding of x/255, two
+        // 8-bit channels at a time in 16-bit lanes.
+        inline auto blended( const Pixel source, const Pixel destination )
+            -> Pixel
+        {
+            const uint32_t alpha = source >> 24;
+            if( alpha == 255 ) { return source; }
+            if( alpha == 0 ) { return destination; }
+            const auto mix = [alpha]( const uint32_t s_lanes, const uint32_t d_lanes ) -> uint32_t
+            {
+                const uint32_t t = s_lanes*alpha + d_lanes*(255 - alpha) + 0x00800080;
+                return ((t + ((t >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+            };
+            const Pixel opaque_source = source | 0xFF000000;    // Gives alpha + (1 - alpha)×dest alpha.
+            return mix( source & 0x00FF00FF, destination & 0x00FF00FF )
+                | mix( (opaque_source >> 8) & 0x00FF00FF, (destination >> 8) & 0x00FF00FF ) << 8;
+        }
+
+        // The weighted sum of three pixels, all four channels, where the weights sum to 255,
+        // e.g. background, pen and brush by coverage for antialiased shape edges.
+        inline auto mixed( const Pixel a, const int a_weight, const Pixel b, const int b_weight, const Pixel c )
+            -> Pixel
+        {
+            const auto c_weight = uint32_t( 255 - a_weight - b_weight );
+            const auto mix = [&]( const int shift ) -> uint32_t
+            {
+                const uint32_t t = ((a >> shift) & 0x00FF00FF)*uint32_t( a_weight )
+                    + ((b >> shift) & 0x00FF00FF)*uint32_t( b_weight )
+                    + ((c >> shift) & 0x00FF00FF)*c_weight + 0x00800080;
+                return ((t + ((t >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+            };
+            return mix( 0 ) | mix( 8 ) << 8;
+        }
+    }  // namespace impl
+
+    namespace impl {
+        // Copies the rows with `copy_row`, which must handle overlap within a row, in an order
+        // that handles overlap between rows.
+        template< class Row_copy_func >
+        inline void copy_rect_rows(
+            const Pixel_view_32& from, const Rect& source_area, const Pixel_view_32& to, const Point& destination,
+            const Row_copy_func& copy_row
+            )
+        {
+            Point from_corner = {source_area.left, source_area.top};
+            Point to_corner = destination;
+            const Rect area = clipped_source_area(
+                from, from_corner, to, to_corner, source_area.width(), source_area.height()
+                );
+            if( area.is_empty() ) { return; }
+            const Pixel_view_32 source = from.sub( area );
+            const Pixel_view_32 target = to.sub( {to_corner.x, to_corner.y, to_corner.x + area.width(), to.height()} );
+            const int n_rows = area.height();
+            // With overlap the rows are copied in order of decreasing address if the target is at
+            // higher addresses than the source, and otherwise in order of increasing address.
+            const bool target_is_higher = (source.may_overlap( target ) and target.row( 0 ) > source.row( 0 ));
+            const bool bottom_row_first = (target_is_higher == (source.stride() > 0));
+            for( int i = 0; i < n_rows; ++i ) {
+                const int y = (bottom_row_first? n_rows - 1 - i : i);
+                copy_row( target.row( y ), source.row( y ), area.width() );
+            }
+        }
+    }  // namespace impl
+
+    // Copies `source_area` of `from` to `to` with its top left at `destination`. The views may
+    // be of the same memory with overlapping areas, as with GDI `BitBlt` within a bitmap.
+    inline void copy_rect(
+        const Pixel_view_32& from, const Rect& source_area, const Pixel_view_32& to, const Point& destination
+        )
+    {
+        impl::copy_rect_rows( from, source_area, to, destination, kernels::best().copy );
+    }
+
+    // As `copy_rect`, but copies only the source pixels with alpha at least 128, i.e. a 1-bit
+    // alpha mask as for sprites.
+    inline void masked_copy_rect(
+        const Pixel_view_32& from, const Rect& source_area, const Pixel_view_32& to, const Point& destination
+        )
+    {
+        impl::copy_rect_rows( from, source_area, to, destination, kernels::best().masked_copy );
+    }
+
+    // Copies all of `from` to `to` with its top left at `destination`.
+    inline void blit( const Pixel_view_32& from, const Pixel_view_32& to, const Point& destination )
+    {
+        copy_rect( from, from.bounds(), to, destination );
+    }
+
+    // As `blit`, but with the 1-bit alpha mask of `masked_copy_rect`.
+    inline void blit_masked( const Pixel_view_32& from, const Pixel_view_32& to, const Point& destination )
+    {
+        masked_copy_rect( from, from.bounds(), to, destination );
+    }
+
+    // As `blit`, but blends each source pixel over the destination pixel with the source alpha.
+    inline void blit_blended( const Pixel_view_32& from, const Pixel_view_32& to, const Point& destination )
+    {
+        Point from_corner = {0, 0};
+        Point to_corner = destination;
+        const Rect area = impl::clipped_source_area( from, from_corner, to, to_corner, from.width(), from.height() );
+        if( area.is_empty() ) { return; }
+        for( int y = 0; y < area.height(); ++y ) {
+            const Pixel* const p_source = from.row( area.top + y ) + area.left;
+            Pixel* const p_target = to.row( to_corner.y + y ) + to_corner.x;
+            for( int x = 0; x < area.width(); ++x ) { p_target[x] = impl::blended( p_source[x], p_target[x] ); }
+        }
+    }
+}  // namespace raster
@@ -0,0 +1,148 @@
+﻿#pragma once    // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+#include <raster/Pixel_view_32.hpp>     // raster::(Pixel, Pixel_view_32, Point)
+#include <raster/Style.hpp>             // raster::Style
+#include <raster/kernels.hpp>           // raster::kernels::best
+#include <raster/primitives.hpp>        // raster::impl::mixed
+
+#include <math.h>           // ceil, floor
+
+#include <algorithm>        // std::(max, min)
+
+// The scanline driver for the antialiased convex shapes of `ellipses.hpp` and `polygons.hpp`.
+//
+// Coordinates are continuous: pixel (x, y) is the unit square with top left corner at (x, y).
+// Each row is split into spans. The span inside the shape is filled solid with the row
+// kernels, and so is the part of the outline that fully covers its pixels. Only the pixels
+// that a boundary crosses get a coverage value, and are blended with it. The span ends come
+// from the shape’s extent on the row edges, where each row reuses the extent on its top edge
+// from the row above.
+//
+// A shape type `S` has, with coordinates in pixels:
+//
+// * `s.x_extent()` and `s.y_extent()`, the `Interval`s of x and y values that it covers.
+// * `s.span_on_line( y )`, the `Interval` of x values that it covers on the line at y.
+// * `s.strip_hull( y_top, y_bottom, top_span, bottom_span )`, the `Interval` of x values that
+//   it covers between the two lines, given its spans on them. It may be larger.
+// * `s.coverage_at( x, y )`, its coverage 0…255 of the pixel with center (x, y).
+namespace raster::impl {
+    // An interval of reals, empty if start > end.
+    struct Interval
+    {
+        double  start   = 1;
+        double  end     = 0;
+
+        auto is_empty() const -> bool { return start > end; }
+        auto contains( const double v ) const -> bool { return start <= v and v <= end; }
+    };
+
+    inline auto hull_of( const Interval& a, const Interval& b )
+        -> Interval
+    {
+        if( a.is_empty() ) { return b; }
+        if( b.is_empty() ) { return a; }
+        return {min( a.start, b.start ), max( a.end, b.end )};
+    }
+
+    inline auto extended_to( const Interval& a, const double v )
+        -> Interval
+    { return (a.is_empty()? Interval{v, v} : Interval{min( a.start, v ), max( a.end, v )}); }
+
+    // As a value of 0…255 of the coverage 1/2 - d of a pixel with center at signed distance d
+    // from the boundary, negative inside, clamped to [0, 1].
+    inline auto coverage_from_distance( const double d )
+        -> int
+    {
+        const double coverage = 0.5 - d;
+        return (coverage <= 0? 0 : coverage >= 1? 255 : int( 255*coverage + 0.5 ));
+    }
+
+    // Pixels with any coverage in a row are in [touched_left, touched_right), and those
+    // fully covered are in [full_left, full_right). An empty span has left ≥ right.
+    struct Row_spans
+    {
+        int     touched_left    = 0;
+        int     touched_right   = 0;
+        int     full_left       = 0;
+        int     full_right      = 0;
+
+        auto is_touched( const int x ) const -> bool { return touched_left <= x and x < touched_right; }
+        auto is_full( const int x ) const -> bool { return full_left <= x and x < full_right; }
+    };
+
+    inline auto row_spans_of( const Interval& hull, const Interval& top_span, const Interval& bottom_span )
+        -> Row_spans
+    {
+        if( hull.is_empty() ) { return {}; }
+        Row_spans result;
+        result.touched_left = int( floor( hull.start ) );
+        result.touched_right = int( ceil( hull.end ) );
+        if( not top_span.is_empty() and not bottom_span.is_empty() ) {
+            // Convexity: a pixel is inside if its corners are.
+            result.full_left = int( ceil( max( top_span.start, bottom_span.start ) ) );
+            result.full_right = int( floor( min( top_span.end, bottom_span.end ) ) );
+        }
+        return result;
+    }
+
+    // Draws `outer` with the brush, and with the pen between `outer` and `inner`, where
+    // `inner` is contained in `outer`. The shapes’ coordinates are offset by `origin` relative
+    // to the canvas, e.g. for a canvas that’s a tile of a larger image.
+    template< class Shape >
+    void draw_convex_shape(
+        const Pixel_view_32& canvas, const Shape& outer, const Shape& inner, const Style& style,
+        const Point& origin = {0, 0}
+        )
+    {
+        const Interval y_extent = outer.y_extent();
+        if( y_extent.is_empty() or not (style.pen_color or style.brush_color) ) { return; }
+        const Pixel pen = style.pen_color.value_or( 0 );
+        const Pixel brush = style.brush_color.value_or( 0 );
+        const bool has_brush = style.brush_color.has_value();
+        const auto fill_span = kernels::best().fill;
+
+        const int y_first = max( origin.y, int( floor( y_extent.start ) ) );
+        const int y_beyond = min( origin.y + canvas.height(), int( ceil( y_extent.end ) ) );
+        Interval outer_top = outer.span_on_line( y_first );
+        Interval inner_top = inner.span_on_line( y_first );
+        for( int y = y_first; y < y_beyond; ++y ) {
+            const Interval outer_bottom = outer.span_on_line( y + 1 );
+            const Interval inner_bottom = inner.span_on_line( y + 1 );
+            const Row_spans o = row_spans_of(
+                outer.strip_hull( y, y + 1, outer_top, outer_bottom ), outer_top, outer_bottom
+                );
+            const Row_spans i = row_spans_of(
+                inner.strip_hull( y, y + 1, inner_top, inner_bottom ), inner_top, inner_bottom
+                );
+            outer_top = outer_bottom;  inner_top = inner_bottom;
+
+            // Runs of pixels that are all brush, all pen or all boundary, between breakpoints.
+            Pixel* const p_row = canvas.row( y - origin.y );
+            const int x_beyond = min( origin.x + canvas.width(), o.touched_right );
+            const int breakpoints[] = { o.full_left, o.full_right, i.touched_left, i.touched_right, i.full_left, i.full_right };
+            for( int x = max( origin.x, o.touched_left ); x < x_beyond; ) {
+                int run_end = x_beyond;
+                for( const int b: breakpoints ) { if( x < b and b < run_end ) { run_end = b; } }
+                if( i.is_full( x ) ) {
+                    if( has_brush ) { fill_span( p_row + (x - origin.x), run_end - x, brush ); }
+                } else if( o.is_full( x ) and not i.is_touched( x ) ) {
+                    fill_span( p_row + (x - origin.x), run_end - x, pen );
+                } else {
+                    const double cy = y + 0.5;
+                    for( int bx = x; bx < run_end; ++bx ) {
+                        const double cx = bx + 0.5;
+                        const int outer_coverage = outer.coverage_at( cx, cy );
+                        if( outer_coverage == 0 ) { continue; }
+                        const int inner_coverage = min( outer_coverage, inner.coverage_at( cx, cy ) );
+                        const int pen_weight = outer_coverage - inner_coverage;
+                        const int brush_weight = (has_brush? inner_coverage : 0);
+                        const int background_weight = 255 - pen_weight - brush_weight;
+                        if( background_weight == 255 ) { continue; }
+                        Pixel& pixel = p_row[bx - origin.x];
+                        pixel = mixed( pixel, background_weight, pen, pen_weight, brush );
+                    }
+                }
+                x = run_end;
+            }
+        }
+    }
+}  // namespace raster::impl
@@ -1,11 +1,12 @@
 ﻿#pragma once    // Source encoding: UTF-8 with BOM (π is a lowercase Greek "pi").
 #include <winapi/gdi/Object_.hpp>       // winapi::gdi::Bitmap
+#include <raster/Pixel_view_32.hpp>     // raster::(Pixel_view_32, Row_order)
 
 #include <utility>      // std::move
 
 namespace winapi::gdi {
     namespace cu = cpp::util;
-    using cu::hopefully, cu::No_copying;
+    using cu::No_copying, cu::Result_;
     using std::move;
 
     namespace bitmap {
@@ -24,10 +25,13 @@ namespace winapi::gdi {
         {
             HBITMAP     handle;
             void*       p_bits;     // Owned by but cannot be obtained from the handle.
+            int         width;
+            int         height;
         };
 
-        inline auto create_rgb32( const int width, const int height )
-            -> Handle_and_memory
+        // Reports failure as a `Result_` error, which doesn’t allocate, e.g. for use in a loop.
+        inline auto try_create_rgb32( const int width, const int height )
+            -> Result_<Handle_and_memory>
         {
             BITMAPINFO params  = {};
             BITMAPINFOHEADER& info = params.bmiHeader;
@@ -47,19 +51,27 @@ namespace winapi::gdi {
                 HANDLE(),           // Section.
                 0                   // Section offset.
                 );
-            hopefully( handle != 0 ) or CPPUTIL_FAIL( "CreateDibSection failed" );
-            return Handle_and_memory{ handle, p_bits };
+            if( handle == 0 ) { return CPPUTIL_ERROR( int( GetLastError() ), "CreateDibSection failed" ); }
+            return Handle_and_memory{ handle, p_bits, width, height };
         }
+
+        inline auto create_rgb32( const int width, const int height )
+            -> Handle_and_memory
+        { return try_create_rgb32( width, height ).or_throw(); }
     }  // namespace bitmap
     
     class Bitmap_32: public Bitmap
     {
         void*       m_p_bits;
+        int         m_width;
+        int         m_height;
 
     public:
         Bitmap_32( bitmap::Handle_and_memory&& pieces ):
             Bitmap( move( pieces.handle ) ),
-            m_p_bits( pieces.p_bits )
+            m_p_bits( pieces.p_bits ),
+            m_width( pieces.width ),
+            m_height( pieces.height )
         {}  // TODO: format check.
 
         Bitmap_32( const int w, const int h ):
@@ -67,5 +79,19 @@ namespace winapi::gdi {
         {}
         
         auto bits() const -> void* { return m_p_bits; }
+        auto width() const -> int { return m_width; }
+        auto height() const -> int { return m_height; }
+
+        // 32-bit rows need no padding to the DWORD alignment of DIB rows.
+        auto stride_in_bytes() const -> int { return 4*m_width; }
+
+        // The positive `biHeight` of `create_rgb32` gives bottom-up rows. No copying.
+        auto pixels() const
+            -> raster::Pixel_view_32
+        {
+            return raster::Pixel_view_32::of_memory(
+                m_p_bits, m_width, m_height, stride_in_bytes(), raster::Row_order::bottom_up
+                );
+        }
     };
 }  // namespace winapi::gdi
@@ -1,6 +1,6 @@
 ﻿#pragma once // Source encoding: UTF-8 with BOM (π is a lowercase Greek "pi").
 #include <wrapped-winapi-headers/windows-h.hpp>
-#include <cpp/util.hpp>     // CPPUTIL_FAIL, cpp::util::(hopefully, int_size)
+#include <cpp/util.hpp>     // CPPUTIL_ERROR, cpp::util::(int_size, Result_)
 
 #include <string>           // std::wstring
 #include <string_view>      // std::string_view
@@ -8,16 +8,17 @@
 
 namespace winapi::kernel {
     namespace cu = cpp::util;
-    using   cu::hopefully, cu::fail, cu::int_size;
+    using   cu::int_size, cu::Result_;
     using   std::wstring,
             std::string_view,
             std::move;
     
-    inline auto to_utf16( const string_view& s, wstring result_buffer = {} )
-        -> wstring
+    // Reports failure as a `Result_` error, which doesn’t allocate, e.g. for use in a loop.
+    inline auto try_to_utf16( const string_view& s, wstring result_buffer = {} )
+        -> Result_<wstring>
     {
         const auto s_length = int_size( s );
-        if( s_length == 0 ) { return L""; }
+        if( s_length == 0 ) { return wstring(); }
 
         const auto buffer_size = s_length;  // May be a litte too large, but that's OK.
         result_buffer.resize( 1u*buffer_size );
@@ -25,8 +26,14 @@ namespace winapi::kernel {
         const int n_wide_values = MultiByteToWideChar(
             CP_UTF8, flags, s.data(), s_length, &result_buffer[0], buffer_size
             );
-        hopefully( n_wide_values != 0 ) or CPPUTIL_FAIL( "MultiByteToWideChar failed" );
+        if( n_wide_values == 0 ) {
+            return CPPUTIL_ERROR( int( GetLastError() ), "MultiByteToWideChar failed" );
+        }
         result_buffer.resize( 1u*n_wide_values );
         return move( result_buffer );
     }
+
+    inline auto to_utf16( const string_view& s, wstring result_buffer = {} )
+        -> wstring
+    { return try_to_utf16( s, move( result_buffer ) ).or_throw(); }
 }  // namespace winapi::kernel
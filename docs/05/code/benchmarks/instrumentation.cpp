@@ -0,0 +1,111 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Benchmark of the `cpp::util::instrumentation` scoped timers: the cost per timed scope, and
+// checks of the histogram percentiles and of the merging of per-thread histograms.
+//
+// Instrumentation is enabled here by defining `CPPUTIL_INSTRUMENTATION` before the include;
+// without it the timer macros expand to nothing.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I../.include instrumentation.cpp -o instrumentation
+//      ./instrumentation
+
+#define CPPUTIL_INSTRUMENTATION
+#include <cpp/instrumentation.hpp>
+#include <cpp/util.hpp>
+
+#include <math.h>       // fabs
+#include <stdint.h>     // int64_t, uint64_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace ci    = cpp::util::instrumentation;
+namespace chr   = std::chrono;
+using   std::thread,
+        std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+[[gnu::noinline]] void timed_work( const int i )
+{
+    CPPUTIL_TIMED_SCOPE( "timed_work" );
+    the_sink = i;
+}
+
+[[gnu::noinline]] void untimed_work( const int i )
+{
+    the_sink = i;
+}
+
+template< class Func >
+auto ns_per_call( const int n_calls, const Func& f )
+    -> double
+{
+    const auto start = chr::steady_clock::now();
+    for( int i = 0; i < n_calls; ++i ) { f( i ); }
+    return chr::duration<double, std::nano>( chr::steady_clock::now() - start ).count()/n_calls;
+}
+
+auto stats_for( const char* const name )
+    -> ci::Timer_stats
+{
+    for( const ci::Timer_stats& s: ci::stats() ) {
+        if( s.name == name ) { return s; }
+    }
+    return {};
+}
+
+void check( const bool condition, const char* const message )
+{
+    if( not condition ) {
+        fprintf( stderr, "!%s\n", message );
+        ++the_n_failures;
+    }
+}
+
+auto main() -> int
+{
+    const int n_calls = 20'000'000;
+    const double untimed_ns = ns_per_call( n_calls, untimed_work );
+    const double timed_ns = ns_per_call( n_calls, timed_work );
+    printf( "Untimed call %.2f ns, timed call %.2f ns: %.2f ns per timed scope.\n\n",
+        untimed_ns, timed_ns, timed_ns - untimed_ns
+        );
+    check( stats_for( "timed_work" ).count == n_calls, "Wrong count for “timed_work”." );
+
+    // Uniformly distributed ticks 1 through 100 000 on each of 4 threads, so that the merged
+    // p50, p90 and p99 are in proportion 50 : 90 : 99 within the histogram precision.
+    const int n_threads = 4;
+    const int n_values = 100'000;
+    vector<thread> threads;
+    for( int t = 0; t < n_threads; ++t ) {
+        threads.emplace_back( []{
+            static const ci::Site site( "uniform" );
+            for( int i = 1; i <= n_values; ++i ) { ci::record( site, uint64_t( i ) ); }
+        } );
+    }
+    for( thread& t: threads ) { t.join(); }
+
+    const ci::Timer_stats uniform = stats_for( "uniform" );
+    check( uniform.count == int64_t( n_threads )*n_values, "Wrong merged count for “uniform”." );
+    const auto is_near = []( const double value, const double expected ) -> bool
+    {
+        return fabs( value - expected ) <= 0.04*expected;
+    };
+    check( is_near( uniform.p90_ns/uniform.p50_ns, 90.0/50 ), "Wrong p90 : p50 ratio." );
+    check( is_near( uniform.p99_ns/uniform.p50_ns, 99.0/50 ), "Wrong p99 : p50 ratio." );
+    check( is_near( uniform.max_ns/uniform.p50_ns, 100.0/50 ), "Wrong max : p50 ratio." );
+    check( is_near( uniform.mean_ns/uniform.p50_ns, 1.0 ), "Wrong mean : p50 ratio." );
+
+    CPPUTIL_TIMED( "text and json" ) {
+        printf( "%s\n", ci::timings_as_text().c_str() );
+        printf( "%s\n", ci::timings_as_json().c_str() );
+    }
+    check( stats_for( "text and json" ).count == 1, "Wrong count for a `CPPUTIL_TIMED` block." );
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,179 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Checks and throughput of `raster::draw_ellipse`, the antialiased scanline ellipse
+// rasterizer, with the colors of the graphics-in-window programs: a yellow 1-pixel pen and an
+// orange brush on a blue background.
+//
+// The checks compare with a 16×16 supersampled reference, check that the covered area is as
+// the exact area, and that an ellipse given by a bounding rectangle stays within it, as GDI
+// `Ellipse` does. The throughput is ellipses per second at a range of radii, at random
+// positions in a 1920×1080 buffer.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I../.include raster-ellipses.cpp -o raster-ellipses
+//      ./raster-ellipses
+
+#include <raster/Pixel_view_32.hpp>
+#include <raster/Style.hpp>
+#include <raster/ellipses.hpp>
+#include <raster/primitives.hpp>
+
+#include <math.h>       // acos, fabs
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // abs, EXIT_...
+
+#include <algorithm>    // std::max
+#include <chrono>
+#include <random>       // std::mt19937
+#include <vector>
+
+namespace chr   = std::chrono;
+using   raster::Pixel, raster::Pixel_buffer_32, raster::Pixel_view_32, raster::Rect, raster::Style;
+using   std::max,
+        std::mt19937, std::uniform_real_distribution,
+        std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+const double pi = acos( -1 );
+
+const Pixel blue    = raster::rgb( 0, 0, 255 );
+const Pixel yellow  = raster::rgb( 255, 255, 0 );
+const Pixel orange  = raster::rgb( 255, 165, 0 );
+
+const Style gdi_style = { yellow, orange, 1.0 };
+
+void check( const bool condition, const char* const message )
+{
+    if( not condition ) {
+        fprintf( stderr, "!%s\n", message );
+        ++the_n_failures;
+    }
+}
+
+auto channel( const Pixel p, const int i ) -> int { return int( (p >> (8*i)) & 0xFF ); }
+
+auto is_near( const Pixel a, const Pixel b )
+    -> bool
+{
+    for( int i = 0; i < 4; ++i ) { if( abs( channel( a, i ) - channel( b, i ) ) > 8 ) { return false; } }
+    return true;
+}
+
+// The largest channel difference from a reference with 16×16 point samples per pixel, each
+// sample background, pen or brush depending on whether it’s inside the outer and inner ellipse.
+auto max_difference_from_reference(
+    const double cx, const double cy, const double rx, const double ry, const Style& style
+    ) -> int
+{
+    const int size = int( 2*max( cx + rx, cy + ry ) ) + 4;
+    Pixel_buffer_32 buffer( size, size, blue );
+    raster::draw_ellipse( buffer.view(), cx, cy, rx, ry, style );
+    const double w = style.pen_width;
+    const auto is_inside = []( double dx, double dy, double a, double b ) -> bool
+    {
+        return a > 0 and b > 0 and (dx/a)*(dx/a) + (dy/b)*(dy/b) <= 1;
+    };
+    int result = 0;
+    for( int y = 0; y < size; ++y ) {
+        for( int x = 0; x < size; ++x ) {
+            double sums[4] = {};
+            for( int sy = 0; sy < 16; ++sy ) {
+                for( int sx = 0; sx < 16; ++sx ) {
+                    const double dx = x + (sx + 0.5)/16 - cx;
+                    const double dy = y + (sy + 0.5)/16 - cy;
+                    const Pixel color = (not is_inside( dx, dy, rx, ry )? blue
+                        : is_inside( dx, dy, rx - w, ry - w )? orange : yellow);
+                    for( int i = 0; i < 4; ++i ) { sums[i] += channel( color, i ); }
+                }
+            }
+            for( int i = 0; i < 4; ++i ) {
+                const int expected = int( sums[i]/256 + 0.5 );
+                result = max( result, abs( channel( buffer.view().at( x, y ), i ) - expected ) );
+            }
+        }
+    }
+    return result;
+}
+
+void check_ellipses()
+{
+    // With the first order distance boundary pixel coverage is off by up to about 0.07.
+    const int tolerance = 24;
+    const double cases[][4] = {
+        {20, 20, 12, 12}, {20.5, 20.5, 12, 12}, {30.3, 18.7, 25.2, 8.4},
+        {10.2, 40.9, 3.3, 31}, {8, 8, 1.5, 1.5}, {40, 40, 33.7, 33.7}
+    };
+    for( const auto& c: cases ) {
+        const int d = max_difference_from_reference( c[0], c[1], c[2], c[3], gdi_style );
+        if( d > tolerance ) {
+            fprintf( stderr, "!Ellipse (%g, %g, %g, %g) differs from the reference by %d.\n", c[0], c[1], c[2], c[3], d );
+            ++the_n_failures;
+        }
+    }
+    const int d = max_difference_from_reference( 50.5, 50, 40, 30, Style{ yellow, orange, 4.5 } );
+    check( d <= tolerance, "A wide pen differs from the reference." );
+
+    // Area: the sum of brush coverage, white on black, is the ellipse area within a pixel.
+    for( const double r: {3.0, 10.0, 50.7} ) {
+        const int size = int( 2*r ) + 4;
+        Pixel_buffer_32 buffer( size, size, 0 );
+        raster::draw_ellipse( buffer.view(), size/2.0 + 0.3, size/2.0, r, r*0.8, Style{ {}, 0xFFFFFFFF } );
+        double sum = 0;
+        for( int i = 0; i < size*size; ++i ) { sum += channel( buffer.data()[i], 0 )/255.0; }
+        const double area = pi*r*r*0.8;
+        check( fabs( sum - area ) < 1.0, "The filled area differs from the exact area." );
+    }
+
+    // GDI `Ellipse` semantics for a bounding rectangle.
+    const Rect bounds = {10, 20, 60, 50};
+    Pixel_buffer_32 canvas( 80, 80, blue );
+    raster::draw_ellipse( canvas.view(), bounds, gdi_style );
+    bool is_within = true;
+    for( int y = 0; y < 80; ++y ) {
+        for( int x = 0; x < 80; ++x ) {
+            const bool inside = (bounds.left <= x and x < bounds.right and bounds.top <= y and y < bounds.bottom);
+            if( not inside and canvas.view().at( x, y ) != blue ) { is_within = false; }
+        }
+    }
+    check( is_within, "The ellipse was drawn outside of its bounding rectangle." );
+    check( canvas.view().at( 35, 35 ) == orange, "The center is not brush colored." );
+    check( is_near( canvas.view().at( 10, 34 ), yellow ) and is_near( canvas.view().at( 59, 35 ), yellow ),
+        "The left or right end of the middle row is not pen colored." );
+
+    // Clipping against the canvas edges, which also exercises the bounds checking asserts.
+    Pixel_buffer_32 small( 16, 9, blue );
+    raster::draw_ellipse( small.view(), -5, 4, 12, 30, gdi_style );
+    raster::draw_ellipse( small.view(), 14.5, 8.5, 3, 3, gdi_style );
+    check( small.view().at( 0, 4 ) == orange, "Clipped ellipse not drawn." );
+}
+
+auto main() -> int
+{
+    check_ellipses();
+
+    const int w = 1920;
+    const int h = 1080;
+    Pixel_buffer_32 canvas( w, h, blue );
+    mt19937 bits( 42 );
+    for( const double r: {2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0, 256.0} ) {
+        uniform_real_distribution<double> x_position( r, w - r );
+        uniform_real_distribution<double> y_position( r, h - r );
+        const int n_ellipses = 2'000 + int( 2e7/(r*r) );
+        vector<double> coordinates;
+        for( int i = 0; i < 1000; ++i ) {
+            coordinates.push_back( x_position( bits ) );  coordinates.push_back( y_position( bits ) );
+        }
+        const auto start = chr::steady_clock::now();
+        for( int i = 0; i < n_ellipses; ++i ) {
+            const double* const p = &coordinates[size_t( 2*(i % 1000) )];
+            raster::draw_ellipse( canvas.view(), p[0], p[1], r, r*0.75, gdi_style );
+        }
+        const double seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+        printf( "radii %5.0f×%-5.0f %12.0f ellipses/s  %8.1f Mpixels/s\n",
+            r, r*0.75, n_ellipses/seconds, n_ellipses*pi*r*r*0.75/seconds/1e6
+            );
+        the_sink = int( canvas.view().at( w/2, h/2 ) );
+    }
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,146 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Checks and throughput of the `raster::kernels` row kernels, for each kernel set that this
+// CPU supports: solid fill, copy, copy with overlap (one pixel right and down within the
+// buffer, which runs the rows and pixels backwards) and masked copy, on bottom-up memory as
+// for a DIB section from `winapi::gdi::Bitmap_32`.
+//
+// The checks compare each set with straightforward per-pixel reference code, for all short
+// row lengths and for overlap in both directions.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I../.include raster-kernels.cpp -o raster-kernels
+//      ./raster-kernels
+
+#include <raster/kernels.hpp>
+#include <raster/Pixel_view_32.hpp>
+#include <raster/primitives.hpp>
+
+#include <stddef.h>     // ptrdiff_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace chr   = std::chrono;
+namespace rk    = raster::kernels;
+using   raster::Pixel, raster::Pixel_buffer_32, raster::Pixel_view_32, raster::Point, raster::Row_order;
+using   std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+void check( const bool condition, const char* const set_name, const char* const message )
+{
+    if( not condition ) {
+        fprintf( stderr, "!%s: %s\n", set_name, message );
+        ++the_n_failures;
+    }
+}
+
+// About half of the values have the top bit, i.e. the mask bit of `masked_copy`, set.
+auto pattern_value( const ptrdiff_t i ) -> Pixel { return Pixel( 0x9E3779B1u*Pixel( i + 1 ) ); }
+
+void check_set( const rk::Set& set )
+{
+    const int max_n = 70;
+    const int max_offset = 10;
+    const int size = max_n + 2*max_offset;
+    for( int n = 0; n <= max_n; ++n ) {
+        vector<Pixel> pixels( size, 0 );
+        set.fill( pixels.data() + max_offset, n, 0xDEADBEEF );
+        bool fill_ok = true;
+        for( int i = 0; i < size; ++i ) {
+            const bool inside = (max_offset <= i and i < max_offset + n);
+            fill_ok = fill_ok and pixels[i] == (inside? 0xDEADBEEF : 0);
+        }
+        check( fill_ok, set.name, "fill differs from the reference." );
+
+        for( int offset = -max_offset; offset <= max_offset; ++offset ) {
+            for( const bool is_masked: {false, true} ) {
+                vector<Pixel> a( size );
+                for( int i = 0; i < size; ++i ) { a[i] = pattern_value( i ); }
+                vector<Pixel> b = a;
+                const vector<Pixel> source = a;
+                Pixel* const p_from = a.data() + max_offset;
+                Pixel* const p_to = p_from + offset;
+                (is_masked? set.masked_copy : set.copy)( p_to, p_from, n );
+                for( int i = 0; i < n; ++i ) {
+                    const Pixel s = source[max_offset + i];
+                    Pixel& d = b[max_offset + offset + i];
+                    if( not is_masked or s & 0x80000000 ) { d = s; }
+                }
+                check( a == b, set.name, (is_masked
+                    ? "masked_copy differs from the reference."
+                    : "copy differs from the reference."
+                    ) );
+            }
+        }
+    }
+}
+
+template< class Func >
+void report_throughput( const char* title, const int width, const int height, const Func& f )
+{
+    const int n_repetitions = 2 + int( 2e8/(double( width )*height) );
+    f();        // Warm-up, e.g. page faults.
+    const auto start = chr::steady_clock::now();
+    for( int i = 0; i < n_repetitions; ++i ) { f(); }
+    const double seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    const double bytes = 4.0*width*height*n_repetitions;
+    printf( "  %-14s %5d×%-5d %8.2f GB/s of pixels written\n", title, width, height, bytes/seconds/1e9 );
+}
+
+// Applies `row_func` to the rows of the views, as `raster::copy_rect` does but without the
+// clipping, so that the measurement is of the kernel.
+template< class Row_func >
+void for_rows( const Pixel_view_32& to, const Pixel_view_32& from, const Row_func& row_func )
+{
+    for( int y = 0; y < to.height(); ++y ) { row_func( to.row( y ), from.row( y ), to.width() ); }
+}
+
+auto main() -> int
+{
+    const vector<const rk::Set*> sets = rk::supported_sets();
+    for( const rk::Set* p_set: sets ) { check_set( *p_set ); }
+    printf( "Kernel sets:" );
+    for( const rk::Set* p_set: sets ) { printf( " %s", p_set->name ); }
+    printf( "; `raster::kernels::best()` is %s.\n", rk::best().name );
+
+    for( const auto& [w, h]: { Point{400, 400}, Point{1920, 1080}, Point{3840, 2160} } ) {
+        Pixel_buffer_32 a( w + 1, h + 1 );
+        Pixel_buffer_32 b( w + 1, h + 1 );
+        for( ptrdiff_t i = 0; i < ptrdiff_t( w + 1 )*(h + 1); ++i ) { b.data()[i] = pattern_value( i ); }
+        const auto bottom_up = [w = w, h = h]( Pixel_buffer_32& buffer ) -> Pixel_view_32
+        {
+            return Pixel_view_32::of_memory( buffer.data(), w + 1, h + 1, 4*(w + 1), Row_order::bottom_up );
+        };
+        const Pixel_view_32 target = bottom_up( a ).sub( {0, 0, w, h} );
+        const Pixel_view_32 source = bottom_up( b ).sub( {0, 0, w, h} );
+        const Pixel_view_32 shifted = bottom_up( a ).sub( {1, 1, w + 1, h + 1} );
+
+        for( const rk::Set* p_set: sets ) {
+            const rk::Set& set = *p_set;
+            printf( "%s:\n", set.name );
+            report_throughput( "fill", w, h, [&]{
+                for( int y = 0; y < h; ++y ) { set.fill( target.row( y ), w, 0xFF0000FF ); }
+            } );
+            report_throughput( "copy", w, h, [&]{ for_rows( target, source, set.copy ); } );
+            report_throughput( "copy, overlap", w, h, [&]{
+                for( int y = h - 1; y >= 0; --y ) { set.copy( shifted.row( y ), target.row( y ), w ); }
+            } );
+            report_throughput( "masked_copy", w, h, [&]{ for_rows( target, source, set.masked_copy ); } );
+            the_sink = int( target.at( w/2, h/2 ) );
+        }
+    }
+
+    // The primitives use `best()`; a spot check that they reach the kernels correctly.
+    Pixel_buffer_32 sprite( 3, 1 );
+    sprite.data()[0] = 0xFF112233;  sprite.data()[1] = 0x7F445566;  sprite.data()[2] = 0x80778899;
+    Pixel_buffer_32 canvas( 4, 2, 0xFF000000 );
+    raster::blit_masked( sprite.view(), canvas.view(), {1, 1} );
+    const Pixel* const p_row = canvas.view().row( 1 );
+    check( p_row[0] == 0xFF000000 and p_row[1] == 0xFF112233 and p_row[2] == 0xFF000000 and p_row[3] == 0x80778899,
+        "raster::blit_masked", "wrong result." );
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,181 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Checks and throughput of the `raster` software primitives on `Pixel_view_32`: fill,
+// `copy_rect` (also within one buffer with overlap), `blit` and `blit_blended`, for top-down
+// and bottom-up memory, as for a DIB section from `winapi::gdi::Bitmap_32`.
+//
+// The checks compare with straightforward per-pixel reference code.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I../.include raster-primitives.cpp -o raster-primitives
+//      ./raster-primitives
+
+#include <raster/Pixel_view_32.hpp>
+#include <raster/primitives.hpp>
+
+#include <math.h>       // lround
+#include <stdint.h>     // uint32_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <chrono>
+#include <vector>
+
+namespace chr   = std::chrono;
+using   raster::Pixel, raster::Pixel_buffer_32, raster::Pixel_view_32, raster::Point, raster::Rect,
+        raster::Row_order;
+using   std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+void check( const bool condition, const char* const message )
+{
+    if( not condition ) {
+        fprintf( stderr, "!%s\n", message );
+        ++the_n_failures;
+    }
+}
+
+auto pattern_value( const int x, const int y ) -> Pixel { return Pixel( 0x01000193u*(x*7919 + y*104729) ); }
+
+void fill_with_pattern( const Pixel_view_32& view )
+{
+    for( int y = 0; y < view.height(); ++y ) {
+        for( int x = 0; x < view.width(); ++x ) { view.at( x, y ) = pattern_value( x, y ); }
+    }
+}
+
+auto equal( const Pixel_view_32& a, const Pixel_view_32& b )
+    -> bool
+{
+    if( a.width() != b.width() or a.height() != b.height() ) { return false; }
+    for( int y = 0; y < a.height(); ++y ) {
+        for( int x = 0; x < a.width(); ++x ) { if( a.at( x, y ) != b.at( x, y ) ) { return false; } }
+    }
+    return true;
+}
+
+// Copy via a temporary, as if the source were separate from the target.
+void reference_copy( const Pixel_view_32& view, const Rect& area, const Point& destination )
+{
+    vector<Pixel> copy;
+    for( int y = area.top; y < area.bottom; ++y ) {
+        for( int x = area.left; x < area.right; ++x ) {
+            const bool inside = (0 <= x and x < view.width() and 0 <= y and y < view.height());
+            copy.push_back( inside? view.at( x, y ) : 0 );
+        }
+    }
+    for( int y = area.top; y < area.bottom; ++y ) {
+        for( int x = area.left; x < area.right; ++x ) {
+            const int tx = destination.x + x - area.left;
+            const int ty = destination.y + y - area.top;
+            const bool source_inside = (0 <= x and x < view.width() and 0 <= y and y < view.height());
+            const bool target_inside = (0 <= tx and tx < view.width() and 0 <= ty and ty < view.height());
+            if( source_inside and target_inside ) {
+                view.at( tx, ty ) = copy[size_t( (y - area.top)*area.width() + (x - area.left) )];
+            }
+        }
+    }
+}
+
+void check_views_and_copies()
+{
+    const int w = 37;
+    const int h = 23;
+    const int stride = 40;      // Pixels, i.e. rows with padding.
+    vector<Pixel> memory( size_t( stride )*h );
+    const Pixel_view_32 bottom_up = Pixel_view_32::of_memory(
+        memory.data(), w, h, 4*stride, Row_order::bottom_up
+        );
+    bottom_up.at( 0, 0 ) = 42;
+    check( memory[size_t( stride )*(h - 1)] == 42, "Bottom-up view: top left pixel not in the last row." );
+    bottom_up.at( 5, h - 1 ) = 43;
+    check( memory[5] == 43, "Bottom-up view: bottom row not at the start of the memory." );
+
+    const Rect areas[] = { {3, 4, 20, 15}, {-5, -3, 10, 8}, {30, 18, 45, 30}, {0, 0, w, h} };
+    const Point destinations[] = { {5, 6}, {1, 2}, {-4, 7}, {25, 15}, {0, 0}, {3, -2} };
+    for( const Row_order::Enum order: {Row_order::top_down, Row_order::bottom_up} ) {
+        vector<Pixel> memory_a( size_t( stride )*h );
+        vector<Pixel> memory_b( size_t( stride )*h );
+        const Pixel_view_32 a = Pixel_view_32::of_memory( memory_a.data(), w, h, 4*stride, order );
+        const Pixel_view_32 b = Pixel_view_32::of_memory( memory_b.data(), w, h, 4*stride, order );
+        for( const Rect& area: areas ) {
+            for( const Point& destination: destinations ) {
+                fill_with_pattern( a );  fill_with_pattern( b );
+                raster::copy_rect( a, area, a, destination );       // Within one buffer.
+                reference_copy( b, area, destination );
+                check( equal( a, b ), "copy_rect within a buffer differs from the reference." );
+            }
+        }
+    }
+
+    Pixel_buffer_32 target( 16, 16, 0xFF000000 );
+    Pixel_buffer_32 source( 8, 8 );
+    fill_with_pattern( source.view() );
+    raster::blit( source.view(), target.view(), {12, -3} );
+    check( target.view().at( 12, 0 ) == pattern_value( 0, 3 ), "Clipped blit misplaced." );
+    check( target.view().at( 11, 0 ) == 0xFF000000 and target.view().at( 12, 5 ) == 0xFF000000,
+        "Clipped blit wrote outside of the clipped area." );
+
+    raster::fill( target.view(), {2, 2, 6, 4}, raster::rgb( 1, 2, 3 ) );
+    check( target.view().at( 2, 2 ) == raster::rgb( 1, 2, 3 ) and target.view().at( 5, 3 ) == raster::rgb( 1, 2, 3 )
+        and target.view().at( 6, 3 ) == 0xFF000000 and target.view().at( 5, 4 ) == 0xFF000000,
+        "Rectangle fill covers the wrong pixels." );
+}
+
+void check_blending()
+{
+    int n_wrong = 0;
+    for( int alpha = 0; alpha <= 255; ++alpha ) {
+        for( int s = 0; s <= 255; s += 5 ) {
+            for( int d = 0; d <= 255; d += 3 ) {
+                Pixel_buffer_32 target( 1, 1, raster::rgb( d, 255 - d, d/2, 255 - s ) );
+                Pixel_buffer_32 source( 1, 1, raster::rgb( s, 255 - s, s/2, alpha ) );
+                raster::blit_blended( source.view(), target.view(), {0, 0} );
+                const Pixel result = target.view().at( 0, 0 );
+                const auto expected = [alpha]( const int sv, const int dv ) -> Pixel
+                {
+                    return Pixel( lround( (sv*alpha + dv*(255 - alpha))/255.0 ) );
+                };
+                const Pixel wanted = expected( 255, 255 - s ) << 24 | expected( s, d ) << 16
+                    | expected( 255 - s, 255 - d ) << 8 | expected( s/2, d/2 );
+                if( result != wanted ) { ++n_wrong; }
+            }
+        }
+    }
+    if( n_wrong > 0 ) {
+        fprintf( stderr, "!blit_blended: %d results differ from the rounded exact values.\n", n_wrong );
+        ++the_n_failures;
+    }
+}
+
+template< class Func >
+void report_throughput( const char* title, const int width, const int height, const Func& f )
+{
+    const int n_repetitions = 2 + int( 2e8/(double( width )*height) );
+    const auto start = chr::steady_clock::now();
+    for( int i = 0; i < n_repetitions; ++i ) { f(); }
+    const double seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    const double bytes = 4.0*width*height*n_repetitions;
+    printf( "%-14s %5d×%-5d %8.2f GB/s of pixels written\n", title, width, height, bytes/seconds/1e9 );
+}
+
+auto main() -> int
+{
+    check_views_and_copies();
+    check_blending();
+
+    for( const auto& [w, h]: { Point{400, 400}, Point{1920, 1080}, Point{3840, 2160} } ) {
+        Pixel_buffer_32 a( w, h );
+        Pixel_buffer_32 b( w, h, raster::rgb( 255, 165, 0, 128 ) );
+        const Pixel_view_32 bottom_up = Pixel_view_32::of_memory( a.data(), w, h, 4*w, Row_order::bottom_up );
+        report_throughput( "fill", w, h, [&]{ raster::fill( bottom_up, raster::rgb( 0, 0, 255 ) ); } );
+        report_throughput( "blit", w, h, [&]{ raster::blit( b.view(), bottom_up, {0, 0} ); } );
+        report_throughput( "copy_rect, +1", w, h, [&]{
+            raster::copy_rect( bottom_up, bottom_up.bounds(), bottom_up, {1, 1} );
+        } );
+        report_throughput( "blit_blended", w, h, [&]{ raster::blit_blended( b.view(), bottom_up, {0, 0} ); } );
+        the_sink = int( bottom_up.at( w/2, h/2 ) );
+    }
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,122 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Benchmark of `cpp::util::Result_` versus exceptions for reporting failure: the time per
+// call and the number of heap allocations per call, for the success and the failure path, of
+// a small check such as would be done per pixel or per character.
+//
+// The exception version is the `hopefully(...) or CPPUTIL_FAIL(...)` idiom. Allocations are
+// counted by replacing the global `operator new`.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I../.include result-vs-exceptions.cpp -o result-vs-exceptions
+//      ./result-vs-exceptions
+
+#include <cpp/util.hpp>
+
+#include <stdint.h>     // int64_t, uint8_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // malloc, free, EXIT_...
+
+#include <chrono>
+#include <exception>    // std::exception
+#include <new>          // std::bad_alloc
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   cu::hopefully, cu::Result_;
+
+static int64_t the_n_allocations = 0;
+
+auto operator new( const size_t size )
+    -> void*
+{
+    ++the_n_allocations;
+    if( void* const p = malloc( size == 0? 1 : size ) ) { return p; }
+    throw std::bad_alloc();
+}
+
+void operator delete( void* const p ) noexcept { free( p ); }
+void operator delete( void* const p, size_t ) noexcept { free( p ); }
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+
+// The two ways of reporting an out of range color channel value.
+
+[[gnu::noinline]] auto checked_channel( const int v )
+    -> Result_<uint8_t>
+{
+    if( v < 0 or v > 255 ) { return CPPUTIL_ERROR( v, "Channel value out of range" ); }
+    return uint8_t( v );
+}
+
+[[gnu::noinline]] auto channel_or_exception( const int v )
+    -> uint8_t
+{
+    hopefully( 0 <= v and v <= 255 ) or CPPUTIL_FAIL( "Channel value out of range" );
+    return uint8_t( v );
+}
+
+struct Measurement{ double ns_per_call; double allocations_per_call; };
+
+template< class Func >
+auto measure( const int64_t n_calls, const Func& f )
+    -> Measurement
+{
+    const int64_t n_allocations_before = the_n_allocations;
+    const auto start = chr::steady_clock::now();
+    for( int64_t i = 0; i < n_calls; ++i ) { f( i ); }
+    const double seconds = chr::duration<double>( chr::steady_clock::now() - start ).count();
+    return {1e9*seconds/n_calls, double( the_n_allocations - n_allocations_before )/n_calls};
+}
+
+void report( const char* title, const Measurement& m )
+{
+    printf( "%-36s %12.2f %14.2f\n", title, m.ns_per_call, m.allocations_per_call );
+}
+
+auto main() -> int
+{
+    const int64_t n_fast_calls = 50'000'000;
+    const int64_t n_slow_calls = 500'000;
+    int checksum = 0;
+    int n_failures = 0;
+
+    printf( "%-36s %12s %14s\n", "", "ns/call", "allocs/call" );
+    report( "Result_, success", measure( n_fast_calls, [&]( const int64_t i ) {
+        const Result_<uint8_t> r = checked_channel( int( i & 0xFF ) );
+        if( r ) { checksum += r.value(); } else { ++n_failures; }
+    } ) );
+    report( "exception, success", measure( n_fast_calls, [&]( const int64_t i ) {
+        try {
+            checksum += channel_or_exception( int( i & 0xFF ) );
+        } catch( const std::exception& ) {
+            ++n_failures;
+        }
+    } ) );
+    report( "Result_, failure", measure( n_slow_calls, [&]( const int64_t i ) {
+        const Result_<uint8_t> r = checked_channel( 256 + int( i & 0xFF ) );
+        if( r ) { checksum += r.value(); } else { ++n_failures; checksum += r.error().code; }
+    } ) );
+    report( "exception, failure", measure( n_slow_calls, [&]( const int64_t i ) {
+        try {
+            checksum += channel_or_exception( 256 + int( i & 0xFF ) );
+        } catch( const std::exception& x ) {
+            ++n_failures;
+            checksum += x.what()[0];
+        }
+    } ) );
+    report( "Result_, failure, or_throw()", measure( n_slow_calls, [&]( const int64_t i ) {
+        try {
+            checksum += checked_channel( 256 + int( i & 0xFF ) ).or_throw();
+        } catch( const std::exception& x ) {
+            ++n_failures;
+            checksum += x.what()[0];
+        }
+    } ) );
+    the_sink = checksum;
+
+    if( n_failures != 3*n_slow_calls ) {
+        fprintf( stderr, "!Expected %lld failures, got %d.\n", 3*(long long) n_slow_calls, n_failures );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Micro-benchmark suite for the portable cores in `.include`: the random and `Range` helpers,
+// the `raster` pixel operations on 32-bit bitmap memory, and UTF-8 ⇄ UTF-16 conversion. The
+// tic-tac-toe engine has its own suite, `docs/04/code/tic-tac-toe/v6/benchmarks/suite.cpp`;
+// `tools/run-benchmark-suite.sh` builds and runs both.
+//
+// Options, as `cpp::util::benchmarking::options_from`: `--format text|csv|json`, `--filter`,
+// `--min-time` and `--samples`.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -I../.include suite.cpp -o suite
+//      ./suite --format csv
+
+#include <cpp/benchmarking.hpp>
+#include <cpp/utf.hpp>
+#include <cpp/util.hpp>
+#include <raster/Pixel_view_32.hpp>
+#include <raster/primitives.hpp>
+
+#include <stdio.h>      // fputs, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <exception>    // std::exception
+#include <string>
+
+namespace cu    = cpp::util;
+namespace bm    = cpp::util::benchmarking;
+using   cu::Range;
+using   raster::Pixel_buffer_32;
+using   std::exception,
+        std::string, std::u16string;
+
+auto repeated( const string& s, const int n )
+    -> string
+{
+    string result;
+    for( int i = 0; i < n; ++i ) { result += s; }
+    return result;
+}
+
+void cpp_main( const int n_args, char** args )
+{
+    bm::Runner runner( bm::options_from( n_args, args ) );
+
+    runner.run( "util/random_in 1..6", []{ bm::do_not_optimize( cu::random_in({ 1, 6 }) ); } );
+    runner.run( "util/random_up_to 1000", []{ bm::do_not_optimize( cu::random_up_to( 1000 ) ); } );
+    int v = 0;
+    runner.run( "util/is_in", [&v]{
+        const Range range = {100, 200};
+        bm::do_not_optimize( v );
+        bm::do_not_optimize( cu::is_in( range, v++ & 0xFF ) );
+    } );
+
+    for( const int size: {400, 1920} ) {
+        const string dims = std::to_string( size ) + "×" + std::to_string( size*9/16 );
+        Pixel_buffer_32 a( size, size*9/16, raster::rgb( 255, 165, 0, 128 ) );    // Half transparent.
+        Pixel_buffer_32 b( size, size*9/16 );
+        runner.run( "pixels/fill " + dims, [&]{
+            raster::fill( b.view(), raster::rgb( 0, 0, 255 ) );
+            bm::clobber_memory();
+        } );
+        runner.run( "pixels/blit " + dims, [&]{
+            raster::blit( a.view(), b.view(), {0, 0} );
+            bm::clobber_memory();
+        } );
+        runner.run( "pixels/blit_blended " + dims, [&]{
+            raster::blit_blended( a.view(), b.view(), {0, 0} );
+            bm::clobber_memory();
+        } );
+    }
+
+    const string ascii = repeated( "The quick brown fox jumps over the lazy dog. ", 23 );
+    const string mixed = repeated( "Blåbærsyltetøy, π ≈ 3.14159, “quoted” 😀. ", 23 );
+    for( const string* p_text: {&ascii, &mixed} ) {
+        const string& text = *p_text;
+        const string kind = (p_text == &ascii? "ascii" : "mixed");
+        const u16string wide = cu::utf16_from_utf8( text );
+        if( cu::utf8_from_utf16( wide ) != text ) {
+            CPPUTIL_FAIL( "The UTF-8 → UTF-16 → UTF-8 round trip changed the " + kind + " text." );
+        }
+        u16string wide_buffer;
+        string narrow_buffer;
+        const string suffix = " " + kind + " " + std::to_string( text.size() ) + " bytes";
+        runner.run( "utf/utf16_from_utf8" + suffix, [&]{
+            wide_buffer = cu::try_utf16_from_utf8( text, std::move( wide_buffer ) ).or_throw();
+            bm::do_not_optimize( wide_buffer );
+        } );
+        runner.run( "utf/utf8_from_utf16" + suffix, [&]{
+            narrow_buffer = cu::try_utf8_from_utf16( wide, std::move( narrow_buffer ) ).or_throw();
+            bm::do_not_optimize( narrow_buffer );
+        } );
+    }
+    const bool invalid_is_rejected = not cu::try_utf16_from_utf8( "\xC0\xAF" ).is_ok()
+        and not cu::try_utf16_from_utf8( "\xED\xA0\x80" ).is_ok()
+        and not cu::try_utf8_from_utf16( u"\xD800" ).is_ok();
+    cu::hopefully( invalid_is_rejected ) or CPPUTIL_FAIL( "Invalid UTF input was accepted." );
+
+    fputs( runner.report().c_str(), stdout );
+}
+
+auto main( int n_args, char** args ) -> int
+{
+    try {
+        cpp_main( n_args, args );
+        return EXIT_SUCCESS;
+    } catch( const exception& x ) {
+        fprintf( stderr, "!%s\n", x.what() );
+    }
+    return EXIT_FAILURE;
+}
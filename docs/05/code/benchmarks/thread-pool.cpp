@@ -0,0 +1,184 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Benchmark of `cpp::util::Thread_pool`: the scheduling overhead per task, for tasks submitted
+// from outside the pool and for tasks spawned recursively by workers, and the scaling
+// efficiency of `parallel_for` over a compute bound loop for 1, 2, 4, … threads.
+//
+// The efficiency is the speedup over 1 thread divided by the number of threads, capped at the
+// number of hardware threads. Also checks that `parallel_for` calls the body exactly once per
+// value, and that cancellation and exceptions work.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I../.include thread-pool.cpp -o thread-pool
+//      ./thread-pool
+
+#include <cpp/Thread_pool.hpp>
+#include <cpp/util.hpp>
+
+#include <math.h>       // sqrt
+#include <stdint.h>     // int64_t
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // EXIT_...
+
+#include <algorithm>    // std::min
+#include <atomic>
+#include <chrono>
+#include <stdexcept>    // std::runtime_error
+#include <thread>
+#include <vector>
+
+namespace cu    = cpp::util;
+namespace chr   = std::chrono;
+using   cu::Range, cu::Task_group, cu::Thread_pool, cu::parallel_for;
+using   std::min,
+        std::atomic,
+        std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+template< class Func >
+auto seconds_for( const Func& f )
+    -> double
+{
+    const auto start = chr::steady_clock::now();
+    f();
+    return chr::duration<double>( chr::steady_clock::now() - start ).count();
+}
+
+void spawn_tree( Task_group& group, atomic<int64_t>& n_leaves, const int depth )
+{
+    if( depth == 0 ) {
+        n_leaves.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    group.run( [&group, &n_leaves, depth]{ spawn_tree( group, n_leaves, depth - 1 ); } );
+    spawn_tree( group, n_leaves, depth - 1 );
+}
+
+// Some floating point work per value, roughly 100 ns.
+auto work_for( const int i )
+    -> double
+{
+    double x = i;
+    for( int j = 0; j < 40; ++j ) { x = sqrt( x + j ); }
+    return x;
+}
+
+void report_overhead( Thread_pool& pool )
+{
+    const int n_tasks = 1'000'000;
+    atomic<int64_t> n_done = 0;
+    const double external_seconds = seconds_for( [&]{
+        Task_group group( pool );
+        for( int i = 0; i < n_tasks; ++i ) {
+            group.run( [&n_done]{ n_done.fetch_add( 1, std::memory_order_relaxed ); } );
+        }
+        group.wait();
+    } );
+
+    const int depth = 20;       // 2^20 leaves, 2^20 - 1 spawned tasks.
+    atomic<int64_t> n_leaves = 0;
+    const double recursive_seconds = seconds_for( [&]{
+        Task_group group( pool );
+        group.run( [&]{ spawn_tree( group, n_leaves, depth ); } );
+        group.wait();
+    } );
+
+    printf( "%2d threads: %7.1f ns/task submitted from outside, %7.1f ns/task spawned by workers.\n",
+        pool.n_threads(), 1e9*external_seconds/n_tasks, 1e9*recursive_seconds/(1 << depth)
+        );
+    if( n_done != n_tasks or n_leaves != (1 << depth) ) {
+        fprintf( stderr, "!Expected %d and %d tasks done, got %lld and %lld.\n",
+            n_tasks, 1 << depth, (long long) n_done.load(), (long long) n_leaves.load()
+            );
+        ++the_n_failures;
+    }
+}
+
+auto parallel_sum( Thread_pool& pool, const int n, const int grain_size )
+    -> double
+{
+    const int n_chunks = (n + grain_size - 1)/grain_size;
+    vector<double> sums( n_chunks );
+    Task_group group( pool );
+    parallel_for( group, Range{ 0, n - 1 }, grain_size, [&]( const Range& r ) {
+        double sum = 0;
+        for( int i = r.first; i <= r.last; ++i ) { sum += work_for( i ); }
+        sums[r.first/grain_size] = sum;     // Chunks are grain aligned since n is a power of 2.
+    } );
+    double result = 0;
+    for( const double sum: sums ) { result += sum; }
+    return result;
+}
+
+void check_coverage_and_cancellation( Thread_pool& pool )
+{
+    const int n = 100'003;
+    vector<atomic<int>> counts( n );
+    for( atomic<int>& c: counts ) { c = 0; }
+    Task_group group( pool );
+    parallel_for( group, Range{ 0, n - 1 }, 7, [&]( const Range& r ) {
+        for( int i = r.first; i <= r.last; ++i ) { ++counts[i]; }
+    } );
+    int n_wrong = 0;
+    for( const atomic<int>& c: counts ) { if( c != 1 ) { ++n_wrong; } }
+    if( n_wrong > 0 ) {
+        fprintf( stderr, "!parallel_for: %d of %d values not visited exactly once.\n", n_wrong, n );
+        ++the_n_failures;
+    }
+
+    atomic<int> n_run = 0;
+    Task_group cancelled_group( pool );
+    cancelled_group.cancel();
+    for( int i = 0; i < 1000; ++i ) { cancelled_group.run( [&n_run]{ ++n_run; } ); }
+    cancelled_group.wait();
+    if( n_run != 0 ) {
+        fprintf( stderr, "!%d tasks of a cancelled group were run.\n", n_run.load() );
+        ++the_n_failures;
+    }
+
+    bool was_thrown = false;
+    try {
+        parallel_for( Range{ 0, 9999 }, 10, [&]( const Range& r ) {
+            if( cu::is_in( r, 5000 ) ) { throw std::runtime_error( "Oops" ); }
+        } );
+    } catch( const std::runtime_error& ) {
+        was_thrown = true;
+    }
+    if( not was_thrown ) {
+        fprintf( stderr, "!An exception in parallel_for was not propagated.\n" );
+        ++the_n_failures;
+    }
+}
+
+auto main() -> int
+{
+    const int n_hardware_threads = std::max( 1, int( std::thread::hardware_concurrency() ) );
+    printf( "%d hardware threads.\n\n", n_hardware_threads );
+
+    const int n = 1 << 22;
+    const int grain_size = 1 << 12;
+    double single_thread_seconds = 0;
+    double reference_sum = 0;
+    for( int n_threads = 1; n_threads <= 2*n_hardware_threads or n_threads <= 4; n_threads *= 2 ) {
+        Thread_pool pool( n_threads );
+        report_overhead( pool );
+        check_coverage_and_cancellation( pool );
+
+        double sum = 0;
+        const double seconds = seconds_for( [&]{ sum = parallel_sum( pool, n, grain_size ); } );
+        if( n_threads == 1 ) {
+            single_thread_seconds = seconds;
+            reference_sum = sum;
+        } else if( sum != reference_sum ) {
+            fprintf( stderr, "!%d threads: sum %.17g, expected %.17g.\n", n_threads, sum, reference_sum );
+            ++the_n_failures;
+        }
+        const double speedup = single_thread_seconds/seconds;
+        printf( "%2d threads: parallel_for %.3f s, speedup %.2f, efficiency %.0f%%.\n\n",
+            n_threads, seconds, speedup, 100*speedup/min( n_threads, n_hardware_threads )
+            );
+        the_sink = int( sum );
+    }
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,135 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Frame time of `raster::Tile_renderer` versus number of threads, for a scene of 10 000
+// rotated antialiased ellipses with outlines in a 3840×2160 image, compared with drawing the
+// display list directly in one thread. Also checks that tiled rendering gives exactly the
+// same pixels as direct drawing, and shows the effect of the tile size.
+//
+// The thread counts are the powers of 2 up to the number of hardware threads, and that
+// number; an optional command line argument gives another maximum.
+//
+// Build & run, e.g. in Linux:
+//      g++ -std=c++17 -O2 -pthread -I../.include tile-renderer.cpp -o tile-renderer
+//      ./tile-renderer
+
+#include <cpp/Thread_pool.hpp>
+#include <raster/Affine.hpp>
+#include <raster/Pixel_view_32.hpp>
+#include <raster/Style.hpp>
+#include <raster/Tile_renderer.hpp>
+
+#include <math.h>       // acos
+#include <stdio.h>      // printf, fprintf
+#include <stdlib.h>     // atoi, EXIT_...
+
+#include <algorithm>    // std::(equal, max, sort)
+#include <chrono>
+#include <random>       // std::mt19937
+#include <thread>       // std::thread
+#include <vector>
+
+namespace chr   = std::chrono;
+namespace cu    = cpp::util;
+using   raster::Affine, raster::Display_list, raster::Pixel, raster::Pixel_buffer_32, raster::Style,
+        raster::Tile_renderer;
+using   std::max, std::sort,
+        std::mt19937, std::uniform_int_distribution, std::uniform_real_distribution,
+        std::vector;
+
+static volatile int the_sink;     // Keeps the measured work from being optimized away.
+static int the_n_failures = 0;
+
+const double pi = acos( -1 );
+
+const int width         = 3840;
+const int height        = 2160;
+const int n_ellipses    = 10'000;
+const int n_frames      = 7;
+
+auto scene()
+    -> Display_list
+{
+    Display_list result( raster::rgb( 0, 0, 255 ) );
+    mt19937 bits( 42 );
+    uniform_real_distribution<double> x_position( 0, width );
+    uniform_real_distribution<double> y_position( 0, height );
+    uniform_real_distribution<double> radius( 4, 64 );
+    uniform_real_distribution<double> aspect( 0.3, 1 );
+    uniform_real_distribution<double> angle( 0, pi );
+    uniform_int_distribution<int> channel( 0, 255 );
+    for( int i = 0; i < n_ellipses; ++i ) {
+        const double rx = radius( bits );
+        const Affine transform = Affine::rotation( angle( bits ) ).then(
+            Affine::translation( x_position( bits ), y_position( bits ) )
+            );
+        const Style style = {
+            raster::rgb( 255, 255, channel( bits )/4 ),
+            raster::rgb( 255, channel( bits ), 0 )
+        };
+        result.add_ellipse( {0, 0}, rx, rx*aspect( bits ), transform, style );
+    }
+    return result;
+}
+
+// The median time of `n_frames` calls, in seconds.
+template< class Func >
+auto frame_time( const Func& render_frame )
+    -> double
+{
+    vector<double> times;
+    for( int i = 0; i < n_frames; ++i ) {
+        const auto start = chr::steady_clock::now();
+        render_frame();
+        times.push_back( chr::duration<double>( chr::steady_clock::now() - start ).count() );
+    }
+    sort( times.begin(), times.end() );
+    return times[times.size()/2];
+}
+
+auto main( int n_args, char** args ) -> int
+{
+    const int n_hardware_threads = max<int>( 1, int( std::thread::hardware_concurrency() ) );
+    const int max_threads = (n_args > 1? max( 1, atoi( args[1] ) ) : n_hardware_threads);
+
+    const auto build_start = chr::steady_clock::now();
+    const Display_list list = scene();
+    const double build_seconds = chr::duration<double>( chr::steady_clock::now() - build_start ).count();
+
+    Pixel_buffer_32 direct_image( width, height );
+    Pixel_buffer_32 tiled_image( width, height );
+    const double direct_seconds = frame_time( [&]{ raster::draw_directly( list, direct_image.view() ); } );
+
+    printf( "%d ellipses in %d×%d, %d hardware threads; display list set up in %.2f ms.\n\n",
+        n_ellipses, width, height, n_hardware_threads, 1e3*build_seconds
+        );
+    printf( "%-22s %10s %10s %12s\n", "", "ms/frame", "frames/s", "vs direct" );
+    printf( "%-22s %10.2f %10.1f %12s\n", "direct, 1 thread", 1e3*direct_seconds, 1/direct_seconds, "1.00" );
+
+    vector<int> thread_counts;
+    for( int n = 1; n < max_threads; n *= 2 ) { thread_counts.push_back( n ); }
+    thread_counts.push_back( max_threads );
+    for( const int n_threads: thread_counts ) {
+        cu::Thread_pool pool( n_threads );
+        Tile_renderer renderer( pool );
+        const double seconds = frame_time( [&]{ renderer.render( list, tiled_image.view() ); } );
+        char title[64];
+        snprintf( title, sizeof( title ), "tiled, %d thread%s", n_threads, (n_threads == 1? "" : "s") );
+        printf( "%-22s %10.2f %10.1f %12.2f\n", title, 1e3*seconds, 1/seconds, direct_seconds/seconds );
+        const Pixel* const p_tiled = tiled_image.data();
+        if( not std::equal( p_tiled, p_tiled + size_t( width )*height, direct_image.data() ) ) {
+            fprintf( stderr, "!Tiled rendering with %d threads differs from direct drawing.\n", n_threads );
+            ++the_n_failures;
+        }
+    }
+
+    printf( "\n" );
+    for( const int tile_size: {32, 64, 128, 256} ) {
+        cu::Thread_pool pool( max_threads );
+        Tile_renderer renderer( pool, tile_size );
+        const double seconds = frame_time( [&]{ renderer.render( list, tiled_image.view() ); } );
+        char title[64];
+        snprintf( title, sizeof( title ), "%d×%d tiles", tile_size, tile_size );
+        printf( "%-22s %10.2f %10.1f %12.2f\n", title, 1e3*seconds, 1/seconds, direct_seconds/seconds );
+    }
+    the_sink = int( tiled_image.view().at( width/2, height/2 ) );
+    return (the_n_failures == 0? EXIT_SUCCESS : EXIT_FAILURE);
+}
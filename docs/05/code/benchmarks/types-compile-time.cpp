@@ -0,0 +1,105 @@
+﻿# // Source encoding: utf-8  --  π is (or should be) a lowercase greek pi.
+// Compile time benchmark of `cpp::util::Types_`: instantiates thousands of type lists and
+// queries each with `index_of_first_` and `index_of_first_of_`, either with the current
+// scanning implementation or, with `TYPES_RECURSIVE` defined, with the earlier implementation
+// by recursive class template instantiation, copied below. Compare front-end time and memory:
+//
+//      g++ -std=c++17 -fsyntax-only -ftime-report -I../.include types-compile-time.cpp
+//      g++ -std=c++17 -fsyntax-only -ftime-report -I../.include -DTYPES_RECURSIVE types-compile-time.cpp
+//
+// The “TOTAL” line of the report gives the time and the memory of the compiler’s garbage
+// collected heap; in Linux `/usr/bin/time -v` also gives the peak resident memory. With
+// MSVC use `/d1reportTime`. `N_LISTS` and `LIST_LENGTH` can be defined to scale the test.
+
+#include <cpp/util.hpp>
+
+#include <stddef.h>     // size_t
+
+#include <type_traits>  // std::(add_pointer_t, is_pointer, is_same_v)
+#include <utility>      // std::(index_sequence, make_index_sequence)
+
+#ifndef N_LISTS
+#   define N_LISTS      1000
+#endif
+#ifndef LIST_LENGTH
+#   define LIST_LENGTH  32
+#endif
+
+using   std::add_pointer_t, std::is_pointer, std::is_same_v,
+        std::index_sequence, std::make_index_sequence;
+
+#ifdef TYPES_RECURSIVE
+    namespace recursive {
+        using cpp::util::Is_one_of_;
+
+        constexpr auto successor_if_not_negative( const int v ) -> int { return (v < 0? v : 1 + v); }
+
+        template< template <class> class Is_match_, class... Args > struct First_match_;
+
+        template< template <class> class Is_match_ > struct First_match_< Is_match_> { enum{ index = -1 }; };
+
+        template< template <class> class Is_match_, class First, class... More_args >
+        struct First_match_< Is_match_, First, More_args... >
+        {
+            enum
+            { index = Is_match_< First >::value
+                ? 0
+                : successor_if_not_negative( First_match_< Is_match_, More_args... >::index )
+            };
+        };
+
+        template< class... Types >
+        struct Types_
+        {
+            template< class T >
+            static constexpr int index_of_first_ =
+                First_match_< Is_one_of_<T>::template Result_, Types... >::index;
+
+            template< class... T >
+            static constexpr int index_of_first_of_ =
+                First_match_< Is_one_of_<T...>::template Result_, Types... >::index;
+        };
+    }  // namespace recursive
+
+    template< class... Types > using List_ = recursive::Types_< Types... >;
+#else
+    template< class... Types > using List_ = cpp::util::Types_< Types... >;
+#endif
+
+enum{ n_lists = N_LISTS, list_length = LIST_LENGTH };
+
+template< int list, int i > struct Tag_ {};
+
+template< int list, size_t... indices >
+auto list_type( index_sequence< indices... > ) -> List_< Tag_< list, int( indices ) >... >;
+
+template< int list >
+using List_number_ = decltype( list_type< list >( make_index_sequence< list_length >() ) );
+
+template< int list >
+constexpr int sum_of_queries_for =
+    List_number_< list >::template index_of_first_< Tag_< list, list_length - 1 > >
+    + List_number_< list >::template index_of_first_of_< void, Tag_< list, list_length/2 > >
+    + List_number_< list >::template index_of_first_< void >;
+
+template< size_t... lists >
+constexpr auto sum_of_all_queries( index_sequence< lists... > )
+    -> long
+{ return (0L + ... + sum_of_queries_for< int( lists ) >); }
+
+static_assert(
+    sum_of_all_queries( make_index_sequence< n_lists >() )
+    == long( n_lists )*((list_length - 1) + list_length/2 - 1)
+    );
+
+#ifndef TYPES_RECURSIVE
+    // The list operations without a recursive counterpart.
+    namespace cu = cpp::util;
+    using Sample = cu::Types_<int, char*, double, void*>;
+    static_assert( is_same_v< Sample::at_<2>, double > );
+    static_assert( is_same_v< Sample::transform_<add_pointer_t>, cu::Types_<int*, char**, double*, void**> > );
+    static_assert( is_same_v< Sample::filter_<is_pointer>, cu::Types_<char*, void*> > );
+    static_assert( is_same_v< cu::Types_<>::filter_<is_pointer>, cu::Types_<> > );
+#endif
+
+auto main() -> int {}
@@ -1,12 +1,18 @@
 ﻿#include "resources.h"                  // Resource identifier macros.
 
+#include <winapi/gdi/Bitmap_32.hpp>     // winapi::gdi::Bitmap_32
 #include <winapi/gdi/color_names.hpp>   // winapi::gdi::color_names::*
 #include <winapi/gui/util.hpp>          // winapi::gui::*, winapi::kernel::*
+#include <cpp/instrumentation.hpp>      // CPPUTIL_TIMED_SCOPE, cpp::util::instrumentation
+#include <raster/Affine.hpp>            // raster::Affine
+#include <raster/Tile_renderer.hpp>     // raster::(Display_list, Tile_renderer)
 
 namespace color = winapi::gdi::color_names;
+namespace wgdi  = winapi::gdi;
 namespace wg    = winapi::gui;
 namespace wk    = winapi::kernel;
 
+#include <stdio.h>      // fopen, fputs, fclose
 #include <stdlib.h>     // EXIT_...
 #include <math.h>
 
@@ -57,8 +63,17 @@ void draw_ellipse( const HDC canvas, const RECT& bounds, const calc::Radians ang
     SetGraphicsMode( canvas, original_mode );               // the mode can be reset.
 }
 
+auto current_angle()
+    -> calc::Radians
+{
+    const auto degrees_per_second = double( 60 );
+    const auto seconds = double( GetTickCount() )/1000;
+    return calc::to_radians( calc::Degrees{ degrees_per_second*seconds } );
+}
+
 void draw_on( const HDC canvas, const RECT& area )
 {
+    CPPUTIL_TIMED_SCOPE( "draw_on" );
     // Clear the background to blue.
     SetDCBrushColor( canvas, color::blue );
     FillRect( canvas, &area, 0 );
@@ -66,11 +81,28 @@ void draw_on( const HDC canvas, const RECT& area )
     // Draw a yellow circle filled with orange.
     SetDCPenColor( canvas, color::yellow );
     SetDCBrushColor( canvas, color::orange );
-    
-    const auto degrees_per_second = double( 60 );
-    const auto seconds = double( GetTickCount() )/1000;
-    const auto angle = calc::to_radians( calc::Degrees{ degrees_per_second*seconds } );
-    draw_ellipse( canvas, area, angle );
+    draw_ellipse( canvas, area, current_angle() );
+}
+
+// As `draw_on` for a DC, but directly in the pixel memory, with no per-shape DC state changes.
+// The scene is a display list that is rendered in 64×64 pixel tiles in parallel, in the
+// shared thread pool.
+void draw_on( const raster::Pixel_view_32& canvas )
+{
+    CPPUTIL_TIMED_SCOPE( "draw_on" );
+    static raster::Tile_renderer the_renderer;      // Only used by the UI thread.
+    raster::Display_list scene( raster::pixel_from_colorref( color::blue ) );
+
+    const int w = canvas.width();
+    const int h = canvas.height();
+    const auto transform = raster::Affine::rotation( current_angle().value ).then(
+        raster::Affine::translation( w/2.0, h/2.0 )
+        );
+    const auto style = raster::Style{
+        raster::pixel_from_colorref( color::yellow ), raster::pixel_from_colorref( color::orange )
+        };
+    scene.add_ellipse( {0, 0}, w/2.0, h/2.0, transform, style );
+    the_renderer.render( scene, canvas );
 }
 
 auto dc_colors_enabled( const HDC dc )
@@ -83,10 +115,13 @@ auto dc_colors_enabled( const HDC dc )
 
 void paint( const HWND window, const HDC dc )
 {
+    CPPUTIL_TIMED_SCOPE( "paint" );
     RECT client_rect;
     GetClientRect( window, &client_rect );
 
-    #ifndef NO_DOUBLEBUFFERING_PLEASE
+    #if defined( NO_DOUBLEBUFFERING_PLEASE )
+        draw_on( dc_colors_enabled( dc ), client_rect );
+    #elif defined( GDI_DRAWING_PLEASE )
         const auto [width, height] = SIZE{ client_rect.right, client_rect.bottom };
 
         // Create an off-screen DC with a compatible bitmap, for double-buffering.
@@ -102,7 +137,18 @@ void paint( const HWND window, const HDC dc )
         DeleteObject( bitmap );
         DeleteDC( memory_dc);
     #else
-        draw_on( dc_colors_enabled( dc ), client_rect );
+        const auto [width, height] = SIZE{ client_rect.right, client_rect.bottom };
+        if( width <= 0 or height <= 0 ) { return; }     // E.g. minimized.
+
+        // Render into the memory of a DIB section, then present it with a single `BitBlt`.
+        const wgdi::Bitmap_32 bitmap( width, height );
+        draw_on( bitmap.pixels() );
+
+        const HDC memory_dc = CreateCompatibleDC( dc );
+        const HGDIOBJ original_bitmap = SelectObject( memory_dc, bitmap.handle() );
+            BitBlt( dc, 0, 0, width, height, memory_dc, 0, 0, SRCCOPY );
+        SelectObject( memory_dc, original_bitmap );
+        DeleteDC( memory_dc );
     #endif
 }
 
@@ -163,6 +209,7 @@ auto CALLBACK dialog_message_handler(
     const LPARAM    ell_param
     ) -> INT_PTR
 {
+    CPPUTIL_TIMED_SCOPE( "dialog_message_handler" );
     optional<INT_PTR> result;
 
     #define HANDLE_WM( name, handler_func ) \
@@ -190,5 +237,12 @@ auto main() -> int
         HWND(),             // Parent window, a zero handle is "no parent".
         &dialog_message_handler
         );
+    #ifdef CPPUTIL_INSTRUMENTATION
+        // A GUI subsystem program has no console, so the timings go to a file.
+        if( FILE* const f = fopen( "timings.json", "w" ) ) {
+            fputs( cpp::util::instrumentation::timings_as_json().c_str(), f );
+            fclose( f );
+        }
+    #endif
     return (dialogbox_result <= 0? EXIT_FAILURE : EXIT_SUCCESS);
 }
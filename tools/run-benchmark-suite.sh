@@ -0,0 +1,15 @@
+#!/bin/sh
+# Builds and runs the micro-benchmark suites with g++, e.g. in Linux.
+# Arguments are passed on to the suites, e.g. `--format json` or `--filter utf`; each
+# suite prints its own report.
+set -e
+repo=$(cd "$(dirname "$0")/.." && pwd)
+bin=${TMPDIR:-/tmp}/benchmark-suite
+mkdir -p "$bin"
+standard="-std=c++17 -pedantic-errors"
+g++ $standard -O2 -Wall -pthread -I"$repo/docs/05/code/.include" \
+    "$repo/docs/05/code/benchmarks/suite.cpp" -o "$bin/cpp-suite"
+g++ $standard -O2 -Wall -pthread -I"$repo/docs/04/code/tic-tac-toe/v6" \
+    "$repo/docs/04/code/tic-tac-toe/v6/benchmarks/suite.cpp" -o "$bin/ttt-suite"
+"$bin/cpp-suite" "$@"
+"$bin/ttt-suite" "$@"